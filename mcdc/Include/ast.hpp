@@ -52,6 +52,9 @@
 // variables (Example. Variables abc. Testvector 3 means: a=0,b=1,c=1) the resulting values
 // of all nodes can be calculated.
 // Also Booelan Short Cut Evealuation can be taken into account.
+// The values are not stored in the nodes. The nodes contain only the structure and the tokens. For a fast
+// evaluation, the virtual machine flattens the tree into compact tables with only the needed data (hot data).
+// The results and the print positions are kept in separate tables (cold data).
 //
 // The tree can be printed to the screen or in a file. For easier reading, the printout is turned
 // 90 counter clock wise.
@@ -102,23 +105,19 @@ struct AstNode
 
 
 
-	// used for evaluating the boolean expression. 
-	// According tho the syntax and the given values for the input variables
-	// a resulting value will be calculated for this node
-	bool value{ false };
-
-	// In case of boolean-shortcut-evaluation some nodes and leaf will not be considered
-	// in the evaluation of the results. This will be indicated with this flag
-	// In the printout of the evaluated AST, an X is used to show none evaluated nodes
-	bool notEvaluated{ false };
-	
 	// Stores the token given by the compiler/scanner
 	TokenWithAttribute tokenWithAttribute;
 
-	// Helper Variables. Just used for printing the AST
+	// The resulting value of an evaluation and the position for printing are not stored here
+	// The virtual machine for the AST keeps them in separate tables. See below
+};
+
+
+// Helper Variables. Just used for printing the AST. One entry per node. Calculated together with the AST properties
+struct AstNodeLayout
+{
 	uint printRow{ 0U };	// In what row the node name with attributes will be printed
 	uint level{ 0U }; // And the column for printing. Final column is level * "some fixed tabulator value".
-
 };
 
 
@@ -140,14 +139,15 @@ class VirtualMachineForAST
 {
 public:
 	// Reset everything
-	void clear() noexcept { ast.clear(); row = 0; level = 0U; sourceValue = 0U;}
+	void clear() noexcept;
 	// Add a node to the tree
 	void add(const AstNode && astElement) { ast.push_back(astElement); }
 
 	// Program output. Print jsut the structure of a tree
 	void printTreeStandard(const std::string& source);
 	// Program output. Print the structure of a tree and the associated values to stream os
-	void printTree(std::ostream& os);
+	// The tree will not be modified. So many threads can print the same tree at the same time
+	void printTree(std::ostream& os) const;
 
 	// After all nodes have been added, the properties of the nodes will be set
 	void calculateAstProperties();
@@ -162,6 +162,17 @@ public:
 	// This sets the varaibles/terminals/conditions to a value and calculates the result according the the rules of boolean algebra
 	bool evaluateTree(uint inputValue);
 
+	// Result of the last evaluation for a node: The value and if the node has not been evaluated because of
+	// boolean-shortcut-evaluation. In the printout of the evaluated AST, an X is used to show none evaluated nodes
+	bool value(uint nodeIndex) const noexcept { return (ASTNoLinkedElement != evaluationPosition[nodeIndex]) && (0U != evaluationValue[evaluationPosition[nodeIndex]]); }
+	bool notEvaluated(uint nodeIndex) const noexcept { return (ASTNoLinkedElement != evaluationPosition[nodeIndex]) && (0U != evaluationNotEvaluated[evaluationPosition[nodeIndex]]); }
+	// Set the result for a node directly. For example for printing an influence tree. Nodes that are not part of the tree are ignored
+	void setNodeResult(uint nodeIndex, bool nodeValue, bool nodeNotEvaluated) noexcept;
+
+	// Indices of the nodes in the sequence of the evaluation. Children before parents (postorder). The last element is the root
+	// Only nodes that are part of the tree. Other evaluators, like the bit sliced node value matrix, use the same sequence
+	const std::vector<uint>& getEvaluationSequence() const noexcept { return evaluationSequence; }
+
 	// The AST. And yes, it is public.
 	AST ast{};
 	// Table of symbols/variables/terminals/conditions used in the tree
@@ -169,16 +180,38 @@ public:
 protected:
 
 
-	// Evaluation of the AST (calculating the result) will be done recursivly
-	void evaluateTreeRecursive(uint index);
-	// Calculating the properties of the AST will also be done recursively. 
+	// Calculating the properties of the AST will be done recursively. 
 	void calculateAstPropertiesRecursive(uint index);
 
-	// This is important for boolean-shortcut-evaluation
-	// If a shortcut evaluation is possible, then all subtree elements will also not be evaluated 
-	// This sets all children to "not evaluated"
-	void setSubTreetoMasked(uint index);
-
+	// For the evaluation, the tree is flattened into a sequence of nodes. Children before parents (postorder)
+	// So the evaluation is a simple loop and needs no recursion. The evaluation works only on the following
+	// compact tables (structure of arrays), indexed with the position in the sequence. The AST nodes with
+	// tokens and links are not touched. For boolean-shortcut-evaluation we need additionally the size of the
+	// right subtree. If a shortcut evaluation is possible, then the whole right subtree will be set to
+	// "not evaluated". In the sequence, it is the block directly before the node
+	enum class EvaluationOperation : uint_fast8_t { Condition, NegatedCondition, Copy, Not, And, Or, Xor, Invalid };
+	std::vector<EvaluationOperation> evaluationOperation{};
+	// Position of the left operand. For conditions: The mask for reading the source input value
+	std::vector<uint> evaluationOperandLeft{};
+	// Position of the right operand
+	std::vector<uint> evaluationOperandRight{};
+	std::vector<uint> evaluationRightSubtreeSize{};
+	// Results of the evaluation
+	std::vector<uchar> evaluationValue{};
+	std::vector<uchar> evaluationNotEvaluated{};
+	// Position of a node in the sequence. Indexed with the node index. ASTNoLinkedElement for nodes that are not part of the tree
+	std::vector<uint> evaluationPosition{};
+	// And the other way around: The node index for a position in the sequence
+	std::vector<uint> evaluationSequence{};
+
+	// Build the sequence. Called after the AST properties have been set
+	void calculateEvaluationSequence();
+	// Evaluate the AST. One version with and one without boolean-shortcut-evaluation
+	template <bool WithShortCutEvaluation>
+	void evaluateTreeIterative();
+
+	// Print position of the nodes. Only used for printing the AST. Indexed with the node index
+	std::vector<AstNodeLayout> nodeLayout{};
 	// Helper Variables. Just used for printing the AST
 	uint row{ 0U };
 	uint level{ 0U };
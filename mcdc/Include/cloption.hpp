@@ -180,6 +180,22 @@
 // -pmcsfautoa				Automatically write big data for all MC/DC coverage sets to file with automatic created filename, write small data to console. Default
 
 
+// ---------------------------------------------------------------
+// 4. Performance options
+
+// -jit						Translate the boolean expression to native x86-64 machine code for the minterm calculation. Falls back to the interpreter, if not possible
+// -gcs						Calculate the minterms with a Gray code sweep. Only instructions depending on the changed variable will be executed again
+// -nocopt					Do not optimize the object code for the virtual machine (common sub expressions, simplification, constant folding)
+// -threads "n"				Number of worker threads for all parallel calculations. Default is the number of hardware threads
+// -grain "n"				Number of truth table words (64 input values each) per task of the minterm calculation. Default is calculated by a cost model
+// -tl "s"					Time limit in seconds for the whole run. When reached, all searches stop and the best partial results are shown, marked as partial
+// -mp "n"					Stop the search for MC/DC test pairs after n test pairs have been found. The test pairs and test sets are marked as partial
+// -ucf						Unique cause fast mode. Search MC/DC test pairs only among test values that differ in exactly one condition
+// -quota "n"				Per condition quota. Stop the search for a condition after n unique cause test pairs have been found. Other test pairs are kept up to n per type and stop the search, if all conditions have reached their quota
+// -sample "n"				Sampled search for MC/DC test pairs. Check n random test pairs instead of all. For decisions with many conditions. Without -umdnf, there is no truth table and no minimum DNF and up to 26 conditions are possible
+// -seed "n"				Seed for the random numbers of the sampled search. Same seed, same result. Default is 1
+
+
 // Any 3.7 option switches on the respective 3.8 options
 
 //
@@ -199,6 +215,10 @@
 #include <fstream>
 
 #include <streambuf>
+#include <string>
+#include <mutex>
+#include <vector>
+#include <set>
 
 
 
@@ -241,6 +261,14 @@ public:
 	// This evaluates the command line options, make plausibility checks and sets priorities
 	void evaluateCommandLine();
 
+	// Get the names of all files, that may be written by the given groups of output options
+	// A group is identified by the index of its first option, e.g. pttc. Output to std::cout is not considered
+	std::set<std::string> getSelectedOutputFileNames(const std::vector<uint>& optionFirstIndexInGroups) const;
+
+	// Get the numeric parameter of an option. The parameter has been checked in evaluateCommandLine
+	// If the option is not selected, 0 is returned
+	uint64 getNumericParameter(uint optionIndex) const;
+
 	// This will allow for easier access of the options with a name (and not a numeric index only)
 	enum OptionID
 	{
@@ -303,7 +331,18 @@ public:
 		pmcsf,
 		pmcsa,
 		pmcsfauto,
-		pmcsfautoa
+		pmcsfautoa,
+		jit,
+		gcs,
+		nocopt,
+		threads,
+		grain,
+		tl,
+		mp,
+		ucf,
+		quota,
+		sample,
+		seed
 	};
 
 	// In the first step, the options from the comand line will be stored in a very simple POD, without additional overhead
@@ -337,6 +376,9 @@ protected:
 	// Considers the handling of file open modes, dependent on flags and maybe similar filenames
 	void setOverwriteAppendFlag();
 
+	// Options with a numeric parameter accept only decimal numbers. Invalid values are reported and the option is ignored
+	void checkNumericParameters();
+
 	// The raw comand line values.
 	using ComandLineVector = std::vector<OptionWithParameter>;
 	using ComandLineVectorIter = ComandLineVector::iterator;
@@ -429,6 +471,58 @@ namespace OutputHandling
 	};
 
 
+
+	// Console output of a stage of the program, that runs concurrently with other stages
+	// The output of all stages shall appear in the usual sequence. So, as long as a stage is not 
+	// active, everything written to its console is buffered. When the stage becomes active, because all 
+	// previous stages are finished, the buffered data are written to std::cout. All further output goes
+	// directly to std::cout
+
+	class StageConsoleStream : public std::ostream
+	{
+		// The streambuffer collects or forwards the data
+		struct StageConsoleBuffer : std::streambuf
+		{
+			// Necessary overwrites for overflow and sync. xsputn for writing many characters at once
+			sint overflow(sint c) override;
+			std::streamsize xsputn(const cchar* s, std::streamsize n) override;
+			sint sync() override;
+
+			// Write buffered data to std::cout and forward everything from now on
+			void activate();
+
+			// The stage and the main thread may access the buffer at the same time
+			std::mutex bufferMutex{};
+			// Data, that has been written, before the stage became active
+			std::string pendingOutput{};
+			// Stage is active. Data will be forwarded to std::cout
+			bool active{ false };
+		};
+
+	public:
+#pragma warning(suppress: 26455)
+		// Initialize the ostream with the StageConsoleBuffer. Format flags are taken from std::cout
+		StageConsoleStream() : std::ostream(&stageConsoleBuffer), stageConsoleBuffer() { copyfmt(std::cout); }
+		StageConsoleStream(const StageConsoleStream&) = delete;
+		StageConsoleStream(const StageConsoleStream&&) = delete;
+		StageConsoleStream& operator =(const StageConsoleStream&) = delete;
+		StageConsoleStream& operator =(const StageConsoleStream&&) = delete;
+
+		// All previous stages are finished. Show the buffered data. Forward everything from now on
+		void activate() { stageConsoleBuffer.activate(); }
+
+	protected:
+		StageConsoleBuffer stageConsoleBuffer;
+	};
+
+
+	// The console for the current thread. This is the console of the stage, if the thread runs a stage. Else std::cout
+	// All output to the console shall use this function and not std::cout directly
+	std::ostream& console() noexcept;
+	// Set the console for the current thread. nullptr means std::cout
+	void setConsole(std::ostream* stageConsole) noexcept;
+
+
 }
 
 
@@ -132,10 +132,15 @@ protected:
 
 // Code Generator for 3 Byte op code. Virtual Registers for the virtual machine will be used to store intermediate results
 // Also a symbol table, with all the input symbols will be generated
+//
+// Optionally code for boolean short cut evaluation can be generated. Then, after the left hand operand
+// of an AND or OR, a conditional jump will be inserted. If the result is already known (AND: left is false,
+// OR: left is true), then the right hand operand will be skipped. The jump copies the left hand value
+// into the destination register of the operation. So the result is the same as with full evaluation
 class CodeGeneratorForVM : public CodeGeneratorBase
 {
 public:
-	explicit CodeGeneratorForVM(ObjectCode& objectCode, std::string& source) :CodeGeneratorBase(source), objectCode(objectCode), availabeRegister() {}
+	explicit CodeGeneratorForVM(ObjectCode& objectCode, std::string& source, bool shortCircuit = false) :CodeGeneratorBase(source), objectCode(objectCode), availabeRegister(), generateShortCircuitCode(shortCircuit) {}
 	CodeGeneratorForVM() = delete;
 	CodeGeneratorForVM& operator =(const CodeGeneratorForVM&) = delete;
 	CodeGeneratorForVM& operator =(const CodeGeneratorForVM&&) = delete;
@@ -155,11 +160,17 @@ public:
 protected:
 	ObjectCode& objectCode;
 	std::vector<bool> availabeRegister;
+	// Generate conditional jumps for boolean short cut evaluation
+	bool generateShortCircuitCode{ false };
 
 	// Finds avaliable register numbers. Registers will be reused, if they are no longer needed. The following
 	// functions will handle the register allocation
 	uint getNextAvailableRegister();
 	void setRegisterToAvailable(uint index);
+
+	// Insert a conditional jump in front of the code of the right hand operand of an AND or OR operation
+	// The operation itself must be added directly after this call. The jump will then go behind the operation
+	void insertConditionalJump(Token operation, uint leftOperandRegister, uint rightOperandCodeStartIndex, uint destinationRegister);
 };
 
 
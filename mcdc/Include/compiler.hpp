@@ -120,7 +120,8 @@ protected:
 class CompilerForVM : public Compiler
 {
 public:
-	explicit CompilerForVM(std::string& sourceCode, ObjectCode& objectCode) : Compiler(sourceCode,& codeGeneratorForVM), codeGeneratorForVM(objectCode, sourceCode) {}
+	// If shortCircuit is true, then conditional jumps for the boolean short cut evaluation will be generated
+	explicit CompilerForVM(std::string& sourceCode, ObjectCode& objectCode, bool shortCircuit = false) : Compiler(sourceCode,& codeGeneratorForVM), codeGeneratorForVM(objectCode, sourceCode, shortCircuit) {}
 	CompilerForVM() = delete;
 	CompilerForVM(const CompilerForVM&) = delete;
 	CompilerForVM(const CompilerForVM&&) = delete;
@@ -0,0 +1,550 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef COMPILETIMEEVALUATOR_HPP
+#define COMPILETIMEEVALUATOR_HPP
+
+//
+// Compile time evaluation of boolean expressions
+//
+// The normal compiler chain  Scanner --> Parser --> Code Generator --> Virtual Machine  runs at runtime.
+// For boolean expressions that are already known, when the program is build, this is not necessary.
+// For example, decisions that are hard coded in a regression test suite.
+//
+// Everything in this file is constexpr. A string literal with a boolean expression is scanned, parsed 
+// and translated to object code by the compiler at build time. The same grammar (grammarForBooleanExpressions), 
+// the same Tokens and the same object code format (OpCodeLine) as for the runtime compiler are used.
+// So the results are identical. 
+//
+// Usage:
+//
+//		constexpr auto decision{ compileBooleanExpression("ab+c") };
+//		static_assert(decision.isValid(), "Syntax error");
+//
+//		const bool result{ decision(5U) };						// Evaluate for one input value. No parsing at runtime
+//		constexpr auto truthTable{ decision.truthTable() };		// Complete truth table, calculated at build time
+//
+// The input value is the decimal equivalent of the boolean variables. As in the runtime version,
+// the alphabetically first variable is the most significant bit.
+//
+// Evaluation is done in bit sliced mode (64 input values at once), as in the virtual machine.
+//
+// The object code has always as many registers as needed. Registers are not reused. The maximum number of
+// op code lines and the maximum number of registers is given by the length of the source string.
+//
+
+
+#include "types.hpp"
+#include "token.hpp"
+#include "grammar.hpp"
+#include "codegenerator.hpp"
+#include "virtualmachine.hpp"
+#include "truthtable.hpp"
+
+#include <array>
+#include <cstddef>
+
+
+// The truth table for a boolean expression, calculated at compile time
+// Bit i in the truth table is the result for input value i. So the set bits are the minterms
+struct CompileTimeTruthTable
+{
+	// Maximum number of words needed for the maximum number of boolean variables
+	static constexpr uint NumberOfWords{ (1U << static_cast<uint>(MaxNumberOfBitsForEvaluation)) / NumberOfBitSlicedLanes };
+
+	// Result for one input value
+	constexpr bool operator[](uint inputValue) const noexcept { return null<BitSlicedRegisterType>() != (word[inputValue / NumberOfBitSlicedLanes]&  (static_cast<BitSlicedRegisterType>(1U) << (inputValue % NumberOfBitSlicedLanes))); }
+
+	// Number of valid input values. 2^numberOfBooleanVariables
+	constexpr uint numberOfInputValues() const noexcept { return 1U << numberOfBooleanVariables; }
+
+	// Count the minterms
+	constexpr uint numberOfMinterms() const noexcept
+	{
+		uint count{ 0U };
+		for (uint inputValue = 0U; inputValue < numberOfInputValues(); ++inputValue)
+		{
+			if ((*this)[inputValue])
+			{
+				++count;
+			}
+		}
+		return count;
+	}
+
+	// Convert to the minterm vector, as used by the rest of the software. This can of course only be done at runtime
+	MintermVector mintermVector() const
+	{
+		MintermVector mv;
+		for (uint inputValue = 0U; inputValue < numberOfInputValues(); ++inputValue)
+		{
+			if ((*this)[inputValue])
+			{
+				mv.push_back(narrow_cast<MinTermNumber>(inputValue));
+			}
+		}
+		return mv;
+	}
+
+	// Convert to the packed truth table, as used by the rest of the software
+	TruthTable toTruthTable() const
+	{
+		TruthTable truthTable(numberOfBooleanVariables);
+		for (uint wordIndex = 0U; (wordIndex * NumberOfBitSlicedLanes) < numberOfInputValues(); ++wordIndex)
+		{
+			truthTable.setWord(wordIndex, word[wordIndex]);
+		}
+		truthTable.compact();
+		return truthTable;
+	}
+
+	// The truth table in bit sliced form
+	std::array<BitSlicedRegisterType, NumberOfWords> word{};
+	// Number of boolean variables in the boolean expression
+	uint numberOfBooleanVariables{ 0U };
+};
+
+
+
+// Compiled boolean expression. N is the size of the source string literal (including the terminating 0)
+// The object can be used as a specialized evaluator for the boolean expression
+template <std::size_t N>
+class CompileTimeEvaluatorForBooleanExpressions
+{
+public:
+	// Each character of the source generates at most one ID or NOT op code line. Each ID may additionally
+	// be combined with a binary operation (also for the concatenated AND). Plus END. Each op code line has its own register
+	static constexpr std::size_t MaxNumberOfOpCodeLines{ (2U * N) + 1U };
+
+	// Compile the source. Scanner, Parser and code generator in one
+	explicit constexpr CompileTimeEvaluatorForBooleanExpressions(const cchar(&source)[N]) noexcept { compile(source); }
+
+	// Is the boolean expression syntactically correct?
+	constexpr bool isValid() const noexcept { return compilerResultOK; }
+	// Number of different boolean variables
+	constexpr uint getNumberOfBooleanVariables() const noexcept { return numberOfBooleanVariables; }
+
+	// Evaluate for one input value
+	constexpr bool operator()(uint inputValue) const noexcept
+	{
+		const uint sourceValueBase{ inputValue - (inputValue % NumberOfBitSlicedLanes) };
+		return null<BitSlicedRegisterType>() != (runBitSliced(sourceValueBase)&  (static_cast<BitSlicedRegisterType>(1U) << (inputValue % NumberOfBitSlicedLanes)));
+	}
+
+	// Evaluate 64 input values at once. sourceValueBase must be a multiple of 64
+	// Bit i of the result is the result for input value sourceValueBase + i
+	constexpr BitSlicedRegisterType runBitSliced(uint sourceValueBase) const noexcept
+	{
+		std::array<BitSlicedRegisterType, MaxNumberOfOpCodeLines> machineRegister{};
+		BitSlicedRegisterType programResult{ null<BitSlicedRegisterType>() };
+
+		for (std::size_t programCounter = 0U; programCounter < numberOfOpCodeLines; ++programCounter)
+		{
+			const OpCodeLine& opCodeLine{ opCode[programCounter] };
+			switch (opCodeLine.token)
+			{
+			case Token::ID:
+				machineRegister[opCodeLine.parameter2] = getSourceValueBitSliced(normalizedInput[opCodeLine.parameter1], sourceValueBase);
+				break;
+			case Token::IDNOT:
+				machineRegister[opCodeLine.parameter2] = ~getSourceValueBitSliced(normalizedInput[opCodeLine.parameter1], sourceValueBase);
+				break;
+			case Token::OR:
+				machineRegister[opCodeLine.parameter3] = machineRegister[opCodeLine.parameter1] | machineRegister[opCodeLine.parameter2];
+				break;
+			case Token::XOR:
+				machineRegister[opCodeLine.parameter3] = machineRegister[opCodeLine.parameter1] ^ machineRegister[opCodeLine.parameter2];
+				break;
+			case Token::AND:
+				machineRegister[opCodeLine.parameter3] = machineRegister[opCodeLine.parameter1]&  machineRegister[opCodeLine.parameter2];
+				break;
+			case Token::NOT:
+				machineRegister[opCodeLine.parameter2] = ~machineRegister[opCodeLine.parameter1];
+				break;
+			case Token::END:
+				programResult = machineRegister[opCodeLine.parameter1];
+				break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+			}
+		}
+		return programResult;
+	}
+
+	// Calculate the complete truth table. Only as many words as necessary for the number of variables
+	constexpr CompileTimeTruthTable truthTable() const noexcept
+	{
+		CompileTimeTruthTable result{};
+		result.numberOfBooleanVariables = numberOfBooleanVariables;
+		if (compilerResultOK)
+		{
+			// Mask for valid lanes. Less than 6 variables will not fill one complete word
+			const BitSlicedRegisterType validLanes{ (numberOfBooleanVariables < 6U) ? ((static_cast<BitSlicedRegisterType>(1U) << (1U << numberOfBooleanVariables)) - 1U) : ~null<BitSlicedRegisterType>() };
+			for (uint sourceValueBase = 0U; sourceValueBase < (1U << numberOfBooleanVariables); sourceValueBase += NumberOfBitSlicedLanes)
+			{
+				result.word[sourceValueBase / NumberOfBitSlicedLanes] = runBitSliced(sourceValueBase)&  validLanes;
+			}
+		}
+		return result;
+	}
+
+	// Access to the generated object code. For example for comparing with the runtime compiler
+	constexpr std::size_t getNumberOfOpCodeLines() const noexcept { return numberOfOpCodeLines; }
+	constexpr const OpCodeLine& getOpCodeLine(std::size_t index) const noexcept { return opCode[index]; }
+
+protected:
+	// The parse stack has a fixed size. The source and the END token will fit into it
+	using CompileTimeParseStack = std::array<TokenWithAttribute, N + 1U>;
+
+	// Number of letters in the alphabet. Lower case letters are IDs, upper case letters are negated IDs
+	static constexpr uint NumberOfLetters{ 26U };
+
+	// Scanner for one character. Same functionality as the runtime Scanner class
+	static constexpr Token scanCharacter(cchar c) noexcept
+	{
+		Token token{ Token::NONE };
+		if (((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')))
+		{
+			token = Token::ID;
+		}
+		else switch (c)
+		{
+		case '|':	// Fallthrough
+		case '+':	// Or
+			token = Token::OR;
+			break;
+		case '^':	// Xor
+			token = Token::XOR;
+			break;
+		case '&':	// Fallthrough
+		case '*':	// And
+			token = Token::AND;
+			break;
+		case '!':	// Fallthrough
+		case '~':	// Not
+			token = Token::NOT;
+			break;
+		case '(':
+			token = Token::BOPEN;
+			break;
+		case ')':
+			token = Token::BCLOSE;
+			break;
+		default:
+			token = Token::NONE;
+			break;
+		}
+		return token;
+	}
+
+	// White space will be ignored
+	static constexpr bool isWhiteSpace(cchar c) noexcept { return (' ' == c) || ('\t' == c) || ('\n' == c) || ('\r' == c) || ('\v' == c) || ('\f' == c); }
+
+	// Value of a variable for all 64 lanes. Same as in the virtual machine
+	static constexpr BitSlicedRegisterType getSourceValueBitSliced(uint index, uint sourceValueBase) noexcept
+	{
+		BitSlicedRegisterType result{ null<BitSlicedRegisterType>() };
+		if (index < bitSlicedLanePattern.size())
+		{
+			result = bitSlicedLanePattern[index];
+		}
+		else
+		{
+			result = (null<uint32>() == (sourceValueBase&  bitMask[index])) ? null<BitSlicedRegisterType>() : ~null<BitSlicedRegisterType>();
+		}
+		return result;
+	}
+
+	// Shift reduce parser. Works exactly like the runtime Parser, but with a fixed size parse stack
+	constexpr void compile(const cchar(&source)[N]) noexcept
+	{
+		CompileTimeParseStack parseStack{};
+		std::size_t sizeOfStack{ 0U };
+		// Used letters. Needed for the symbol table
+		uint32 usedLetters{ 0U };
+
+		bool doParse{ true };
+		std::size_t sourceIndex{ 0U };
+		compilerResultOK = true;
+		while (doParse)
+		{
+			// ..............................................................	-- > Scan
+			// Eat white space
+			while ((sourceIndex < (N - 1U)) && isWhiteSpace(source[sourceIndex]))
+			{
+				++sourceIndex;
+			}
+			TokenWithAttribute tokenWithAttribute{};
+			if ((sourceIndex >= (N - 1U)) || (null<cchar>() == source[sourceIndex]))
+			{
+				tokenWithAttribute.token = Token::END;
+			}
+			else
+			{
+				const cchar c{ source[sourceIndex] };
+				tokenWithAttribute.token = scanCharacter(c);
+				tokenWithAttribute.inputTerminalSymbol = c;
+				if (Token::ID == tokenWithAttribute.token)
+				{
+					// Index of the letter. Upper case letters are negated
+					tokenWithAttribute.sourceIndex = ((c >= 'a') && (c <= 'z')) ? static_cast<uint>(c - 'a') : static_cast<uint>(c - 'A') + NumberOfLetters;
+				}
+				// Double operators || and &&
+				if ((('|' == c) || ('&' == c)) && ((sourceIndex + 1U) < (N - 1U)) && (c == source[sourceIndex + 1U]))
+				{
+					++sourceIndex;
+				}
+				++sourceIndex;
+			}
+
+			if (Token::NONE == tokenWithAttribute.token)
+			{
+				// Error in input string
+				compilerResultOK = false;
+				doParse = false;
+			}
+			else
+			{
+				// ..............................................................	-- > Shift
+				parseStack[sizeOfStack] = tokenWithAttribute;
+				++sizeOfStack;
+
+				// Match and reduce as long as possible
+				bool matchFound{ true };
+				while (matchFound)
+				{
+					// ..........................................................	-- > Match
+					uint indexOfMatchedProduction{ 0U };
+					matchFound = match(parseStack, sizeOfStack, indexOfMatchedProduction);
+					if (matchFound)
+					{
+						// ......................................................	-- > Reduce and generate code
+						reduce(parseStack, sizeOfStack, indexOfMatchedProduction, usedLetters);
+					}
+				}
+				// Everything reduced to END. Normal end of parse
+				if (Token::END == parseStack[0].token)
+				{
+					doParse = false;
+				}
+				// END read, but not everything could be reduced. Syntax error
+				else if (Token::END == tokenWithAttribute.token)
+				{
+					compilerResultOK = false;
+					doParse = false;
+				}
+			}
+		}
+		// Build the normalized input. The alphabetically first variable is the most significant bit
+		if (compilerResultOK)
+		{
+			numberOfBooleanVariables = 0U;
+			for (uint letter = 0U; letter < NumberOfLetters; ++letter)
+			{
+				if (null<uint32>() != (usedLetters&  bitMask[letter]))
+				{
+					++numberOfBooleanVariables;
+				}
+			}
+			if (numberOfBooleanVariables > static_cast<uint>(MaxNumberOfBitsForEvaluation))
+			{
+				// Too many variables
+				compilerResultOK = false;
+			}
+			else
+			{
+				uint symbolCounter{ numberOfBooleanVariables };
+				for (uint letter = 0U; letter < NumberOfLetters; ++letter)
+				{
+					if (null<uint32>() != (usedLetters&  bitMask[letter]))
+					{
+						--symbolCounter;
+						normalizedInput[letter] = symbolCounter;
+					}
+				}
+			}
+		}
+	}
+
+	// Match the top of the parse stack against a handle in the grammar. Same algorithm as in the runtime parser
+	static constexpr bool match(const CompileTimeParseStack& parseStack, std::size_t sizeOfStack, uint& indexOfMatchedProduction) noexcept
+	{
+		bool matchFound{ false };
+		for (std::size_t productionIndex = 0U; (productionIndex < grammarForBooleanExpressions.size()) && !matchFound; ++productionIndex)
+		{
+			const Production& production{ grammarForBooleanExpressions[productionIndex] };
+			const std::size_t lengthOfHandleIncludingLookahead{ (production.hasLookAhead ? 1U : 0U) + production.numberOfTokensInHandle };
+			if (sizeOfStack >= lengthOfHandleIncludingLookahead)
+			{
+				std::size_t stackElementToCompare{ sizeOfStack - 1U };
+				// Check the look ahead symbol, if any
+				bool lookAheadOk{ !production.hasLookAhead };
+				if (production.hasLookAhead)
+				{
+					for (const Token tokenLookahead : production.lookAheadTerminalSymbol)
+					{
+						lookAheadOk = lookAheadOk || (parseStack[stackElementToCompare].token == tokenLookahead);
+					}
+					--stackElementToCompare;
+				}
+				// Compare the handle
+				if (lookAheadOk)
+				{
+					matchFound = true;
+					for (std::size_t indexInHandle = 0U; (indexInHandle < production.numberOfTokensInHandle) && matchFound; ++indexInHandle)
+					{
+						matchFound = (parseStack[stackElementToCompare - indexInHandle].token == production.handle[indexInHandle]);
+					}
+				}
+			}
+			if (matchFound)
+			{
+				indexOfMatchedProduction = production.id;
+			}
+		}
+		return matchFound;
+	}
+
+	// Generate code and reduce the parse stack. The code generation is the same as in the CodeGeneratorForVM
+	// But registers are not reused. Each result gets its own register
+	constexpr void reduce(CompileTimeParseStack& parseStack, std::size_t& sizeOfStack, uint positionOfProduction, uint32& usedLetters) noexcept
+	{
+		const Production& production{ grammarForBooleanExpressions[positionOfProduction] };
+		const Token token{ production.operationIdentifier };
+
+		// The top of the handle. The look ahead symbol will stay on the stack
+		const std::size_t stackPointer{ sizeOfStack - 1U - (production.hasLookAhead ? 1U : 0U) };
+
+		OpCodeLine opCodeLine{};
+		TokenWithAttribute result{};
+		result.token = Token::EXPR;
+		bool generateCode{ true };
+
+		switch (production.numberOfTokensInHandle)
+		{
+		case 1U:
+			// ID or IDNOT
+			{
+				const uint letter{ parseStack[stackPointer].sourceIndex };
+				opCodeLine.token = (letter < NumberOfLetters) ? Token::ID : Token::IDNOT;
+				opCodeLine.parameter1 = letter % NumberOfLetters;
+				opCodeLine.parameter2 = numberOfRegisters++;
+				opCodeLine.parameter3 = static_cast<uint>('a') + opCodeLine.parameter1;
+				usedLetters |= bitMask[opCodeLine.parameter1];
+				result.sourceIndex = opCodeLine.parameter2;
+			}
+			break;
+		case 2U:
+			if (Token::NOT == token)
+			{
+				opCodeLine.token = token;
+				opCodeLine.parameter1 = parseStack[stackPointer].sourceIndex;
+				opCodeLine.parameter2 = numberOfRegisters++;
+				result.sourceIndex = opCodeLine.parameter2;
+			}
+			else if (Token::AND == token)
+			{
+				opCodeLine.token = token;
+				opCodeLine.parameter1 = parseStack[stackPointer].sourceIndex;
+				opCodeLine.parameter2 = parseStack[stackPointer - 1U].sourceIndex;
+				opCodeLine.parameter3 = numberOfRegisters++;
+				result.sourceIndex = opCodeLine.parameter3;
+			}
+			else
+			{
+				// END
+				opCodeLine.token = Token::END;
+				opCodeLine.parameter1 = parseStack[stackPointer - 1U].sourceIndex;
+				result.token = Token::END;
+			}
+			break;
+		case 3U:
+			if (Token::BCLOSE == token)
+			{
+				// Brackets. Just copy the register
+				result.sourceIndex = parseStack[stackPointer - 1U].sourceIndex;
+				generateCode = false;
+			}
+			else
+			{
+				// OR XOR AND
+				opCodeLine.token = token;
+				opCodeLine.parameter1 = parseStack[stackPointer - 2U].sourceIndex;
+				opCodeLine.parameter2 = parseStack[stackPointer].sourceIndex;
+				opCodeLine.parameter3 = numberOfRegisters++;
+				result.sourceIndex = opCodeLine.parameter3;
+			}
+			break;
+		default:
+			generateCode = false;
+			break;
+		}
+		if (generateCode)
+		{
+			opCode[numberOfOpCodeLines] = opCodeLine;
+			++numberOfOpCodeLines;
+		}
+
+		// Replace the handle by the new non-terminal. Keep the look ahead symbol
+		const std::size_t firstElementOfHandle{ stackPointer + 1U - production.numberOfTokensInHandle };
+		parseStack[firstElementOfHandle] = result;
+		const std::size_t numberOfErasedElements{ production.numberOfTokensInHandle - 1U };
+		for (std::size_t i = firstElementOfHandle + 1U; (i + numberOfErasedElements) < sizeOfStack; ++i)
+		{
+			parseStack[i] = parseStack[i + numberOfErasedElements];
+		}
+		sizeOfStack -= numberOfErasedElements;
+	}
+
+	// The generated object code
+	std::array<OpCodeLine, MaxNumberOfOpCodeLines> opCode{};
+	std::size_t numberOfOpCodeLines{ 0U };
+	uint numberOfRegisters{ 0U };
+
+	// Symbol table. Maps the letter to the bit in the input value
+	std::array<uint, NumberOfLetters> normalizedInput{};
+	uint numberOfBooleanVariables{ 0U };
+
+	// Result of compilation. If false, then the boolean expression has a syntax error
+	bool compilerResultOK{ false };
+};
+
+
+// Convenience function. Template argument deduction from the string literal
+template <std::size_t N>
+constexpr CompileTimeEvaluatorForBooleanExpressions<N> compileBooleanExpression(const cchar(&source)[N]) noexcept
+{
+	return CompileTimeEvaluatorForBooleanExpressions<N>(source);
+}
+
+
+#endif
@@ -310,6 +310,7 @@ public:
 	// 1.: Set  cover directly via   void setCellAsCover(Index row, Index column);
 	// 2.: a.) Set a callback function, which can calculate the initial cover
 	//     b.) Let the system call the callback function and set the initial coverage internally
+	//         The callback function will be called from several threads in parallel. It must not modify any data
 	void setCellAsCover(Index row, Index column);
 
 	void setCheckForCoverFunction(CheckForCoverFunction cfcf) { checkForCover = cfcf; }
@@ -328,6 +329,9 @@ public:
 
 	// Shows, how many cells are still in the table and not reduced. Can be used as complexity metrics
 	ulong countNotDroppedTableElements() noexcept;	
+
+	// The time budget was exhausted during the reduction. The result is a valid coverage, but not necessarily minimal
+	bool isPartialResult() const noexcept { return partialResult; }
 protected:
 
 	void printTable(std::ostream& os);
@@ -372,6 +376,10 @@ protected:
 	// Erase everything redundant
 	void eraseAllDroppedCells() { eraseAllDroppedRows(); eraseAllDroppedColumns(); }
 
+	// If the time budget is exhausted, the cyclic core will not be resolved with Petricks method
+	// Instead a greedy heuristic is used. Fast, but not minimal. The result has only one coverage set
+	ProductTermVector findGreedyCover();
+
 	// Check, if there are still entries in the table or if everything has be reduced
 	bool isTableEmpty() noexcept { return (null<TableVector::size_type>() == tableRows.size()) || (null<TableVector::size_type>() == tableColumns.size());	}
 
@@ -387,6 +395,8 @@ protected:
 
 	// Result of Petricks method. One or more coverage results
 	ProductTermVector coverageSet;
+	// The reduction has been stopped, because the time budget was exhausted
+	bool partialResult{ false };
 
 	// Call back function pointers for best cost calculation in case of double rows or columns
 	BestCostFunction bestCostCalculatorForEqualImplicationColumn{};
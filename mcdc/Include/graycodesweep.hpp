@@ -0,0 +1,121 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef GRAYCODESWEEP_HPP
+#define GRAYCODESWEEP_HPP
+
+//
+// Gray code sweep for the calculation of a complete truth table
+//
+// The virtual machine in bit sliced mode calculates 64 consecutive input values with one run of the
+// program. The lowest 6 variables are different in each lane, all other variables are the same for all lanes.
+// To calculate a complete truth table, the program is run for the input values 0, 64, 128, 192 . . .
+// From one run to the next, many of the higher variables may change. And all instructions are executed again.
+//
+// If the blocks of 64 input values are visited in Gray code order, then exactly one of the higher 
+// variables changes from one block to the next. All instructions that do not depend on this variable 
+// will calculate the same value as before. So only the instructions in the fan-out cone of the
+// changed variable need to be executed again.
+//
+// Example for 3 higher variables (bit 6,7,8). Blocks are visited in the order
+//
+//		Gray code:  000 001 011 010 110 111 101 100
+//		Changed:        g   h   g   i   g   h   g
+//
+// To find the fan-out cone, a dependency graph is built from the object code. The registers of the 
+// object code are reused by the code generator. Therefore each op code line gets its own value slot.
+// For each op code line we calculate the set of variables that it depends on. The fan-out cone of a
+// variable is then the list of all op code lines, that depend on this variable (in program order).
+//
+// For wide and shallow boolean expressions, the fan-out cone of a variable is much smaller than the 
+// complete program. So the work is reduced by the ratio of the size of the cone to the program size.
+//
+// The sweep is selected with the option -gcs
+//
+
+
+#include "types.hpp"
+#include "codegenerator.hpp"
+#include "virtualmachine.hpp"
+
+#include <vector>
+#include <array>
+#include <cstdint>
+
+
+class GrayCodeSweepForBooleanExpressions
+{
+public:
+	GrayCodeSweepForBooleanExpressions() noexcept {}
+	GrayCodeSweepForBooleanExpressions(const GrayCodeSweepForBooleanExpressions&) = delete;
+	GrayCodeSweepForBooleanExpressions(const GrayCodeSweepForBooleanExpressions&&) = delete;
+	GrayCodeSweepForBooleanExpressions& operator =(const GrayCodeSweepForBooleanExpressions&) = delete;
+	GrayCodeSweepForBooleanExpressions& operator =(const GrayCodeSweepForBooleanExpressions&&) = delete;
+
+	// Build the program with one value slot per op code line and the fan-out cones of all variables
+	void load(ObjectCode& objectCode);
+
+	// Has a program been loaded?
+	bool isAvailable() const noexcept { return !program.empty(); }
+
+	// Calculate the truth table words for all input values from sourceValueBegin to sourceValueEnd
+	// sourceValueBegin must be a multiple of 64. truthTableWord[i] is the result for the input values 
+	// sourceValueBegin + 64*i ... sourceValueBegin + 64*i + 63
+	// The caller provides the space for all words. The results are written directly to the destination
+	// The function does not modify the object. So it can be called by many threads at the same time
+	void sweep(uint sourceValueBegin, uint sourceValueEnd, BitSlicedRegisterType* truthTableWord) const;
+
+protected:
+	// One instruction. The destination is always the value slot with the same index as the instruction
+	struct SweepInstruction
+	{
+		ByteCode operation{ ByteCode::End };
+		uint16_t operand1{ 0U };	// Normalized variable index for loads, else index of source value slot
+		uint16_t operand2{ 0U };	// Index of second source value slot
+	};
+	using SweepProgram = std::vector<SweepInstruction>;
+	// Indices of instructions in program order
+	using FanOutCone = std::vector<uint16_t>;
+
+	// Execute one instruction in bit sliced mode and store the result in its value slot
+	void execute(uint instructionIndex, uint sourceValueBase, std::vector<BitSlicedRegisterType>& value) const noexcept;
+
+	// The program
+	SweepProgram program{};
+	// The value slot with the result of the program
+	uint resultIndex{ 0U };
+	// For each variable, all instructions that depend on it
+	std::array<FanOutCone, MaxNumberOfBitsForEvaluation> fanOutCone{};
+};
+
+
+#endif
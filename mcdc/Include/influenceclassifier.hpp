@@ -0,0 +1,156 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef INFLUENCECLASSIFIER_HPP
+#define INFLUENCECLASSIFIER_HPP
+
+//
+// Influence Classifier. Word parallel check of test pairs for MC/DC
+//
+// For a test pair, the "influence tree" is the tree XOR of the 2 evaluated ASTs: A node is true, if it
+// changed its value between the 2 test values and if it has been evaluated for both test values.
+// A condition (leaf) has an influence on the result, if the complete path from the condition up to the
+// root is true in the influence tree. Then
+//
+//  - Exactly one influencing condition and exactly one modified condition         --> Unique Cause MCDC
+//  - Exactly one influencing condition. More modified conditions, all of them
+//    with the same name (strongly coupled conditions)                             --> Unique Cause + Masking MCDC
+//  - Exactly one influencing condition. More different modified conditions        --> Masking MCDC
+//
+// Instead of building the influence tree for one test pair and walking the paths for every leaf, this
+// classifier works on the words of the node value matrix. One bit of a word belongs to one test pair.
+// So one outer test value is checked against 64 inner test values with one bit operation per node:
+//
+//  - The changed state of a node for 64 test pairs is one XOR and some ANDs with the evaluated flags
+//  - The path check is done top down. A node is on a true path, if it is changed and its parent is on
+//    a true path. So no leaf to root walks are needed
+//  - Counting is done with saturating bit sliced counters "at least one" and "at least two". We only need
+//    to know, if there is none, exactly one or more than one influencing or modified condition
+//
+// The result are 3 words with one bit per test pair for the 3 types of MCDC.
+//
+// For the unique cause fast mode, only test pairs that differ in exactly one condition are checked.
+// Then one bit of a word belongs to the test pair (x, x with flipped input bit) for 64 consecutive x.
+// The values for the flipped input are taken from another word or from the same word with swapped lanes.
+//
+// For the sampled search, the test pairs are in the same lane of 2 words. Then 64 independent test pairs
+// are checked at the same time.
+//
+// Before the classification, candidates can be selected with the observability of the leaves: The one
+// influencing leaf of an MC/DC test pair is observable for both test values and has different values.
+// So for one outer test value, only the leaves observable for it are of interest and only inner test
+// values, where one of these leaves is also observable with the opposite value, need to be classified.
+//
+
+
+#include "types.hpp"
+#include "ast.hpp"
+#include "nodevaluematrix.hpp"
+
+#include <vector>
+
+
+class InfluenceClassifier
+{
+public:
+	// Analyze the structure of the AST. The node value matrix must have been calculated for this AST
+	explicit InfluenceClassifier(const AST& ast, const NodeValueMatrix& nodeValueMatrix);
+	InfluenceClassifier(const InfluenceClassifier&) = delete;
+	InfluenceClassifier(const InfluenceClassifier&&) = delete;
+	InfluenceClassifier& operator =(const InfluenceClassifier&) = delete;
+	InfluenceClassifier& operator =(const InfluenceClassifier&&) = delete;
+
+	// Classify the test pairs (outer, inner) for all inner test values in word innerWordIndex of the node value matrix
+	// Bit i of the result words belongs to inner test value innerWordIndex * NumberOfBitSlicedLanes + i
+	void classify(uint outer, uint innerWordIndex);
+	// Classify the test pairs (outerWordIndex * NumberOfBitSlicedLanes + i, innerWordIndex * NumberOfBitSlicedLanes + i)
+	// So bit i of the result words belongs to the pair of the two test values in lane i of both words
+	void classifyPairs(uint outerWordIndex, uint innerWordIndex);
+	// Classify the test pairs (x, x ^ (1 << inputBit)) for all test values x in word wordIndex of the node value matrix
+	// Bit i of the result words belongs to test value x = wordIndex * NumberOfBitSlicedLanes + i
+	void classifyNeighbours(uint wordIndex, uint inputBit);
+
+	// Select the leaves that are observable for the outer test value. Returns false, if there is none
+	// Then no test pair with this outer test value can be an MC/DC test pair
+	bool selectObservableLeaves(uint outer);
+	// Leaves of an excluded condition will not be selected. Used, if enough test pairs for this condition have been found
+	void excludeCondition(cchar condition);
+	// Test pairs (outer, inner) for the inner test values in word innerWordIndex that may be MC/DC test pairs
+	// One of the selected leaves of the outer test value is also observable for the inner test value with a different value
+	BitSlicedRegisterType getCandidates(uint innerWordIndex) const noexcept;
+
+	// Results of the last classification. One bit per test pair
+	BitSlicedRegisterType getUniqueCause() const noexcept { return uniqueCause; }
+	BitSlicedRegisterType getUniqueCauseMasking() const noexcept { return uniqueCauseMasking; }
+	BitSlicedRegisterType getMasking() const noexcept { return masking; }
+
+	// The one influencing condition for a test pair of the last classification, given by the bit number
+	cchar getInfluencingCondition(uint lane) const noexcept;
+	// The name of the condition that belongs to a bit of the input value
+	cchar getConditionOfInputBit(uint inputBit) const noexcept;
+
+protected:
+	// Check the influence trees, after the changed state of all nodes has been set
+	void classifyChangedNodes();
+
+	// The node value matrix. Only read
+	const NodeValueMatrix& nodeValueMatrix;
+
+	// Nodes of the AST. Parents before children. The first element is the root
+	std::vector<uint> nodeIndexPreOrder{};
+	// Parent of a node. For the root this is ASTNoLinkedElement
+	std::vector<uint> parentIndex{};
+	// All leaves, so all conditions in the AST with their index and their lowercase name
+	std::vector<uint> leafIndex{};
+	std::vector<cchar> leafCondition{};
+	std::vector<uint> leafSourceMask{};
+	// For each different condition name, the indices in leafIndex. For strongly coupled conditions more than one
+	std::vector<std::vector<uint>> leavesOfCondition{};
+	// Leaves that shall not be selected as observable leaves
+	std::vector<bool> leafExcluded{};
+
+	// Leaves observable for the last selected outer test value. Index in the AST and all bits set to the value of the leaf
+	std::vector<uint> observableLeafIndex{};
+	std::vector<BitSlicedRegisterType> observableLeafValue{};
+
+	// Working data for one classification. Changed and path state per node. One bit per test pair
+	std::vector<BitSlicedRegisterType> changed{};
+	std::vector<BitSlicedRegisterType> onTruePath{};
+
+	// Results of the last classification
+	BitSlicedRegisterType uniqueCause{ null<BitSlicedRegisterType>() };
+	BitSlicedRegisterType uniqueCauseMasking{ null<BitSlicedRegisterType>() };
+	BitSlicedRegisterType masking{ null<BitSlicedRegisterType>() };
+};
+
+
+#endif
@@ -0,0 +1,141 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef JITCOMPILER_HPP
+#define JITCOMPILER_HPP
+
+//
+// Just in time compiler for boolean expressions
+//
+// The virtual machine for boolean expressions interprets a byte code. Even in bit sliced mode, where
+// 64 input values are calculated with one run of the program, each instruction needs to be decoded 
+// again and again. The same boolean expression is evaluated many thousand times.
+//
+// The just in time compiler (JIT) translates the object code of the code generator for the virtual machine
+// into native x86-64 machine code. The generated function calculates 64 input values in bit sliced mode 
+// (same as the virtual machine). Virtual machine registers are mapped to physical CPU registers. Only
+// if there are not enough CPU registers, values will be spilled to memory.
+//
+// The generated code is stored in a memory buffer, which is made executable after code generation.
+// The JIT is optional and must be activated with the option -jit. If the platform is not x86-64
+// or if executable memory cannot be allocated, the JIT is not available and the interpreter shall be used.
+//
+// The generated function has the signature
+//
+//		BitSlicedRegisterType function(const BitSlicedRegisterType* frame)
+//
+// frame[0..15] contains the bit sliced values of the variables for the 64 lanes. The rest of the frame
+// is used for spilled machine registers.
+//
+
+
+#include "types.hpp"
+#include "codegenerator.hpp"
+#include "virtualmachine.hpp"
+
+#include <vector>
+#include <cstdint>
+
+
+// Native code can only be generated for x86-64 CPUs
+#if defined(_M_X64) || defined(__x86_64__)
+#define JIT_COMPILER_X86_64
+#endif
+
+
+class JitCompilerForBooleanExpressions
+{
+public:
+	JitCompilerForBooleanExpressions() noexcept {}
+	~JitCompilerForBooleanExpressions() { releaseExecutableMemory(); }
+	// The object holds executable memory. So it shall not be copied
+	JitCompilerForBooleanExpressions(const JitCompilerForBooleanExpressions&) = delete;
+	JitCompilerForBooleanExpressions(const JitCompilerForBooleanExpressions&&) = delete;
+	JitCompilerForBooleanExpressions& operator =(const JitCompilerForBooleanExpressions&) = delete;
+	JitCompilerForBooleanExpressions& operator =(const JitCompilerForBooleanExpressions&&) = delete;
+
+	// Translate the object code into native machine code. Returns true, if native code is available
+	bool compile(ObjectCode& objectCode);
+
+	// Could native code be generated?
+	bool isAvailable() const noexcept { return null<NativeFunction>() != nativeFunction; }
+
+	// Run the native code for 64 consecutive input values, starting with sourceValueBase (must be a multiple of 64)
+	// Bit i of the result is the result for input value sourceValueBase + i
+	// The function does not modify the object. So many threads may use the same compiled code at the same time
+	BitSlicedRegisterType run(uint sourceValueBase) const;
+
+protected:
+	// Signature of the generated native function
+	using NativeFunction = BitSlicedRegisterType(*)(const BitSlicedRegisterType*);
+
+	// Virtual machine registers that do not fit into CPU registers will be spilled to the frame
+	// If the boolean expression needs more registers, then the JIT cannot be used
+	static constexpr uint MaxNumberOfJitRegisters{ 64U };
+	// The first part of the frame holds the values for the variables
+	static constexpr uint FrameOffsetForSpilledRegisters{ static_cast<uint>(MaxNumberOfBitsForEvaluation) };
+	static constexpr uint FrameSize{ FrameOffsetForSpilledRegisters + MaxNumberOfJitRegisters };
+
+	// An operand for an instruction. Either a CPU register or a memory location in the frame
+	struct Operand
+	{
+		bool isCpuRegister{ true };
+		uint8_t cpuRegister{ 0U };		// x86-64 register number
+		sint displacement{ 0 };			// Offset in the frame, if not a CPU register
+	};
+
+	// Register allocation. Virtual machine register to CPU register or frame location
+	Operand getOperandForMachineRegister(uint machineRegister) const noexcept;
+	Operand getOperandForVariable(uint variableIndex) const noexcept;
+
+	// Instruction encoding for the few x86-64 instructions that we need
+	void emitRegisterAndOperand(uint8_t opCode, uint8_t cpuRegister, const Operand& operand);
+	void emitLoad(uint8_t cpuRegister, const Operand& source);		// mov reg, r/m
+	void emitStore(const Operand& destination, uint8_t cpuRegister);	// mov r/m, reg
+	void emitNot(uint8_t cpuRegister);
+	void emitPush(uint8_t cpuRegister);
+	void emitPop(uint8_t cpuRegister);
+
+	// Allocation of executable memory
+	bool makeCodeExecutable();
+	void releaseExecutableMemory() noexcept;
+
+	// The generated machine code, before it is copied to executable memory
+	std::vector<uint8_t> machineCode{};
+
+	// Executable memory and the resulting function
+	void* executableMemory{ nullptr };
+	std::size_t executableMemorySize{ 0U };
+	NativeFunction nativeFunction{ nullptr };
+};
+
+#endif
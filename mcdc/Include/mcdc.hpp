@@ -120,9 +120,11 @@
 #include "types.hpp"
 #include "coverage.hpp"
 #include "mintermcalculater.hpp"
+#include "nodevaluematrix.hpp"
 
 #include <utility>
 #include <array>
+#include <sstream>
 
 // Type of MCDC for a test pair
 // Sequence of this values must not be changed!
@@ -145,6 +147,12 @@ inline const char* mcdcTypeToString(McdcType mt)
 // A pair of test values (decimal equivalent of a boolean value)
 using IndependencePair = std::pair<uint, uint>;
 
+// The search for test pairs is split into tasks for the thread pool. One task checks all pairs for some
+// consecutive outer test values. So many test pairs shall be checked by one task, roughly
+constexpr uint NumberOfTestPairsPerTask{ 65536U };
+// If the ASTs are printed, then the text output of a task is buffered until it is merged. Use smaller tasks then
+constexpr uint NumberOfTestPairsPerTaskWithOutput{ 1024U };
+
 
 // The MCDC Indepence Pair contains a pair of test value, the type of the MCDC and the condition for this test pair. Simple POD
 struct McdcIndependencePair
@@ -199,10 +207,27 @@ protected:
 	using ConditionSet = std::set<cchar>;
 
 
-	// Main worker horse
-	// Check if a Test pair is MCDC
-	std::pair<McdcType, cchar> getMcdcType(AST& astInfluencingTree);
-
+	// Result of the search for MCDC test pairs for a range of outer test values
+	// Each task of the thread pool has its own result. The results are merged in the order of the test values
+	// So the result is exactly the same as for a search with only one thread. The text output goes to an OrderedOutputSink
+	struct McdcSearchResult
+	{
+		TestVector mcdcIndependencePair{};	// Found test pairs. Same sequence as in the serial search
+		bool rangeComplete{ true };			// All test pairs of the range have been checked
+	};
+
+	// Check all test pairs (outer, inner) with outerBegin <= outer < outerEnd and outer < inner
+	// Found pairs are appended to the test vector, text output goes to os (only if withOutput is true)
+	// The search stops, if maxNumberOfTestPairs have been found or if the time budget is exhausted
+	// Returns true, if all test pairs of the range have been checked
+	// Does not modify the Mcdc object. Each call has its own influence classifier. So many tasks can run at the same time
+	bool findMcdcIndependencePairsForRange(uint outerBegin, uint outerEnd, const NodeValueMatrix& nodeValueMatrix, bool withOutput, std::ostream& os, TestVector& foundTestPairs, uint maxNumberOfTestPairs) const;
+
+	// Sampled search for decisions with many conditions. Checks random test pairs in rounds, until every condition has an
+	// MCDC test pair or until the given number of random test pairs has been checked. The values of the nodes are only
+	// calculated for the random test values. Same seed, same result, regardless of the number of threads
+	// Returns false, if the search has been stopped, because maxNumberOfTestPairs have been found or the time budget is exhausted
+	bool findMcdcIndependencePairsSampled(uint numberOfConditions, bool withOutput, std::ostream& os, TestVector& foundTestPairs, uint maxNumberOfTestPairs) const;
 
 	// Print evaluated and calculated "best" test sets
 	void printResult(const std::set<TestSet>& allTestSets, std::ostream& os);
@@ -255,6 +280,10 @@ protected:
 
 	// For output display purposes
 	VirtualMachineForAST astUsedForMcdcCalculation{};
+
+	// The search for test pairs has been stopped by the time limit or by the maximum number of test pairs
+	// Or the coverage analysis has been stopped by the time limit. Results will be marked as partial
+	bool searchIsPartial{ false };
 };
 
 
@@ -54,14 +54,19 @@
 //
 // The boolean function a+b (a or b) has the Minterms: 1,2,3
 //
-// All Minterms will be calculated and the result will be stored in a vector
+// All Minterms will be calculated and the words of the packed truth table (1 bit per input value)
+// will be streamed to a consumer, while they are calculated (See truthtablestream.hpp)
 // The complexity of the function is O(2**N). Meaning, needed space and calculation
 // time grows geometrically. 
 //
 //  More than 12 variables cannot be used in a reasonable timeframe.
-// This programm implements multithreading. But this is basically a meaningless approach
-// Even running on 8 threads, you can do 3 variables more. And then?
-// So, no further effort on runtime speed optimization
+// This programm implements multithreading. The input values are split into chunks of consecutive
+// truth table words. The chunks are calculated by the tasks of the thread pool, in the order in which 
+// the workers become free. A simple cost model decides, how many words a chunk needs, so that
+// the calculation is more expensive than the overhead of a task. If there is only one chunk, 
+// then no thread will be used at all. The size of the chunks can also be given by the user (-grain).
+// All tasks share the already loaded evaluators. They only read them. Each task writes its
+// results directly to its place in the truth table or in the chunk for the stream.
 // 
 // The resulting Mintermvector and the gathered Symbols will be used by other program
 // Parts for further evaluation.
@@ -69,11 +74,23 @@
 #include "types.hpp"
 #include "compiler.hpp"
 #include "virtualmachine.hpp"
+#include "widelanekernel.hpp"
+#include "jitcompiler.hpp"
+#include "graycodesweep.hpp"
+#include "objectcodeoptimizer.hpp"
 #include "symboltable.hpp"
+#include "truthtable.hpp"
+#include "truthtablestream.hpp"
 
 
 
 
+// Cost model for the multithreaded calculation
+// The costs are counted in executed instructions for one truth table word (64 input values)
+// A task of the thread pool should at least do so much work. Otherwise the overhead of the task is too big
+constexpr uint MinimumCostPerTask{ 8192U };
+// The interpreter of the virtual machine needs roughly this many times longer for one instruction than native or vector code
+constexpr uint InterpreterCostFactor{ 4U };
 
 
 // Calculates a vector with minterms from a boolean expression given as string
@@ -81,7 +98,7 @@ class MintermCalculator
 {
 public:
 	
-	explicit MintermCalculator(std::string& booleanExpression) : objectCode(), compiler(booleanExpression, objectCode), vmfbe(), source(booleanExpression) {}
+	explicit MintermCalculator(std::string& booleanExpression) : objectCode(), compiler(booleanExpression, objectCode), vmfbe(), wideLaneKernel(), jitCompiler(), grayCodeSweep(), source(booleanExpression) {}
 	MintermCalculator() = delete;
 	MintermCalculator(const MintermCalculator&) = delete;
 	MintermCalculator(const MintermCalculator&&) = delete;
@@ -91,8 +108,9 @@ public:
 
 	// This function is made public, becuase we want to know, if the syntax of the boolean expression is OK.
 	bool runCompiler() { objectCode.clear(); compilerResultOK = compiler(); return compilerResultOK; }
-	// Calculate all minterms
-	MintermVector calculate();
+	// Calculate all minterms and push the words of the truth table to the stream, as soon as they are available
+	// The stream will be closed at the end. Can be run asynchronously, while a consumer reads the stream
+	void calculate(TruthTableStream& truthTableStream);
 	
 	// Return the symbol table. Important to know the number of symbols and for print purposes
 	SymbolTable getSymbolTable() { return objectCode.symbolTable; }
@@ -106,11 +124,20 @@ protected:
 	// And this is the vector with all ranges we will use
 	using MintermRangeVector = std::vector<MintermRange>;
 
-	// Depending on available threads and number of variables, ranges can be calculated
-	MintermRangeVector calculateMintermRanges(uint numberOfRanges, uint upperBound);
-	
-	// This is the working horse. Run the virtual machine and calculate results
-	MintermVector calculateAsThread(MintermRange mt, ObjectCode objectCode);
+	// Split all input values into ranges with the given number of truth table words
+	MintermRangeVector calculateMintermRanges(uint numberOfWordsPerRange, uint upperBound);
+
+	// Compile, optimize and load the object code into all evaluators. Returns false for a syntax error
+	bool prepareCalculation();
+	// Cost model. Number of truth table words, that one task of the thread pool shall calculate
+	uint calculateNumberOfWordsPerTask();
+
+	// This is the working horse. Calculate the minterms for a range of input values. Use the JIT, the Gray code sweep 
+	// or the wide lane kernel, if available, else the bit sliced virtual machine
+	// The virtual machine runs in bit sliced mode and calculates 64 results at once. This is one word of the truth table
+	// The words are written to the preallocated destination. All evaluators are only read, so many tasks can run at the same time
+	// Each task needs its own register file for the virtual machine
+	void calculateRange(MintermRange mt, BitSlicedRegisterFile& registerFile, TruthTableWord* truthTableWord) const;
 
 	// The resulting object code from the compiler
 	// This is the input for the loader of the virtual machine
@@ -119,7 +146,16 @@ protected:
 	CompilerForVM compiler;
 
 	// Virtula machine used to calculate the result of an boolean expression for a given input
+	// Is loaded once and then shared by all threads. Each thread has its own register file
 	VirtualMachineForBooleanExpressions vmfbe;
+	// Vector register based kernel. Calculates 256 or 512 results at once, depending on the CPU
+	// Is loaded once and then shared by all threads
+	WideLaneKernelForBooleanExpressions wideLaneKernel;
+	// Optional just in time compiler. Generates native code for the boolean expression (option -jit)
+	// Is also shared by all threads
+	JitCompilerForBooleanExpressions jitCompiler;
+	// Optional Gray code sweep. Executes only the fan-out cone of the changed variable (option -gcs)
+	GrayCodeSweepForBooleanExpressions grayCodeSweep;
 
 	// Number of varaibles in the boolean expression
 	uint numberOfBooleanVariables{ 0U };
@@ -133,7 +169,7 @@ protected:
 };
 
 // Show the truth table on the basis of calculated Minterms and the Symboltable
-extern void printTruthTable(const std::string& source, MintermVector& mintermVector, const SymbolTable& symbolTable);
+extern void printTruthTable(const std::string& source, const TruthTable& truthTable, const SymbolTable& symbolTable);
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,171 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef NODEVALUEMATRIX_HPP
+#define NODEVALUEMATRIX_HPP
+
+//
+// Node Value Matrix. The values of all nodes of an AST for all possible input values
+//
+// For the search of MC/DC independence pairs, the AST must be evaluated for all possible test values.
+// Then, for every test pair, the node values of 2 evaluated ASTs are compared. Storing a complete
+// copy of the AST (with tokens, print helpers and the symbol table) for every test value needs
+// a huge amount of memory. Already for 16 conditions, this would be hundreds of MB.
+//
+// So, instead, we store for every node of the AST a truth table with one bit per input value.
+// Additionally, for boolean short cut evaluation, a second truth table per node indicates, if the
+// node has not been evaluated. For 16 conditions and an AST with 40 nodes, this is 320KB per table.
+//
+// The matrix is calculated bit sliced. 64 input values are packed in one machine word and all
+// nodes are evaluated with one bit operation for all 64 input values at the same time. The
+// results are identical to the results of VirtualMachineForAST::evaluateTree
+//
+// Bit x of the truth table of a node is the value of the node for input value x. The tables are stored
+// word major: The words of all nodes for the same 64 input values are stored consecutively. The calculation
+// and the pair search always go through all nodes for one word. So they read contiguous memory.
+// The matrix is read only after the calculation. So many threads can use it
+//
+// The truth table of the root is the truth table of the boolean expression. A test pair can only be an
+// MC/DC independence pair, if the outcome of the decision is different for both test values. So, for
+// the outcomes true and false, the matrix keeps a list of all words that contain at least one input
+// value with this outcome. The pair search checks only the words with the opposite outcome
+//
+// Additionally, the matrix stores for every node the observability: The node is observable for an input
+// value, if a change of its value would change the outcome of the decision. This is the boolean difference
+// of the decision with respect to the node. It is calculated top down: The root is always observable. A
+// child is observable, if its parent is observable and its sibling does not control the parent. That is,
+// the sibling is true for an AND and false for an OR, or it has not been evaluated (boolean short cut
+// evaluation). For an XOR, the sibling never controls the parent.
+// A leaf can only be the one influencing condition of an MC/DC test pair, if it is observable for both
+// test values of the pair. Otherwise its sibling on the path to the root would also have been changed,
+// and so there would be a second influencing condition. The pair search uses this to select candidates
+//
+// The calculation checks the run budget. If the time is over, the calculation stops and the matrix is
+// incomplete. An incomplete matrix must not be used for the pair search
+//
+
+
+#include "types.hpp"
+#include "ast.hpp"
+#include "virtualmachine.hpp"
+
+#include <vector>
+
+
+class NodeValueMatrix
+{
+public:
+	NodeValueMatrix() noexcept {}
+	NodeValueMatrix(const NodeValueMatrix&) = delete;
+	NodeValueMatrix(const NodeValueMatrix&&) = delete;
+	NodeValueMatrix& operator =(const NodeValueMatrix&) = delete;
+	NodeValueMatrix& operator =(const NodeValueMatrix&&) = delete;
+
+	// Evaluate the AST for all 2^numberOfConditions input values. Uses the thread pool
+	// The "not evaluated" tables are only calculated for boolean short cut evaluation
+	void calculate(const VirtualMachineForAST& virtualMachineForAst, uint numberOfConditions, bool booleanShortCutEvaluation);
+	// Evaluate the AST only for a list of input values. Used for the sampled search, where 2^numberOfConditions is too big
+	// Then "input value" x in all functions below is the index x in this list
+	void calculate(const VirtualMachineForAST& virtualMachineForAst, const std::vector<uint>& inputValue, bool booleanShortCutEvaluation);
+
+	// Value of a node for an input value
+	bool value(uint nodeIndex, uint inputValue) const noexcept
+	{
+		return 0U != ((nodeValue[((inputValue / NumberOfBitSlicedLanes) * numberOfNodes) + nodeIndex] >> (inputValue % NumberOfBitSlicedLanes)) & 1U);
+	}
+	// Node has not been evaluated for an input value, because of boolean short cut evaluation
+	bool notEvaluated(uint nodeIndex, uint inputValue) const noexcept
+	{
+		return withShortCutEvaluation && (0U != ((nodeNotEvaluated[((inputValue / NumberOfBitSlicedLanes) * numberOfNodes) + nodeIndex] >> (inputValue % NumberOfBitSlicedLanes)) & 1U));
+	}
+
+	// Word wordIndex of the truth table of a node. Bit i belongs to input value wordIndex * NumberOfBitSlicedLanes + i
+	BitSlicedRegisterType valueWord(uint nodeIndex, uint wordIndex) const noexcept { return nodeValue[(wordIndex * numberOfNodes) + nodeIndex]; }
+	// Same for the not evaluated flags. Without boolean short cut evaluation, all nodes are always evaluated
+	BitSlicedRegisterType notEvaluatedWord(uint nodeIndex, uint wordIndex) const noexcept { return withShortCutEvaluation ? nodeNotEvaluated[(wordIndex * numberOfNodes) + nodeIndex] : null<BitSlicedRegisterType>(); }
+
+	// Word wordIndex of the observability of a node. A bit is set, if the node is observable at the root for this input value
+	BitSlicedRegisterType observableWord(uint nodeIndex, uint wordIndex) const noexcept { return nodeObservable[(wordIndex * numberOfNodes) + nodeIndex]; }
+	// Node is observable for an input value
+	bool observable(uint nodeIndex, uint inputValue) const noexcept
+	{
+		return 0U != ((nodeObservable[((inputValue / NumberOfBitSlicedLanes) * numberOfNodes) + nodeIndex] >> (inputValue % NumberOfBitSlicedLanes)) & 1U);
+	}
+
+	// Outcome of the decision, so the value of the root, for an input value
+	bool outcome(uint inputValue) const noexcept { return nodeIndexPostOrder.empty() ? false : value(nodeIndexPostOrder.back(), inputValue); }
+	// Ascending indices of all words that contain at least one input value with the given outcome
+	const std::vector<uint>& getWordsWithOutcome(bool outcomeOfDecision) const noexcept { return outcomeOfDecision ? wordsWithTrueOutcome : wordsWithFalseOutcome; }
+
+	// Nodes of the AST in the sequence of the evaluation. Children before parents. The last element is the root
+	const std::vector<uint>& getNodeIndexPostOrder() const noexcept { return nodeIndexPostOrder; }
+
+	// Copy the node values for one input value to a virtual machine with the same AST. Used for printing the AST
+	void copyTo(VirtualMachineForAST& virtualMachineForAst, uint inputValue) const noexcept;
+
+	// Number of different input values. 2^numberOfConditions, or the number of input values in the list for a sampled calculation
+	uint getNumberOfInputValues() const noexcept { return numberOfInputValues; }
+	// All words have been calculated. False, if the time was over during the calculation
+	bool isComplete() const noexcept { return complete; }
+
+protected:
+	// Calculate all tables for the input values selected by one of the calculate functions
+	// The nodes are evaluated in the evaluation sequence of the virtual machine for the AST
+	void calculateTables(const VirtualMachineForAST& virtualMachineForAst);
+	// Evaluate all nodes for the input values in word wordIndex of the truth tables
+	void calculateWord(const AST& ast, uint wordIndex, std::vector<BitSlicedRegisterType>& maskedByParent);
+
+	// Nodes in the sequence of the evaluation. Children before parents. The last element is the root
+	// A copy of the evaluation sequence of the virtual machine for the AST
+	std::vector<uint> nodeIndexPostOrder{};
+
+	// The truth tables. wordIndex * numberOfNodes is the first word of the 64 input values in word wordIndex
+	std::vector<BitSlicedRegisterType> nodeValue{};
+	std::vector<BitSlicedRegisterType> nodeNotEvaluated{};
+	std::vector<BitSlicedRegisterType> nodeObservable{};
+
+	// Partition of the words of the truth tables by the outcome of the decision
+	std::vector<uint> wordsWithTrueOutcome{};
+	std::vector<uint> wordsWithFalseOutcome{};
+
+	// The input values for a sampled calculation. Empty, if the matrix has been calculated for all input values
+	std::vector<uint> sampledInputValue{};
+
+	uint numberOfInputValues{ 0U };
+	uint numberOfNodes{ 0U };
+	uint wordsPerNode{ 0U };
+	bool withShortCutEvaluation{ false };
+	bool complete{ false };
+};
+
+
+#endif
@@ -0,0 +1,129 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef OBJECTCODEOPTIMIZER_HPP
+#define OBJECTCODEOPTIMIZER_HPP
+
+//
+// Optimizer for the object code of the code generator for the virtual machine
+//
+// The code generator emits the code exactly as it has been parsed. So repeated literals like in
+// "a+a+a+b", double negations like "!!a", or operations like "x&x" and "x^x" are executed on every
+// evaluation. The same is true for common sub expressions, e.g. the same product term in different
+// parts of a big and not minimized boolean expression.
+//
+// The optimizer runs between the code generator and the loader of the virtual machine (or the other
+// evaluators). It works in the following steps:
+//
+// 1. Value numbering. Each op code line is translated to a value. Registers are no longer relevant.
+//    Equal values (same operation and same operands) get the same number. For the commutative
+//    operations AND, OR, XOR the operands are sorted. This is a common sub expression elimination (CSE).
+//
+// 2. While building the values, algebraic simplifications and constant folding are applied:
+//
+//		!!x --> x		x&x --> x		x|x --> x		x^x --> 0
+//		x&0 --> 0		x|0 --> x		x^0 --> x
+//		x&1 --> x		x|1 --> 1		x^1 --> !x
+//		x&!x --> 0		x|!x --> 1		x^!x --> 1
+//
+//    Constants cannot be expressed in the object code. They will be folded away. Only if the complete
+//    boolean expression is a constant (contradiction or tautology), then it will be calculated with "x^x".
+//
+// 3. Dead value elimination. Only values, that are needed for the result, will be kept.
+//
+// 4. Register allocation. Registers will be reused after the last usage of a value. So the number of
+//    registers is compacted.
+//
+// The symbol table is not modified. Even if a variable has been eliminated completely (e.g. "a^a+b"),
+// it is still a part of the boolean function and the number of input values does not change.
+//
+// The optimizer is active by default. It can be switched off with the option -nocopt
+//
+
+
+#include "types.hpp"
+#include "codegenerator.hpp"
+
+#include <vector>
+#include <map>
+#include <tuple>
+
+
+class ObjectCodeOptimizer
+{
+public:
+	ObjectCodeOptimizer() noexcept {}
+	ObjectCodeOptimizer(const ObjectCodeOptimizer&) = delete;
+	ObjectCodeOptimizer(const ObjectCodeOptimizer&&) = delete;
+	ObjectCodeOptimizer& operator =(const ObjectCodeOptimizer&) = delete;
+	ObjectCodeOptimizer& operator =(const ObjectCodeOptimizer&&) = delete;
+
+	// Optimize the object code in place
+	void optimize(ObjectCode& objectCode);
+
+protected:
+	// The values for the constants false and true have always these numbers
+	static constexpr uint ValueFalse{ 0U };
+	static constexpr uint ValueTrue{ 1U };
+
+	// One value. The operation is one of ID, NOT, AND, OR, XOR. Constants have the operation NONE
+	struct Value
+	{
+		Token operation{ Token::NONE };
+		uint operand1{ 0U };	// Letter index for ID, else value number
+		uint operand2{ 0U };	// Value number for binary operations
+	};
+
+	// Key for the value numbering
+	using ValueKey = std::tuple<Token, uint, uint>;
+
+	// Create new values or find existing ones. Simplification and constant folding is done here
+	uint getValueForVariable(uint letterIndex);
+	uint getValueForNot(uint operand);
+	uint getValueForBinaryOperation(Token operation, uint operand1, uint operand2);
+	uint findOrAddValue(Token operation, uint operand1, uint operand2, uint originalOperand1, uint originalOperand2);
+
+	// Check for constants and for the negation of a value
+	bool isConstant(uint valueNumber) const noexcept { return valueNumber <= ValueTrue; }
+	bool isNegationOf(uint valueNumber1, uint valueNumber2) const noexcept;
+
+	// Generate the new object code from the values, with register allocation
+	void generateObjectCode(ObjectCode& objectCode, uint resultValue, uint anyLetterIndex);
+
+	// All values. Index is the value number
+	std::vector<Value> value{};
+	// For finding equal values
+	std::map<ValueKey, uint> valueNumber{};
+};
+
+
+#endif
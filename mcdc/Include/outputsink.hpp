@@ -0,0 +1,120 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+
+
+#pragma once
+#ifndef OUTPUTSINK_HPP
+#define OUTPUTSINK_HPP
+
+//
+// Ordered output sink for phases, that produce text output in parallel
+//
+// The output streams of this program (see OutStreamSelection and OutputHandling::TeeStream) may be
+// std::cout, one or two files or a combination. They are not thread safe and they are constructed
+// inside the phases. If several threads would write to them, the output would be garbage.
+// But some phases produce huge reports. These reports shall be produced in parallel and still
+// look exactly like the report of a program with only one thread.
+//
+// So the report is split into parts with a sequence number. Each part is written by one thread into
+// its own buffer. When the part is complete, the thread informs the sink. The sink has one writer
+// thread, which writes the parts to the target stream in the order of their sequence numbers. A part
+// is written, when it is complete and all previous parts have been written. Then its buffer is freed.
+//
+// While the sink is active, no one else may write to the target stream. After finish() the target
+// stream can be used directly again.
+//
+
+
+#include "types.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace OutputHandling
+{
+
+	class OrderedOutputSink
+	{
+	public:
+		// All parts will be written to the target stream. The writer thread will be started here
+		explicit OrderedOutputSink(std::ostream& targetStream);
+		OrderedOutputSink(const OrderedOutputSink&) = delete;
+		OrderedOutputSink(const OrderedOutputSink&&) = delete;
+		OrderedOutputSink& operator =(const OrderedOutputSink&) = delete;
+		OrderedOutputSink& operator =(const OrderedOutputSink&&) = delete;
+		// Calls finish
+		~OrderedOutputSink();
+
+		// Get the buffer for the part with the given sequence number. Will be created at the first call
+		// The buffer has the same format settings as the target stream. Only one thread may write to it
+		std::ostringstream& part(uint sequenceNumber);
+		// The part is complete. It will be written, when all previous parts have been written
+		void complete(uint sequenceNumber);
+		// Write all complete parts, as long as there is no gap in the sequence, and stop the writer thread
+		// Parts, that are not complete or behind a gap, will be discarded
+		void finish();
+
+	protected:
+		// Main function of the writer thread
+		void writerLoop();
+
+		// A part of the output and its state
+		struct Part
+		{
+			std::ostringstream buffer{};
+			bool complete{ false };
+		};
+
+		std::ostream& target;
+		// Format settings of the target, when the sink was created. The target itself belongs to the writer thread
+		std::ios formatOfTarget{ nullptr };
+		// Parts that have not yet been written. Sorted by sequence number
+		std::map<uint, std::unique_ptr<Part>> pendingPart{};
+		// Sequence number of the next part to write
+		uint nextSequenceNumber{ 0U };
+
+		std::mutex sinkMutex{};
+		std::condition_variable partCompleted{};
+		// No further parts will come
+		bool finished{ false };
+		std::thread writer{};
+	};
+}
+
+#endif
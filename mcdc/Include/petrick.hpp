@@ -111,6 +111,7 @@ class PetricksMethod
 {
 public:
 	// Functors operator
+	// If the time budget is exhausted, the calculation stops and an empty result is returned
 	ProductTermVector operator()(const CNF& cnf);
 protected:
 };
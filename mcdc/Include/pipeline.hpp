@@ -0,0 +1,105 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+
+#pragma once
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+//
+// Pipeline with the final stages of the program
+//
+// After the minterms have been calculated, the program runs several independent analyses:
+// Printing of the truth table, the Quine & McCluskey minimization and the Abstract Syntax Tree
+// analysis with the search for MC/DC test pairs. Formerly they have been executed one after
+// the other. But most of them do not depend on each other. The AST analysis needs the result of
+// the Quine & McCluskey minimization only, if the minimized DNF shall be used (option -umdnf).
+//
+// So, each analysis is a stage of a pipeline. A stage may have predecessors. It will be started,
+// when all its predecessors are finished. Stages without dependencies will run at the same time.
+//
+// Each stage runs in its own thread (std::async) and not as a task in the thread pool. The stages
+// use the thread pool themselves and wait for the results. And a task must not wait for other tasks.
+//
+// The console output of the stages shall appear in the same sequence as in a sequential run.
+// Therefore every stage writes to its own stage console (see OutputHandling::console()). The
+// output is buffered until all previous stages are finished. Output to files is not handled.
+// The caller must check, that stages do not write to the same file, before running them concurrently
+//
+
+
+#include "types.hpp"
+
+#include <vector>
+#include <functional>
+
+
+class Pipeline
+{
+public:
+	// A stage is a function without parameters and without a result
+	using Stage = std::function<void()>;
+	// Stages are identified by their index, in the sequence as they have been added
+	using StageIndex = uint;
+
+	Pipeline() {}
+	Pipeline(const Pipeline&) = delete;
+	Pipeline(const Pipeline&&) = delete;
+	Pipeline& operator =(const Pipeline&) = delete;
+	Pipeline& operator =(const Pipeline&&) = delete;
+
+	// Add a stage. It will be started, when all the given predecessors are finished. The sequence of
+	// the console output is the sequence of adding. Predecessors must have been added before
+	StageIndex addStage(Stage stage, const std::vector<StageIndex>& predecessor = {});
+
+	// Run all stages and wait until all stages are finished. Either concurrently or one after the other
+	// An exception of a stage will be rethrown
+	void run(bool runConcurrently);
+
+protected:
+	// Run all stages in the sequence of adding. In the current thread
+	void runSequential();
+	// Run all stages in own threads and show their console output in the sequence of adding
+	void runConcurrent();
+
+	// A stage and its dependencies
+	struct StageDefinition
+	{
+		Stage stage;
+		std::vector<StageIndex> predecessor;
+	};
+	std::vector<StageDefinition> stageDefinition{};
+};
+
+
+#endif
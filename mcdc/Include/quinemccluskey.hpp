@@ -97,6 +97,8 @@
 #include "types.hpp"
 #include "symboltable.hpp"
 #include "coverage.hpp"
+#include "truthtable.hpp"
+#include "truthtablestream.hpp"
 
 
 
@@ -150,7 +152,14 @@ class QuineMcluskey
 public:
 	QuineMcluskey();
 
-	std::string getMinimumDisjunctiveNormalForm(MintermVector& mv, const SymbolTable& symbolTable, const std::string& source);
+	std::string getMinimumDisjunctiveNormalForm(const TruthTable& truthTable, const SymbolTable& symbolTable, const std::string& source);
+
+	// The initial table can be built, while the minterms are still calculated. Chunks must come in ascending order (See truthtablestream.hpp)
+	// If this has been used, then getMinimumDisjunctiveNormalForm will take the initial table from here and not from the truth table
+	void addMinterms(const TruthTableChunk& truthTableChunk);
+
+	// The time budget was exhausted. The resulting DNF is equivalent to the source, but not necessarily minimal
+	bool isPartialResult() const noexcept { return partialResult; }
 
 protected:
 
@@ -205,10 +214,18 @@ protected:
 	ReductionTable reductionTable;
 	// Resulting prime implicants
 	PrimeImplicantSet primeImplicantSetResult;
+	// Reduction or coverage analysis has been stopped, because the time budget was exhausted
+	bool partialResult{ false };
 
 
-	// Take a list with all minterms and fill initial table. Grouped by number of bits for each minterm entry
-	void initiate(MintermVector& mv);
+	// Take all minterms from the truth table and fill initial table. Grouped by number of bits for each minterm entry
+	void initiate(const TruthTable& truthTable);
+	// Add one minterm to the initial table
+	void addMintermToInitialTable(MinTermNumber mtn, BitsAndMinTerms& bitsAndMinTerms);
+
+	// Initial table built from streamed chunks of the truth table
+	BitsAndMinTerms streamedInitialTable{};
+	bool initialTableStreamed{ false };
 	// Find the prime implicants. Reduce boolean expression
 	void reduce();
 
@@ -228,28 +245,16 @@ protected:
 
 	// After a reduction round (Apllying the implication law
 	void collectPrimeImplicants(uint indexReductionTableColumn);
+	// If the reduction is stopped, then all terms of the last complete reduction table are taken. They are implicants, maybe not prime
+	void collectAllImplicants(uint indexReductionTableColumn);
 
-	void initializeCoverageForPrimeImplicants(Coverage& coverageForPrimeImplicants, MintermVector& mv, const SymbolTable& symbolTable);
-
+	void initializeCoverageForPrimeImplicants(Coverage& coverageForPrimeImplicants, const TruthTable& truthTable, const SymbolTable& symbolTable);
 
+	// If the time is over, then the prime implicant table will not be built. It could be very big, because the implicants are not prime.
+	// Instead the implicants are selected with a simple greedy heuristic. Fast, but not minimal
+	std::string getDisjunctiveNormalFormWithGreedyCover(const TruthTable& truthTable, const SymbolTable& symbolTable);
 
-	// Since programm runtime grows geometrically with the number of variables, we will use
-	// multi threading to reduce the calculation time
-	// Quine&  McCluskey reduction works on presorted tables. Presorted by number of bits in the minterms.
-	// SInce we want to apply the absorption law, we compare Minterm entries which just on different
-	// Setting of a varibale. On positive and one negated.
-	// We can use multi threading to calculate different blocks of Mintemrs with specific number of set bits
-	// So a bit count range is for example 0 through 4
-	using BitCountRange = std::pair<uint, uint>;
 
-	// A bit count range vector stores all bit counts for all minterms for the whole expression
-	// No overlap. NUmber of bits for the minterms of a boolean expression follow the standard binomial distribution
-	// We try to follow this approach. For 14 varaibles we will get the following BitCountRanges for 
-	// a system iwth 8 threads:  
-	// 1,3   3,5   5,6   6,7   7,8   8,9   9,11   11,14 
-	// This will help to speed up operations
-	using BitCountRangeVector = std::vector<BitCountRange>;
-	BitCountRangeVector calculateBoundsForMultiThreading(uint upper, uint lower);
 
 	// Print the calculated reduction tables. SOurce is only for output purposes. Source is not needed for any calculation
 	void printReductionTable(const SymbolTable& symbolTable, const std::string& source);
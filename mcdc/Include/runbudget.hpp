@@ -0,0 +1,93 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+
+
+#pragma once
+#ifndef RUNBUDGET_HPP
+#define RUNBUDGET_HPP
+
+//
+// Budget for the runtime of the program and cooperative cancellation
+//
+// For big boolean expressions some algorithms may run for hours. Especially the brute force search for
+// MC/DC test pairs and Petricks method, which is np-complete. Killing the program would lose everything.
+//
+// So the user can give a time limit with the command line option -tl. It is counted from the start of the
+// program. The long running loops check cooperatively, if the time is over. Then they stop and the
+// algorithm shows the best result found so far, for example the test pairs found until then or a greedy
+// coverage instead of the minimum coverage of Petricks method. Such results are marked as partial.
+//
+// Once the budget is exhausted, it stays exhausted. So all following algorithms will also take the
+// fast path and the program will end soon.
+//
+
+
+#include "types.hpp"
+
+#include <chrono>
+#include <atomic>
+
+
+class RunBudget
+{
+public:
+	RunBudget() noexcept : startTime(std::chrono::steady_clock::now()), deadline(startTime) {}
+	RunBudget(const RunBudget&) = delete;
+	RunBudget(const RunBudget&&) = delete;
+	RunBudget& operator =(const RunBudget&) = delete;
+	RunBudget& operator =(const RunBudget&&) = delete;
+
+	// Read the time limit from the command line options. Must be called after the evaluation of the options
+	void start();
+
+	// Check, if the time is over. Can be called from any thread. Cheap enough to be called in loops
+	bool isExhausted() noexcept;
+
+protected:
+	// Start of the program. The time limit is counted from here
+	const std::chrono::steady_clock::time_point startTime;
+	// Point of time, when the budget is exhausted. Only valid, if there is a time limit
+	std::chrono::steady_clock::time_point deadline;
+	// A time limit has been given
+	bool timeLimitSet{ false };
+	// Budget has been exhausted. Stays set
+	std::atomic<bool> exhausted{ false };
+};
+
+
+// Yes, a global variable. There is one budget for the whole program
+extern RunBudget runBudget;
+
+
+#endif
@@ -0,0 +1,140 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+#pragma once
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+//
+// Process wide thread pool with work stealing
+//
+// Formerly, threads were started ad hoc with std::async, wherever some parallel work could be done.
+// The number of threads was fixed to 8. On big machines most of the cores were idle and on small
+// machines the system was oversubscribed. And in the Quine & McCluskey reduction new threads were
+// created in every reduction round.
+//
+// Now there is one thread pool for the whole program. It is started, when the first task is
+// submitted. The number of worker threads is given by the command line option -threads or, if not
+// given, by the number of hardware threads.
+//
+// Each worker has its own queue of tasks. A worker takes the newest task from its own queue. If
+// its own queue is empty, it steals the oldest task from another queue. Tasks submitted from
+// outside the pool are distributed round robin over all queues. So many small tasks can be
+// submitted and the load will be balanced automatically.
+//
+// Important: A task must not wait for the result of another task. Waiting is only allowed for
+// threads outside the pool. Otherwise all workers could be blocked.
+//
+
+
+#include "types.hpp"
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+
+class ThreadPool
+{
+public:
+	// A task is a function without parameters and without a result
+	using Task = std::function<void()>;
+
+	ThreadPool() {}
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool(const ThreadPool&&) = delete;
+	ThreadPool& operator =(const ThreadPool&) = delete;
+	ThreadPool& operator =(const ThreadPool&&) = delete;
+	// Stops and joins all worker threads
+	~ThreadPool();
+
+	// Add a task to the pool. The future will be ready, when the task has been executed
+	std::future<void> submit(Task task);
+
+	// Execute function(begin, end) for sub ranges of [begin, end) with a size of grainSize in parallel
+	// and wait until all sub ranges have been processed. Must not be called from a task
+	void parallelFor(uint begin, uint end, uint grainSize, const std::function<void(uint, uint)>& function);
+
+	// Execute task(i) for all i in [0, numberOfTasks) in parallel and consume(i) in ascending order of i by the calling thread,
+	// as soon as task(i) has finished. Only so many tasks are submitted in advance of the consumer. This limits the memory for
+	// the results. If consume returns false, no more tasks will be started. Running tasks are waited for in any case, so they
+	// may use local data of the caller. Must not be called from a task
+	void parallelForOrdered(uint numberOfTasks, const std::function<void(uint)>& task, const std::function<bool(uint)>& consume);
+
+	// Number of worker threads. Given by the user or by the hardware
+	uint getNumberOfThreads();
+
+protected:
+	// Start the worker threads. Done once, at the first use of the pool
+	void start();
+	// Main function of a worker thread
+	void workerLoop(uint workerIndex);
+	// Get a task from the own queue or steal one from another queue
+	bool getTask(uint workerIndex, Task& task);
+
+	// Queue with tasks for one worker
+	struct WorkQueue
+	{
+		std::mutex queueMutex;
+		std::deque<Task> task;
+	};
+	std::vector<std::unique_ptr<WorkQueue>> workQueue{};
+
+	// The worker threads
+	std::vector<std::thread> worker{};
+	uint numberOfThreads{ 0U };
+	std::once_flag startFlag{};
+
+	// Idle workers wait for new tasks
+	std::mutex poolMutex{};
+	std::condition_variable taskAvailable{};
+	// Number of tasks in all queues
+	std::atomic<uint> numberOfQueuedTasks{ 0U };
+	// Next queue for tasks submitted from outside the pool
+	std::atomic<uint> nextWorkQueue{ 0U };
+	// Pool shall be stopped
+	bool stop{ false };
+};
+
+
+// Yes, a global variable. There is one thread pool for the whole program
+extern ThreadPool threadPool;
+
+
+#endif
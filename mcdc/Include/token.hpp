@@ -58,7 +58,10 @@ enum class Token :uint8_t
 	BCLOSE, 
 	END, 
 	EXPR, 
-	IDNOT 
+	IDNOT,
+	// Not produced by the scanner. Conditional jumps for the short circuit evaluation in the virtual machine
+	JUMPFALSE,
+	JUMPTRUE
 };
 
 
@@ -76,6 +79,10 @@ struct TokenWithAttribute
 	cchar inputTerminalSymbol{ '.' };
 	// And the same in lower case
 	cchar inputSymbolLowerCase{ ' ' };
+
+	// Code generator for the virtual machine only: Index of the first op code line of an expression
+	// Needed to insert conditional jumps in front of the right hand operand (short circuit evaluation)
+	uint codeStartIndex{ 0U };
 };
 
 
@@ -0,0 +1,178 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef TRUTHTABLE_HPP
+#define TRUTHTABLE_HPP
+
+//
+// Packed truth table for a boolean function
+//
+// The result of the minterm calculation is the truth table of the boolean expression. So for
+// all 2^n input values the result true or false. Formerly this was stored as a vector with minterms.
+// With up to 2^16 minterms and 8 bytes per entry (uint_fast16_t on some platforms) this needs
+// up to 512KB. And checking, if an input value is a minterm, means searching in the vector.
+//
+// The truth table in this file stores 1 bit per input value. Bit i of word j belongs to the
+// input value 64*j + i. This is the same format as the result of the bit sliced virtual machine.
+// For 16 variables we need 8KB and the check for a minterm is O(1).
+//
+// If the boolean function is very sparse (only few minterms) or very dense (only few maxterms),
+// then the truth table switches automatically to a sparse representation. Then only the sorted list 
+// of the minterms or the sorted list of the maxterms is stored. The switch is done in "compact",
+// after the truth table has been filled completely.
+//
+// The truth table has helpers for
+//	- Counting the minterms (popcount)
+//	- Iteration over all minterms in ascending order (range based for loop)
+//	- Rank: number of minterms below an input value
+//	- Membership: Is an input value a minterm?
+//
+
+
+#include "types.hpp"
+
+#include <vector>
+#include <iterator>
+
+
+// One word of the dense truth table. 64 input values
+using TruthTableWord = uint64;
+constexpr uint NumberOfBitsInTruthTableWord{ 64U };
+
+
+// How the truth table is stored
+enum class TruthTableRepresentation : uint
+{
+	Dense,				// 1 bit per input value
+	SparseMinterms,		// Sorted list of minterms. For very sparse functions
+	SparseMaxterms		// Sorted list of maxterms. For very dense functions
+};
+
+
+class TruthTable
+{
+public:
+	// Iterator over all minterms in ascending order
+	class ConstIterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = MinTermNumber;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const MinTermNumber*;
+		using reference = const MinTermNumber&;
+
+		ConstIterator(const TruthTable* truthTableForIterator, uint inputValue) noexcept : truthTable(truthTableForIterator), currentInputValue(inputValue), currentMinterm(narrow_cast<MinTermNumber>(inputValue)) {}
+
+		reference operator *() const noexcept { return currentMinterm; }
+		ConstIterator& operator ++() noexcept { currentInputValue = truthTable->findNextMinterm(currentInputValue + 1U); currentMinterm = narrow_cast<MinTermNumber>(currentInputValue); return *this; }
+		ConstIterator operator ++(sint) noexcept { ConstIterator tmp{ *this }; ++(*this); return tmp; }
+		bool operator ==(const ConstIterator& other) const noexcept { return currentInputValue == other.currentInputValue; }
+		bool operator !=(const ConstIterator& other) const noexcept { return currentInputValue != other.currentInputValue; }
+
+	protected:
+		const TruthTable* truthTable;
+		uint currentInputValue;
+		MinTermNumber currentMinterm;
+	};
+
+
+	// Empty truth table (contradiction) for the given number of boolean variables
+	explicit TruthTable(uint numberOfBooleanVariablesForTable = 0U) { reset(numberOfBooleanVariablesForTable); }
+
+	// Clear everything and set a new number of variables. Representation will be dense
+	void reset(uint numberOfBooleanVariablesForTable);
+
+	// Building the truth table. Only in dense representation. Not set bits for input values >= 2^n will be ignored
+	// Different threads may set different words at the same time
+	void setWord(uint wordIndex, TruthTableWord word) noexcept;
+	void setMinterm(uint inputValue) noexcept;
+	// Direct access to the words of the dense representation. For producers, that write the words in place
+	// Bits for input values >= 2^n must be 0. Different threads may write different words at the same time
+	TruthTableWord* wordData() noexcept { return word.data(); }
+
+	// After all words have been set, count minterms and switch to a sparse representation, if this saves memory
+	void compact();
+
+	// Membership. Is the input value a minterm?
+	bool isMinterm(uint inputValue) const noexcept;
+	bool operator[](uint inputValue) const noexcept { return isMinterm(inputValue); }
+
+	// Popcount. Number of minterms. Valid after compact
+	uint numberOfMinterms() const noexcept { return mintermCount; }
+	// Number of input values. 2^n
+	uint numberOfInputValues() const noexcept { return 1U << numberOfBooleanVariables; }
+	uint getNumberOfBooleanVariables() const noexcept { return numberOfBooleanVariables; }
+	// Contradiction or tautology
+	bool isContradiction() const noexcept { return null<uint>() == mintermCount; }
+	bool isTautology() const noexcept { return numberOfInputValues() == mintermCount; }
+
+	// Rank. Number of minterms, that are smaller than the given input value. Valid after compact
+	uint rank(uint inputValue) const noexcept;
+
+	// Iteration over all minterms in ascending order
+	ConstIterator begin() const noexcept { return ConstIterator(this, findNextMinterm(0U)); }
+	ConstIterator end() const noexcept { return ConstIterator(this, numberOfInputValues()); }
+
+	// Compatibility with older functions
+	MintermVector mintermVector() const;
+
+	// Current internal representation
+	TruthTableRepresentation getRepresentation() const noexcept { return representation; }
+
+protected:
+	// Find the next minterm, which is equal or greater than the input value. Returns 2^n, if there is none
+	uint findNextMinterm(uint inputValue) const noexcept;
+
+	// Number of words needed for the dense representation
+	uint numberOfWords() const noexcept { return (numberOfInputValues() + NumberOfBitsInTruthTableWord - 1U) / NumberOfBitsInTruthTableWord; }
+
+	// Number of set bits in a word
+	static uint countSetBits(TruthTableWord word) noexcept;
+
+	// Number of variables in the boolean function
+	uint numberOfBooleanVariables{ 0U };
+	// Current representation
+	TruthTableRepresentation representation{ TruthTableRepresentation::Dense };
+	// Number of minterms
+	uint mintermCount{ 0U };
+
+	// Dense representation. 1 bit per input value
+	std::vector<TruthTableWord> word{};
+	// Number of minterms in all words before a word. For fast rank calculation
+	std::vector<uint> mintermsBeforeWord{};
+	// Sparse representation. Sorted list with minterms or maxterms
+	MintermVector sparseTerm{};
+};
+
+
+#endif
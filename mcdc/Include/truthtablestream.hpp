@@ -0,0 +1,120 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+#pragma once
+#ifndef TRUTHTABLESTREAM_HPP
+#define TRUTHTABLESTREAM_HPP
+
+//
+// Streaming of truth table words
+//
+// The minterm calculator evaluates the boolean expression for all 2^n input values. Formerly the
+// complete result was built first and the consumers (building the truth table, grouping the
+// minterms by number of set bits for Quine & McCluskey, checking for contradiction or tautology)
+// could only start, when everything was finished.
+//
+// With the stream in this file, the minterm calculator pushes chunks of truth table words, as soon
+// as they have been calculated. A consumer pulls the chunks with "next" and can work on them, while
+// the calculation is still running.
+//
+// The calculation threads work on different ranges and will push their chunks in any order.
+// The stream delivers the chunks always in ascending order of the input values. Chunks, that arrived
+// too early, are buffered. The number of buffered chunks is limited. If the buffer is full, then
+// producers have to wait. Only the chunk, that the consumer is waiting for, will always be accepted.
+// So the producers cannot block each other and the memory consumption stays low.
+//
+// Usage:
+//	Producer: push, push, push, . . . and finally close
+//	Consumer: while (stream.next(chunk)) { . . . }
+//
+
+
+#include "types.hpp"
+#include "truthtable.hpp"
+
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+
+
+// Some consecutive words of the truth table. Bit i of word j belongs to input value 64*(firstWordIndex+j) + i
+struct TruthTableChunk
+{
+	uint firstWordIndex{ 0U };
+	std::vector<TruthTableWord> word{};
+};
+
+// Number of chunks that can be buffered, before a producer must wait
+constexpr uint DefaultMaxNumberOfBufferedChunks{ 64U };
+
+
+class TruthTableStream
+{
+public:
+	explicit TruthTableStream(uint maxNumberOfBufferedChunksForStream = DefaultMaxNumberOfBufferedChunks) : maxNumberOfBufferedChunks(maxNumberOfBufferedChunksForStream) {}
+	TruthTableStream(const TruthTableStream&) = delete;
+	TruthTableStream(const TruthTableStream&&) = delete;
+	TruthTableStream& operator =(const TruthTableStream&) = delete;
+	TruthTableStream& operator =(const TruthTableStream&&) = delete;
+	~TruthTableStream() {}
+
+	// Producer side. Add a chunk. May wait, if too many chunks are buffered. Can be called from different threads
+	void push(TruthTableChunk&& chunk);
+	// Producer side. No more chunks will follow
+	void close();
+
+	// Consumer side. Get the next chunk in ascending order. Waits until it is available
+	// Returns false, if the stream has been closed and all chunks have been delivered
+	bool next(TruthTableChunk& chunk);
+
+protected:
+	// Protects all data below
+	std::mutex streamMutex;
+	// Consumer waits for the next chunk
+	std::condition_variable chunkAvailable;
+	// Producers wait for free space in the buffer
+	std::condition_variable spaceAvailable;
+
+	// Chunks that have been pushed, but not yet delivered. Sorted by first word index
+	std::map<uint, TruthTableChunk> bufferedChunk{};
+	// The consumer is waiting for the chunk that starts with this word
+	uint nextWordIndex{ 0U };
+	// Buffer limit
+	uint maxNumberOfBufferedChunks{ DefaultMaxNumberOfBufferedChunks };
+	// The producer closed the stream
+	bool closed{ false };
+};
+
+
+#endif
@@ -55,6 +55,7 @@ using ull = unsigned long long;
 using sll = signed long long;
 
 using uint32 = uint_fast32_t;
+using uint64 = uint_fast64_t;
 
 
 
@@ -154,9 +155,6 @@ using CNF = std::vector<DNF>;
 
 
 
-constexpr uint numberOfThreads{ 8U };
-
-
 // There are max 26 charachters in the latin alphabeth. So, 32 bits is always sufficient
 constexpr sint MaxNumberOfBitmasksForMaskingBooleanInput{ 32 };
 
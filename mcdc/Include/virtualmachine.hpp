@@ -44,9 +44,9 @@
 // This is comparable with a linker.
 //
 // The generated executable program can be printed.
-// The program consist of Opcodes. Each Opcode has a  execution function
-// and up to 3 parameters. The program can be run and will then interpret opcodes
-// end execute them. The input variable value (given as a parameter) will be
+// The program consist of a compact byte code. Each instruction has an operation byte
+// and up to 3 operands. The program can be run and an interpreter loop will then 
+// execute the instructions one after the other. The input variable value (given as a parameter) will be
 // assigned to the boolean variables. Intermediate results will be stored in machine registers.
 // Machine Registers are temporary memory locations that can also be reused.
 // The boolean expression will be evaluated according to the program and the result will be returned.
@@ -59,66 +59,129 @@
 #include "types.hpp"
 #include "codegenerator.hpp"
 
-#include <functional> 
+#include <cstdint>
 
 
 
 using MachineRegisterType = uint_fast8_t;
 
+// For the bit sliced execution mode. One machine register holds the results for 64 different input values.
+// Bit i of a register (the lane i) belongs to the input value "sourceValueBase + i"
+using BitSlicedRegisterType = uint64;
+constexpr uint NumberOfBitSlicedLanes{ 64U };
+// For the lowest 6 bits of the input value, the value of a variable is different in each lane
+// and follows a fixed pattern. Example: Bit 0 is 0,1,0,1,0,1 . . .  and bit 1 is 0,0,1,1,0,0,1,1 . . .
+constexpr std::array<BitSlicedRegisterType, 6> bitSlicedLanePattern
+{
+	0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+	0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+};
+
+
+// The operations of the byte code for the virtual machine
+enum class ByteCode : uint8_t
+{
+	LoadID,		// Operand1: Normalized variable index, Operand2: destination register, Operand3: leaf number
+	LoadNotID,	// Operand1: Normalized variable index, Operand2: destination register, Operand3: leaf number
+	Or,			// Operand1, Operand2: source registers, Operand3: destination register
+	Xor,		// Operand1, Operand2: source registers, Operand3: destination register
+	And,		// Operand1, Operand2: source registers, Operand3: destination register
+	Not,		// Operand1: source register, Operand2: destination register
+	End,		// Operand1: register with the result of the program
+	JumpIfFalse,// Operand1: condition register, Operand2: jump target, Operand3: destination register (gets condition)
+	JumpIfTrue	// Operand1: condition register, Operand2: jump target, Operand3: destination register (gets condition)
+};
+
+// Bit mask with the evaluated leaves of the boolean expression. Bit i of word i/64 is set, if the i-th
+// variable occurence in the boolean expression (counted from left to right) has been evaluated
+// Only meaningful for programs with conditional jumps (boolean short cut evaluation)
+using EvaluatedLeaves = std::vector<uint64>;
+
+// Register file for the bit sliced mode. One 64 bit register for each machine register
+using BitSlicedRegisterFile = std::vector<BitSlicedRegisterType>;
+
 
 class VirtualMachineForBooleanExpressions
 {
 
 public:
-	// The virtual machin loads the object code and creates an executable programm. 
+	// The virtual machin loads the object code and creates an executable programm. Nothing will be printed
+	void load(ObjectCode& objectCode);
+	// Load the object code and print the resulting program
 	void load(ObjectCode& objectCode, const  std::string& source);	// source is for debug purposes only
 	
 	// Run the executable code with an input source value of sv
+	// Conditional jumps will be taken. So with short cut evaluation code, not all instructions will be executed
 	bool run(uint sv);
+	// Same as above, but additionally record, which leaves (variable occurences) have been evaluated
+	bool run(uint sv, EvaluatedLeaves& evaluatedLeaves);
+	// Number of leaves (variable occurences) in the loaded program
+	uint getNumberOfLeaves() const noexcept { return numberOfLeaves; }
+#ifdef _DEBUG
+	// Check the loaded program against the evaluation of the AST for the same boolean expression. For all input values,
+	// the results and the evaluated leaves must be the same. Used for the program with conditional jumps and
+	// an AST, that is evaluated with boolean short cut evaluation. Self test for debug builds only
+	bool isEquivalentTo(VirtualMachineForAST& virtualMachineForAst);
+#endif
+
+	// Run the executable code in bit sliced mode for 64 consecutive input values at once
+	// The sourceValueBase must be a multiple of 64. Bit i of the result is the result for input value sourceValueBase + i
+	// The lanes cannot take different paths. So conditional jumps will be ignored. The result is the same
+	BitSlicedRegisterType runBitSliced(uint sourceValueBase);
+	// Same as above, but with an external register file. The loaded program is only read
+	// So many threads can run the same loaded virtual machine at the same time, each with its own register file
+	BitSlicedRegisterType runBitSliced(uint sourceValueBase, BitSlicedRegisterFile& registerFile) const;
+	// Create a register file with the size needed by the loaded program
+	BitSlicedRegisterFile createBitSlicedRegisterFile() const { return BitSlicedRegisterFile(bitSlicedMachineRegister.size(), null<BitSlicedRegisterType>()); }
 
 
 protected:
 
+	// Show the loaded program. The source is for output purposes only
+	void printProgram(const ObjectCode& objectCode, const std::string& source);
+
+	// The interpreter loop for both run functions. Records the evaluated leaves only if requested
+	template <bool RecordEvaluatedLeaves>
+	bool interpret(uint sv, EvaluatedLeaves* evaluatedLeaves);
+
 	// For operations LoadID and LoadNotID
 	MachineRegisterType getSourceValue(uint index) noexcept;
 	MachineRegisterType getSourceValueNegated(uint index) noexcept;
+	// For operations LoadID and LoadNotID in bit sliced mode. Returns the value of the variable for all 64 lanes
+	static BitSlicedRegisterType getSourceValueBitSliced(uint index, uint sourceValueBase) noexcept;
 
 	// Machine registers for storing intermediate calculation results
+	// The size of the register file is set by the loader and will not change while running a program
 	std::vector<MachineRegisterType> machineRegister;
+	// Machine registers for the bit sliced mode. Same number of registers, but each is 64 bit wide
+	BitSlicedRegisterFile bitSlicedMachineRegister;
 
 	// When the program is run, then the value in this variable will be used as input and mapped to the boolean variables
 	uint32 sourceValue{ null<uint32>() };
 	// Holds the number of literals in the boolean expression. Get from symbol table in object code
 	uint numberOfLiterals{ 0U };
+	// Number of load operations (leaves) in the program
+	uint numberOfLeaves{ 0U };
 
 
-	// A program consists of executable code lines
-	// The virtual machine can interpret opcodes with 3 parameters
-	struct ExecutableCodeLine
+	// A program consists of byte code instructions
+	// One byte for the operation and 3 operands with 16 bit. So one instruction needs 8 bytes
+	struct ByteCodeInstruction
 	{
-		std::function<void(uint, uint, uint)>  execute;	// One of the functions defined below. Will be set by the loader
-		// Up to 3 parameters for the opcode
-		uint parameter1{ null< uint>() };
-		uint parameter2 { null< uint>() };
-		uint parameter3 { null< uint>() };
+		ByteCode operation{ ByteCode::End };
+		uint16_t operand1{ 0U };
+		uint16_t operand2{ 0U };
+		uint16_t operand3{ 0U };
 	};
 
 	// The executable program
-	using Program = std::vector<ExecutableCodeLine>;
+	using Program = std::vector<ByteCodeInstruction>;
 	Program program;
 
 	// The result of an executed program
 	MachineRegisterType programResult{};
-
-	// The executables for one opcode
-	void operationLoadID(uint source, uint destination, uint) { machineRegister[destination] = getSourceValue(source); }
-	void operationLoadNotID(uint source, uint destination, uint) { machineRegister[destination] = getSourceValueNegated(source); }
-	void operationOr(uint source1, uint source2, uint destination) { machineRegister[destination] = narrow_cast<MachineRegisterType>(machineRegister[source1] | machineRegister[source2]); }
-	void operationXor(uint source1, uint source2, uint destination) { machineRegister[destination] = narrow_cast<MachineRegisterType>(machineRegister[source1] ^ machineRegister[source2]); }
-	void operationAnd(uint source1, uint source2, uint destination) { machineRegister[destination] = narrow_cast<MachineRegisterType>(machineRegister[source1]&  machineRegister[source2]); }
-	void operationNot(uint source, uint destination, uint) { machineRegister[destination] = narrow_cast<MachineRegisterType>((~machineRegister[source]&  bitMask[0])); }
-	void operationEnd(uint source, uint, uint) { programResult = machineRegister[source]; }
-
+	// The result of a program executed in bit sliced mode
+	BitSlicedRegisterType bitSlicedProgramResult{};
 };
 
 
@@ -135,4 +198,21 @@ inline MachineRegisterType VirtualMachineForBooleanExpressions::getSourceValueNe
 	return result;
 }
 
+// In bit sliced mode, the 64 lanes hold the input values sourceValueBase+0 ... sourceValueBase+63
+// For the lowest 6 bits of the input value, the value of the variable is taken from the lane pattern
+// All higher bits are the same for all lanes. They are taken from sourceValueBase and broadcasted to all lanes
+inline BitSlicedRegisterType VirtualMachineForBooleanExpressions::getSourceValueBitSliced(uint index, uint sourceValueBase)  noexcept
+{
+	BitSlicedRegisterType result{ null<BitSlicedRegisterType>() };
+	if (index < bitSlicedLanePattern.size())
+	{
+		result = bitSlicedLanePattern[index];
+	}
+	else
+	{
+		result = (null<uint32>() == (sourceValueBase&  bitMask[index])) ? null<BitSlicedRegisterType>() : ~null<BitSlicedRegisterType>();
+	}
+	return result;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,132 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+#ifndef WIDELANEKERNEL_HPP
+#define WIDELANEKERNEL_HPP
+
+//
+// A wide lane kernel to calculate the truth table of a boolean expression
+//
+// The virtual machine for boolean expressions can run in bit sliced mode. Then each bit of a 64 bit
+// machine register belongs to a different input value. So one run of the program calculates 64
+// results of the truth table.
+//
+// Modern CPUs have vector registers with 256 bit (AVX2) or 512 bit (AVX-512). The kernel in this
+// file uses those vector registers as machine registers. So one run of the program calculates 256
+// or 512 results of the truth table. For 16 variables we need then only 128 runs.
+//
+// The kernel is loaded directly with the object code from the code generator for the virtual machine.
+// Which vector extension will be used is decided at runtime, depending on the capabilities of the CPU.
+// If the CPU (or the compiler/platform) does not support any of the vector extensions, then the 
+// kernel is not available and the bit sliced virtual machine shall be used as portable fallback.
+//
+// The result of a kernel run is a sequence of 64 bit truth table words. Bit i of word j belongs to the
+// input value sourceValueBase + 64*j + i.
+//
+
+
+#include "types.hpp"
+#include "codegenerator.hpp"
+#include "virtualmachine.hpp"
+
+#include <vector>
+
+
+// Vector extensions are only available for x86-64 CPUs
+#if defined(_M_X64) || defined(__x86_64__)
+#define WIDE_LANE_KERNEL_X86_64
+#endif
+
+
+// The available back ends for the wide lane kernel. Sorted by width
+enum class WideLaneBackend : uint
+{
+	None,		// No vector extension available. Use bit sliced virtual machine
+	Avx2,		// 256 lanes
+	Avx512		// 512 lanes
+};
+
+
+class WideLaneKernelForBooleanExpressions
+{
+public:
+	// The best available back end will be selected already at construction time
+	WideLaneKernelForBooleanExpressions() noexcept : program(), backend(detectBackend()) {}
+
+	// Load the object code and create the kernel program
+	void load(ObjectCode& objectCode);
+
+	// Is there a usable back end. If not, the bit sliced virtual machine must be used
+	bool isAvailable() const noexcept { return WideLaneBackend::None != backend; }
+	// Number of input values that will be calculated with one run
+	uint lanesPerRun() const noexcept;
+
+	// Run the kernel program for lanesPerRun() input values starting with sourceValueBase (must be a multiple of 64)
+	// lanesPerRun()/64 truth table words will be written to result
+	// The function does not modify the kernel. So many threads may use the same kernel at the same time
+	void run(uint sourceValueBase, BitSlicedRegisterType* result) const;
+
+	// Check the CPU and select the widest possible back end
+	static WideLaneBackend detectBackend() noexcept;
+
+protected:
+	// Registers are allocated locally in the run function. The code generator reuses registers
+	// So the number of needed registers is normally very small
+	static constexpr uint MaxNumberOfKernelRegisters{ 64U };
+
+	// One line of the kernel program. Same meaning of parameters as in the object code
+	// But load operations have already the normalized variable index in parameter1
+	struct KernelCodeLine
+	{
+		Token token{ Token::NONE };
+		uint parameter1{ 0U };
+		uint parameter2{ 0U };
+		uint parameter3{ 0U };
+	};
+	using Program = std::vector<KernelCodeLine>;
+	Program program;
+
+	// The selected back end
+	WideLaneBackend backend;
+
+	// Calculate the values of all variables for all 64 bit words of one run
+	// variableWord[variable * wordsPerRun + word]
+	static void calculateVariableWords(uint sourceValueBase, uint wordsPerRun, BitSlicedRegisterType* variableWord) noexcept;
+
+#ifdef WIDE_LANE_KERNEL_X86_64
+	// The vector extension specific implementations
+	void runAvx2(uint sourceValueBase, BitSlicedRegisterType* result) const;
+	void runAvx512(uint sourceValueBase, BitSlicedRegisterType* result) const;
+#endif
+};
+
+#endif
@@ -116,7 +116,7 @@ void VirtualMachineForAST::printTreeStandard(const std::string& source)
 // 
 // The output rows will be calculated in a different routine that sets all properties of an AST
 //
-void VirtualMachineForAST::printTree(std::ostream& os)
+void VirtualMachineForAST::printTree(std::ostream& os) const
 {
 	// We will print a tree with a width of maximum 1000 chararcters (columns)
 	constexpr uint maxBufSize{ 1000 };
@@ -128,7 +128,7 @@ void VirtualMachineForAST::printTree(std::ostream& os)
 	uint outputLastPosition{ 0 };
 
 	// Calculate all output strings. Go through all possible rows
-	for (row = 0; row < narrow_cast<uint>(ast.size()); ++row)
+	for (uint outputRow = 0; outputRow < narrow_cast<uint>(ast.size()); ++outputRow)
 	{
 		// Temporary buffer. Plain old array
 		cchar out[maxBufSize + 1];
@@ -141,7 +141,7 @@ void VirtualMachineForAST::printTree(std::ostream& os)
 		for (uint i = 0; i < narrow_cast<uint>(ast.size()); ++i)
 		{
 			// If the desired row (from the outer loop) matches with the calculated printRow of this node, then we need to do something
-			if (row == ast[i].printRow)
+			if (outputRow == nodeLayout[i].printRow)
 			{
 				// We will print temporaray data in a stingstream
 				std::ostringstream oss;
@@ -154,27 +154,27 @@ void VirtualMachineForAST::printTree(std::ostream& os)
 				{
 					// Name of Token (ID or IDNOT), input terminal/variable name, value, evaluated or not
 					oss << tokenToCharP(ast[i].tokenWithAttribute.token) << ' ' << ast[i].tokenWithAttribute.inputTerminalSymbol
-						<< " (" << ((ast[i].value) ? 1 : 0) << ((ast[i].notEvaluated) ? "x" : "") << ')';
+						<< " (" << (value(i) ? 1 : 0) << (notEvaluated(i) ? "x" : "") << ')';
 				}
 				// 1 child, unary operator NOT
 				if (NumberOfChildren::one == ast[i].numberOfChildren)
 				{
 					// Name of Token (NOT), reference line of child, value, evaluated or not
-					oss << tokenToCharP(ast[i].tokenWithAttribute.token) << ' ' << ast[ast[i].childLeftID].printRow
-						<< " (" << ((ast[i].value) ? 1 : 0) << ((ast[i].notEvaluated) ? "x" : "") << ')';
+					oss << tokenToCharP(ast[i].tokenWithAttribute.token) << ' ' << nodeLayout[ast[i].childLeftID].printRow
+						<< " (" << (value(i) ? 1 : 0) << (notEvaluated(i) ? "x" : "") << ')';
 				}
 				// 2 children, binary operator (OR, XOR, AND) 
 				if (NumberOfChildren::two == ast[i].numberOfChildren)
 				{
 					// Name of Token (NOT), reference line of child left, reference line of child right, value, evaluated or not
-					oss << tokenToCharP(ast[i].tokenWithAttribute.token) << ' ' << ast[ast[i].childLeftID].printRow << ',' << ast[ast[i].childRightID].printRow
-						<< " (" << ((ast[i].value) ? 1 : 0) << ((ast[i].notEvaluated) ? "x" : "") << ')';
+					oss << tokenToCharP(ast[i].tokenWithAttribute.token) << ' ' << nodeLayout[ast[i].childLeftID].printRow << ',' << nodeLayout[ast[i].childRightID].printRow
+						<< " (" << (value(i) ? 1 : 0) << (notEvaluated(i) ? "x" : "") << ')';
 				}
 				// Now convert the temporary stringstream to a temporaray std::string
 				const std::string strTemp{ oss.str() };
 				// Calculate the last column  of the output. Lokk for the greatest value in case that there will
 				// be 2 strings in the same line
-				const uint lastPosition{ (tab * ast[i].level) + narrow_cast<uint>(strTemp.size()) + 1 };
+				const uint lastPosition{ (tab * nodeLayout[i].level) + narrow_cast<uint>(strTemp.size()) + 1 };
 				// Prevent buffer overflow
 				if (lastPosition < maxBufSize)
 				{
@@ -185,14 +185,14 @@ void VirtualMachineForAST::printTree(std::ostream& os)
 						outputLastPosition = lastPosition;
 					}
 					// Copy the temporary string to the output buffer (that is full of spaces) to the calculated column . 
-					memcpy(&out[0] + (static_cast<ull>(tab) * static_cast<ull>(ast[i].level)), strTemp.c_str(), strTemp.size());
+					memcpy(&out[0] + (static_cast<ull>(tab) * static_cast<ull>(nodeLayout[i].level)), strTemp.c_str(), strTemp.size());
 				}
 			}
 		}
 		// terminate the output buffer with a C-String terminator  0
 		out[outputLastPosition] = 0;
 		// And put it to the screen and/or to a file
-		os << std::setw(6) << row << ' ' <<& out[0] << '\n';
+		os << std::setw(6) << outputRow << ' ' <<& out[0] << '\n';
 	}
 }
 
@@ -202,7 +202,9 @@ void VirtualMachineForAST::printTree(std::ostream& os)
 void VirtualMachineForAST::calculateAstProperties()
 {
 	const uint rootIndex{ ast.rbegin()->ownID };	// Start with root
+	nodeLayout.assign(ast.size(), AstNodeLayout());	// Print positions will be calculated for all nodes
 	calculateAstPropertiesRecursive(rootIndex);		// And traverse the tree
+	calculateEvaluationSequence();					// Flatten the tree for the evaluation
 }
 
 
@@ -220,7 +222,7 @@ void VirtualMachineForAST::calculateAstPropertiesRecursive(uint index)
 
 	// All ast nodes will get a level. The level is the deepness in the tree
 	// So th root is on level 0, the first children are on level 1, the grand children are on level 2 and so on 
-	ast[index].level = level;
+	nodeLayout[index].level = level;
 
 	// If this node is a leaf. Only a condition/variable/terminal can be a leaf
 	if (NumberOfChildren::zero == ast[index].numberOfChildren)
@@ -230,7 +232,7 @@ void VirtualMachineForAST::calculateAstPropertiesRecursive(uint index)
 		// And we store the name of the condition/variable/terminal
 		ast[index].tokenWithAttribute.inputSymbolLowerCase = narrow_cast<cchar>(std::tolower(ast[index].tokenWithAttribute.inputTerminalSymbol));
 		// Where to print. The leave is the master for determining row. Everything else is referenced to this row
-		ast[index].printRow = row;
+		nodeLayout[index].printRow = row;
 
 		// The next node will be 3 rows below
 		++row;
@@ -250,7 +252,7 @@ void VirtualMachineForAST::calculateAstPropertiesRecursive(uint index)
 		// And we are back from below, Reset level
 		--level;
 		// And this node will be printed one row below its child
-		ast[index].printRow = ast[ast[index].childLeftID].printRow + 1;
+		nodeLayout[index].printRow = nodeLayout[ast[index].childLeftID].printRow + 1;
 	}
 
 	// A node with 2 children, eg. Operation AND, XOR, OR
@@ -269,7 +271,7 @@ void VirtualMachineForAST::calculateAstPropertiesRecursive(uint index)
 		// And we are back from below, Reset level
 		--level;
 		// And we will print this node in the middle (and above) of our 2 children
-		ast[index].printRow = (ast[ast[index].childLeftID].printRow + ast[ast[index].childRightID].printRow) / 2;
+		nodeLayout[index].printRow = (nodeLayout[ast[index].childLeftID].printRow + nodeLayout[ast[index].childRightID].printRow) / 2;
 	} // else nothing
 }
 
@@ -278,157 +280,231 @@ void VirtualMachineForAST::calculateAstPropertiesRecursive(uint index)
 // It takes a source value and uses the operations encoded in nodes and leave values
 // and calculates a result.
 //
-// Depth First Traversal, Preorder (Root, Left, Right)
+// The nodes are evaluated in the sequence that has been calculated together with the AST properties
+// Children before parents. No recursion. The option for boolean short cut evaluation is read only once
 bool VirtualMachineForAST::evaluateTree(uint inputValue)
 {
 	sourceValue = inputValue;
-	const uint rootIndex{ ast.rbegin()->ownID };
-	evaluateTreeRecursive(rootIndex);
-	return ast[rootIndex].value;
+	if (programOption.option[ProgramOption::bse].optionSelected)
+	{
+		evaluateTreeIterative<true>();
+	}
+	else
+	{
+		evaluateTreeIterative<false>();
+	}
+	// The root is the last element in the sequence
+	return 0U != evaluationValue.back();
 }
 
-// Recursive FUnction for wvaluating the boolean value of a node
-// Depth First Traversal, Preorder (Root, Left, Right)
-void VirtualMachineForAST::evaluateTreeRecursive(uint index)
+
+// Reset everything
+void VirtualMachineForAST::clear() noexcept
 {
-	// Get a reference to the node and the number of children
-	AstNode& nodeAtIndex{ ast[index] };
-	const NumberOfChildren numberOfChildren{ nodeAtIndex.numberOfChildren };
+	ast.clear();
+	evaluationOperation.clear();
+	evaluationOperandLeft.clear();
+	evaluationOperandRight.clear();
+	evaluationRightSubtreeSize.clear();
+	evaluationValue.clear();
+	evaluationNotEvaluated.clear();
+	evaluationPosition.clear();
+	evaluationSequence.clear();
+	nodeLayout.clear();
+	row = 0;
+	level = 0U;
+	sourceValue = 0U;
+}
+
 
-	// If the node has no children, then it is a leave, so, a condition/variable/terminal
-	// And we just nee to read the value from the source input value
-	if (NumberOfChildren::zero == numberOfChildren)
+// Set the result for a node directly
+void VirtualMachineForAST::setNodeResult(uint nodeIndex, bool nodeValue, bool nodeNotEvaluated) noexcept
+{
+	const uint position{ evaluationPosition[nodeIndex] };
+	if (ASTNoLinkedElement != position)
 	{
-		switch (nodeAtIndex.tokenWithAttribute.token)
+		evaluationValue[position] = nodeValue ? 1U : 0U;
+		evaluationNotEvaluated[position] = nodeNotEvaluated ? 1U : 0U;
+	}
+}
+
+
+// Flatten the tree. Depth First Traversal, Postorder (Left, Right, Root). Done iteratively with an explicit stack
+// For each node we store the operation, the positions of the operands and the size of its right subtree.
+// In postorder, a subtree is a consecutive block that ends directly before its root. So, the right subtree
+// of a node at position p is [p - size, p - 1]
+void VirtualMachineForAST::calculateEvaluationSequence()
+{
+	evaluationOperation.clear();
+	evaluationOperandLeft.clear();
+	evaluationOperandRight.clear();
+	evaluationRightSubtreeSize.clear();
+	evaluationSequence.clear();
+	evaluationPosition.assign(ast.size(), ASTNoLinkedElement);
+	// Number of nodes in the subtree of a node. Including the node itself
+	std::vector<uint> subtreeSize(ast.size(), 1U);
+
+	// Stack of (node, children have been pushed)
+	std::vector<std::pair<uint, bool>> stack{ { ast.rbegin()->ownID, false } };
+	while (!stack.empty())
+	{
+		auto [index, childrenPushed] = stack.back();
+		stack.pop_back();
+		const AstNode& node{ ast[index] };
+		if (childrenPushed || (NumberOfChildren::zero == node.numberOfChildren))
 		{
-		// Can be the positive form
-		case Token::ID:
-			nodeAtIndex.value = (0U != (sourceValue & nodeAtIndex.tokenWithAttribute.sourceMask)); // Mask and copy source value
-			nodeAtIndex.notEvaluated = false;   // Used for boolean short cut evaluation. This value will be used
-			break;
-		// Or the negated form
-		case Token::IDNOT:
-			nodeAtIndex.value = (0U == (sourceValue & nodeAtIndex.tokenWithAttribute.sourceMask));// Mask and copy negated source value
-			nodeAtIndex.notEvaluated = false;	// Used for boolean short cut evaluation. This value will be used
-			break;
-		default:
-			// Should never happen. Error. Set value to false and
-			// boolean shortcut evaluation flag to true, meaning: don't use			nodeAtIndex.value = false;
-			nodeAtIndex.notEvaluated = true;
-			break;
-#pragma warning(suppress: 4061)
+			// All children are already in the sequence. Now the node itself
+			EvaluationOperation operation{ EvaluationOperation::Invalid };
+			uint operandLeft{ 0U };
+			uint operandRight{ 0U };
+			uint rightSubtreeSize{ 0U };
+			const Token token{ node.tokenWithAttribute.token };
+			switch (node.numberOfChildren)
+			{
+			case NumberOfChildren::zero:
+				// A condition. The operand is the mask for reading the source value
+				operandLeft = node.tokenWithAttribute.sourceMask;
+				if (Token::ID == token)
+				{
+					operation = EvaluationOperation::Condition;
+				}
+				else if (Token::IDNOT == token)
+				{
+					operation = EvaluationOperation::NegatedCondition;
+				}
+				break;
+			case NumberOfChildren::one:
+				operandLeft = evaluationPosition[node.childLeftID];
+				subtreeSize[index] += subtreeSize[node.childLeftID];
+				if ((Token::BCLOSE == token) || (Token::END == token))
+				{
+					operation = EvaluationOperation::Copy;
+				}
+				else if (Token::NOT == token)
+				{
+					operation = EvaluationOperation::Not;
+				}
+				break;
+			case NumberOfChildren::two:
+				operandLeft = evaluationPosition[node.childLeftID];
+				operandRight = evaluationPosition[node.childRightID];
+				rightSubtreeSize = subtreeSize[node.childRightID];
+				subtreeSize[index] += subtreeSize[node.childLeftID] + rightSubtreeSize;
+				if (Token::AND == token)
+				{
+					operation = EvaluationOperation::And;
+				}
+				else if (Token::OR == token)
+				{
+					operation = EvaluationOperation::Or;
+				}
+				else if (Token::XOR == token)
+				{
+					operation = EvaluationOperation::Xor;
+				}
+				break;
+			default:
+				break;
+			}
+			evaluationPosition[index] = narrow_cast<uint>(evaluationOperation.size());
+			evaluationSequence.push_back(index);
+			evaluationOperation.push_back(operation);
+			evaluationOperandLeft.push_back(operandLeft);
+			evaluationOperandRight.push_back(operandRight);
+			evaluationRightSubtreeSize.push_back(rightSubtreeSize);
+		}
+		else
+		{
+			// The node comes after its children. First left, then right
+			stack.emplace_back(index, true);
+			if (NumberOfChildren::two == node.numberOfChildren)
+			{
+				stack.emplace_back(node.childRightID, false);
+			}
+			stack.emplace_back(node.childLeftID, false);
 		}
 	}
-	// This node has one child, e.g. this node is a END or a NOT or a closing bracket
-	else if (NumberOfChildren::one == numberOfChildren)
+	// No evaluation done yet. All results are false
+	evaluationValue.assign(evaluationOperation.size(), 0U);
+	evaluationNotEvaluated.assign(evaluationOperation.size(), 0U);
+}
+
+
+// Evaluate all nodes in one loop. Children before parents. Only the compact tables are used
+// Then, for boolean short cut evaluation, a second loop sets the "not evaluated" flags. Parents before children
+template <bool WithShortCutEvaluation>
+void VirtualMachineForAST::evaluateTreeIterative()
+{
+	const uint sequenceSize{ narrow_cast<uint>(evaluationOperation.size()) };
+	for (uint position = 0U; position < sequenceSize; ++position)
 	{
-		evaluateTreeRecursive(nodeAtIndex.childLeftID);
-		nodeAtIndex.notEvaluated = false;	// Used for boolean short cut evaluation. This value will be used
-		switch (nodeAtIndex.tokenWithAttribute.token)
+		const uint operandLeft{ evaluationOperandLeft[position] };
+		const uint operandRight{ evaluationOperandRight[position] };
+		uchar result{ 0U };
+		uchar notEvaluatedResult{ 0U };		// Used for boolean short cut evaluation. This value will be used
+		switch (evaluationOperation[position])
 		{
-		case Token::BCLOSE:  //fallthrough
-		case Token::END:
-			// Simply copy the value. No operation necessary
-			nodeAtIndex.value = ast[nodeAtIndex.childLeftID].value;
+		// A condition/variable/terminal. We just nee to read the value from the source input value
+		case EvaluationOperation::Condition:
+			result = (0U != (sourceValue & operandLeft)) ? 1U : 0U;	// Mask and copy source value
 			break;
-		case Token::NOT:
-			nodeAtIndex.value = !ast[nodeAtIndex.childLeftID].value;
+		case EvaluationOperation::NegatedCondition:
+			result = (0U == (sourceValue & operandLeft)) ? 1U : 0U;	// Mask and copy negated source value
 			break;
-		default:
-			// Should never happen. Error. Set value to false and
-			// boolean shortcut evaluation flag to true, meaning: don't use			nodeAtIndex.value = false;
-			nodeAtIndex.notEvaluated = true;
+		// END or a closing bracket. Simply copy the value. No operation necessary
+		case EvaluationOperation::Copy:
+			result = evaluationValue[operandLeft];
+			break;
+		case EvaluationOperation::Not:
+			result = evaluationValue[operandLeft] ^ 1U;
 			break;
-#pragma warning(suppress: 4061)
-		}
-	}
-	// This node has 2 children. It is a boolean operation: AND, XOR, Or
-	else if (NumberOfChildren::two == numberOfChildren)
-	{
-		// Before we can do the calculation for this node, we need the result of our children
-		evaluateTreeRecursive(nodeAtIndex.childLeftID);
-		evaluateTreeRecursive(nodeAtIndex.childRightID);
-		nodeAtIndex.notEvaluated = false;	// Used for boolean short cut evaluation. This value will be used
-
 		// Perfrom the requested operation on the values of our children
-		switch (nodeAtIndex.tokenWithAttribute.token)
-		{
-		case Token::AND:
-			nodeAtIndex.value = ast[nodeAtIndex.childLeftID].value && ast[nodeAtIndex.childRightID].value;
+		case EvaluationOperation::And:
+			result = evaluationValue[operandLeft] & evaluationValue[operandRight];
 			break;
-		case Token::OR:
-			nodeAtIndex.value = ast[nodeAtIndex.childLeftID].value || ast[nodeAtIndex.childRightID].value;
+		case EvaluationOperation::Or:
+			result = evaluationValue[operandLeft] | evaluationValue[operandRight];
 			break;
-		case Token::XOR:
-			nodeAtIndex.value = ast[nodeAtIndex.childLeftID].value ^ ast[nodeAtIndex.childRightID].value;
+		case EvaluationOperation::Xor:
+			result = evaluationValue[operandLeft] ^ evaluationValue[operandRight];
 			break;
-
+		case EvaluationOperation::Invalid: //fallthrough
 		default:
 			// Should never happen. Error. Set value to false and
 			// boolean shortcut evaluation flag to true, meaning: don't use
-			nodeAtIndex.value = false;
-			nodeAtIndex.notEvaluated = true;
+			notEvaluatedResult = 1U;
 			break;
-#pragma warning(suppress: 4061)
 		}
-	} // else nothing
-
+		evaluationValue[position] = result;
+		evaluationNotEvaluated[position] = notEvaluatedResult;
+	}
 
 	// If boolean short cut evaluation is requested by program options
-	if (programOption.option[ProgramOption::bse].optionSelected)
+	if constexpr (WithShortCutEvaluation)
 	{
 		// Now we are checking for the boolean "Annihilation"
-		// This is needed for boolean short cut evaluation
 		// If the left side of the AND is FALSE, then no need to evaluate the right side
 		// If the left side of the OR is TRUE, then no need to evaluate the right side
-		bool isNotEvaluated{ false };
-		// Boolean short circuit evaluation
-		switch (nodeAtIndex.tokenWithAttribute.token)
+		// Then the whole right subtree is "not evaluated" or "masked"
+		// We go backwards through the sequence. So parents before children. A masked subtree is a consecutive block
+		// in the sequence. A masked subtree within a masked subtree is part of the outer block. So we need to
+		// remember only, where the current block ends. All positions from there up to here are masked
+		uint maskedFromPosition{ UINT_MAX };
+		for (uint position = sequenceSize; position > 0U; )
 		{
-		case Token::AND:
-			if (!ast[nodeAtIndex.childLeftID].value)
+			--position;
+			if (position >= maskedFromPosition)
 			{
-				// Right side of tree is notEvaluated
-				isNotEvaluated = true;
+				evaluationNotEvaluated[position] = 1U;
 			}
-			break;
-		case Token::OR:
-			if (ast[nodeAtIndex.childLeftID].value)
+			// Boolean short circuit evaluation
+			const EvaluationOperation operation{ evaluationOperation[position] };
+			if (((EvaluationOperation::And == operation) && (0U == evaluationValue[evaluationOperandLeft[position]])) ||
+				((EvaluationOperation::Or == operation) && (0U != evaluationValue[evaluationOperandLeft[position]])))
 			{
 				// Right side of tree is notEvaluated
-				isNotEvaluated = true;
+				maskedFromPosition = std::min(maskedFromPosition, position - evaluationRightSubtreeSize[position]);
 			}
-			break;
-		default:
-			break;
-#pragma warning(suppress: 4061)
-		}
-		// If there is a short cut, either for and or for or
-		if (isNotEvaluated)
-		{
-			// Set the whole right subtree to "not evealuated" or "masked"
-			setSubTreetoMasked(nodeAtIndex.childRightID);
 		}
 	}
 }
-
-// Traverse subtree in preorder and set all flags for boolean short cut evaluation
-// to "do not evaluate" or "masked" or "deactivated" or whatever you wanna call it
-void VirtualMachineForAST::setSubTreetoMasked(uint index)
-{
-	// Set flage
-	ast[index].notEvaluated = true;
-
-	// Traverse the tree
-	if (NumberOfChildren::zero == ast[index].numberOfChildren) {}
-	else if (NumberOfChildren ::one == ast[index].numberOfChildren)
-	{
-		setSubTreetoMasked(ast[index].childLeftID);
-	}
-	else if (NumberOfChildren::two == ast[index].numberOfChildren)
-	{
-		setSubTreetoMasked(ast[index].childLeftID);
-		setSubTreetoMasked(ast[index].childRightID);
-	}
-}
-
@@ -176,6 +176,22 @@
 // -pmcsfautoa				Automatically write big data for all MC/DC coverage sets to file with automatic created filename, write small data to console. Default
 
 
+// ---------------------------------------------------------------
+// 4. Performance options
+
+// -jit						Translate the boolean expression to native x86-64 machine code for the minterm calculation. Falls back to the interpreter, if not possible
+// -gcs						Calculate the minterms with a Gray code sweep. Only instructions depending on the changed variable will be executed again
+// -nocopt					Do not optimize the object code for the virtual machine (common sub expressions, simplification, constant folding)
+// -threads "n"				Number of worker threads for all parallel calculations. Default is the number of hardware threads
+// -grain "n"				Number of truth table words (64 input values each) per task of the minterm calculation. Default is calculated by a cost model
+// -tl "s"					Time limit in seconds for the whole run. When reached, all searches stop and the best partial results are shown, marked as partial
+// -mp "n"					Stop the search for MC/DC test pairs after n test pairs have been found. The test pairs and test sets are marked as partial
+// -ucf						Unique cause fast mode. Search MC/DC test pairs only among test values that differ in exactly one condition
+// -quota "n"				Per condition quota. Stop the search for a condition after n unique cause test pairs have been found. Other test pairs are kept up to n per type and stop the search, if all conditions have reached their quota
+// -sample "n"				Sampled search for MC/DC test pairs. Check n random test pairs instead of all. For decisions with many conditions. Without -umdnf, there is no truth table and no minimum DNF and up to 26 conditions are possible
+// -seed "n"				Seed for the random numbers of the sampled search. Same seed, same result. Default is 1
+
+
 // Any 3.7 option switches on the respective 3.8 options
 
 //
@@ -192,6 +208,8 @@
 
 #include "cloption.hpp"
 #include <cctype>
+#include <charconv>
+#include <climits>
 #include <filesystem>
 
 
@@ -281,7 +299,7 @@ namespace OutputHandling
 		{
 			fileOut1.open(filename, (appendMode ? IosModeAppend : IosModeOverwrite));
 		}
-		teeStreamBuffer.setStreamBuffer(std::cout.rdbuf(), fileOut1.rdbuf());
+		teeStreamBuffer.setStreamBuffer(console().rdbuf(), fileOut1.rdbuf());
 	}
 	
 	// Cout + 2 files. Filename as std::string
@@ -295,7 +313,7 @@ namespace OutputHandling
 		{
 			fileOut2.open(filename2, (appendMode2 ? IosModeAppend : IosModeOverwrite));
 		}
-		teeStreamBuffer.setStreamBuffer(std::cout.rdbuf(), fileOut1.rdbuf(), fileOut2.rdbuf());
+		teeStreamBuffer.setStreamBuffer(console().rdbuf(), fileOut1.rdbuf(), fileOut2.rdbuf());
 	}
 
 	// Cout + One file. Filename as const char *
@@ -305,7 +323,7 @@ namespace OutputHandling
 		{
 			fileOut1.open(filename, (appendMode ? IosModeAppend : IosModeOverwrite));
 		}
-		teeStreamBuffer.setStreamBuffer(std::cout.rdbuf(), fileOut1.rdbuf());
+		teeStreamBuffer.setStreamBuffer(console().rdbuf(), fileOut1.rdbuf());
 	}
 
 	// Cout + 2 files. Filename as const char *
@@ -319,7 +337,7 @@ namespace OutputHandling
 		{
 			fileOut2.open(filename2, (appendMode2 ? IosModeAppend : IosModeOverwrite));
 		}
-		teeStreamBuffer.setStreamBuffer(std::cout.rdbuf(), fileOut1.rdbuf(), fileOut2.rdbuf());
+		teeStreamBuffer.setStreamBuffer(console().rdbuf(), fileOut1.rdbuf(), fileOut2.rdbuf());
 	}
 	
 	// 2 files. Filename as std::string
@@ -350,6 +368,85 @@ namespace OutputHandling
 		teeStreamBuffer.setStreamBuffer(fileOut1.rdbuf(), fileOut2.rdbuf());
 	}
 
+
+
+	// Console of a stage. A single character shall be written
+	// Buffer it, if the stage is not yet active, else send it to std::cout
+	sint StageConsoleStream::StageConsoleBuffer::overflow(int_type c)
+	{
+		// Short cut name
+		using traits = std::streambuf::traits_type;
+		// Function return code. True means success
+		bool rc{ true };
+
+		// If character to output is not EOF
+		if (!traits::eq_int_type(traits::eof(), c))
+		{
+			std::lock_guard<std::mutex> lock(bufferMutex);
+			if (active)
+			{
+				rc = !traits::eq_int_type(narrow_cast<int_type>(std::cout.rdbuf()->sputc(narrow_cast<char_type>(c))), traits::eof());
+			}
+			else
+			{
+				pendingOutput.push_back(narrow_cast<char_type>(c));
+			}
+		}
+		// Depending on outcoume of above functions, return NOT EOF (OK) or EOF (Error or done)
+		return rc ? traits::not_eof(c) : traits::eof();
+	}
+
+	// Console of a stage. Many characters shall be written at once
+	std::streamsize StageConsoleStream::StageConsoleBuffer::xsputn(const cchar* s, std::streamsize n)
+	{
+		std::lock_guard<std::mutex> lock(bufferMutex);
+		std::streamsize numberOfWrittenCharacters{ n };
+		if (active)
+		{
+			numberOfWrittenCharacters = std::cout.rdbuf()->sputn(s, n);
+		}
+		else
+		{
+			pendingOutput.append(s, static_cast<std::size_t>(n));
+		}
+		return numberOfWrittenCharacters;
+	}
+
+	// Sync makes only sense for an active stage. Buffered data stay in the buffer
+	sint StageConsoleStream::StageConsoleBuffer::sync()
+	{
+		std::lock_guard<std::mutex> lock(bufferMutex);
+		return (active) ? std::cout.rdbuf()->pubsync() : 0;
+	}
+
+	// All previous stages are finished. Now this stage may write to std::cout
+	// First the data collected so far and then everything else directly
+	void StageConsoleStream::StageConsoleBuffer::activate()
+	{
+		std::lock_guard<std::mutex> lock(bufferMutex);
+		if (!active)
+		{
+			std::cout.rdbuf()->sputn(pendingOutput.data(), static_cast<std::streamsize>(pendingOutput.size()));
+			// Release the memory
+			std::string().swap(pendingOutput);
+			active = true;
+		}
+	}
+
+
+	// Each thread may have its own console. Threads running a stage of the program set their stage console
+	// All other threads write to std::cout
+	static thread_local std::ostream* currentConsole{ nullptr };
+
+	std::ostream& console() noexcept
+	{
+		return (null<std::ostream*>() == currentConsole) ? std::cout : *currentConsole;
+	}
+
+	void setConsole(std::ostream* stageConsole) noexcept
+	{
+		currentConsole = stageConsole;
+	}
 }
 
 
@@ -463,7 +560,7 @@ OutStreamSelection::OutStreamSelection(uint optionFirstIndexInGroupU, const bool
 		break;
 
 	case OutputDestinationCOut:	// Only cout selected
-		selectedOstream =& std::cout;
+		selectedOstream =& OutputHandling::console();
 		break;
 
 	case OutputDestinationFile:	// 1 File Only seelcted
@@ -604,6 +701,19 @@ void ProgramOption::setDefaultOptions()
 	option.emplace_back(CommandLineOption(58, "-pmcsfauto", "", true));
 	option.emplace_back(CommandLineOption(59, "-pmcsfautoa", "testcoveragesets.txt", false));
 
+	// 4. Performance options
+	option.emplace_back(CommandLineOption(60, "-jit", "", false));
+	option.emplace_back(CommandLineOption(61, "-gcs", "", false));
+	option.emplace_back(CommandLineOption(62, "-nocopt", "", false));
+	option.emplace_back(CommandLineOption(63, "-threads", "", true));
+	option.emplace_back(CommandLineOption(64, "-grain", "", true));
+	option.emplace_back(CommandLineOption(65, "-tl", "", true));
+	option.emplace_back(CommandLineOption(66, "-mp", "", true));
+	option.emplace_back(CommandLineOption(67, "-ucf", "", false));
+	option.emplace_back(CommandLineOption(68, "-quota", "", true));
+	option.emplace_back(CommandLineOption(69, "-sample", "", true));
+	option.emplace_back(CommandLineOption(70, "-seed", "", true));
+
 }
 
 
@@ -843,10 +953,10 @@ void ProgramOption::evaluateCommandLine()
 
 	uint indexBeginOutputOptions{ 0ULL };
 	// Go through all possible defined options
-	while (indexBeginOutputOptions < pmcsfautoa)
+	while (indexBeginOutputOptions < option.size())
 	{
-		// All options are organized in groups of 5 elements
-		for (uint i = 0; i < 5ULL; ++i)
+		// All options are organized in groups of 5 elements. The last group may be smaller
+		for (uint i = 0; (i < 5ULL) && ((indexBeginOutputOptions + i) < option.size()); ++i)
 		{
 			// First Check, if a option is present and if so, copy data
 			optionIdString = option[indexBeginOutputOptions + i].optionIdentificationString;
@@ -866,6 +976,8 @@ void ProgramOption::evaluateCommandLine()
 		indexBeginOutputOptions += 5;
 	}
 
+	// Numbers like time limits or number of threads must be valid. Otherwise the option is ignored
+	checkNumericParameters();
 
 
 
@@ -1055,6 +1167,67 @@ void ProgramOption::evaluateCommandLine()
 }
 
 
+// Get the names of all files, that may be written by the given groups of output options
+// This must be called after evaluateCommandLine, because the priorities and the filenames are set there
+std::set<std::string> ProgramOption::getSelectedOutputFileNames(const std::vector<uint>& optionFirstIndexInGroups) const
+{
+	std::set<std::string> outputFileNames;
+	for (const uint optionFirstIndexInGroup : optionFirstIndexInGroups)
+	{
+		// Start with 1 . So do not check output to std::cout
+		for (uint i = 1; i < 5; ++i)
+		{
+			if (option[optionFirstIndexInGroup + i].optionSelected && !option[optionFirstIndexInGroup + i].optionParameterString.empty())
+			{
+				outputFileNames.insert(option[optionFirstIndexInGroup + i].optionParameterString);
+			}
+		}
+	}
+	return outputFileNames;
+}
+
+
+// Get the numeric parameter of an option. The parameter has been checked in evaluateCommandLine
+uint64 ProgramOption::getNumericParameter(uint optionIndex) const
+{
+	uint64 value{ 0ULL };
+	if (option[optionIndex].optionSelected)
+	{
+		const std::string& parameter{ option[optionIndex].optionParameterString };
+		std::from_chars(parameter.data(), parameter.data() + parameter.size(), value);
+	}
+	return value;
+}
+
+
+// Options with a numeric parameter accept only decimal numbers. Invalid values are reported and the option is ignored
+// All numbers must be positive and fit into an uint. Only the seed for the random numbers may be any 64 bit number
+void ProgramOption::checkNumericParameters()
+{
+	for (const uint optionIndex : { threads, grain, tl, mp, quota, sample, seed })
+	{
+		if (option[optionIndex].optionSelected)
+		{
+			const std::string& parameter{ option[optionIndex].optionParameterString };
+			uint64 value{ 0ULL };
+			const std::from_chars_result result{ std::from_chars(parameter.data(), parameter.data() + parameter.size(), value) };
+
+			// The whole parameter must be a number. Leading signs or trailing characters are not allowed
+			bool isValid{ (std::errc() == result.ec) && ((parameter.data() + parameter.size()) == result.ptr) };
+			if (isValid && (seed != optionIndex))
+			{
+				isValid = (value > 0ULL) && (value <= UINT_MAX);
+			}
+			if (!isValid)
+			{
+				std::cerr << "Error: Option '" << option[optionIndex].optionIdentificationString << ((seed == optionIndex) ? "' needs a number" : "' needs a positive number") << ". Found:  '" << parameter << "'    Ignoring this option\n";
+				option[optionIndex].optionSelected = false;
+			}
+		}
+	}
+}
+
+
 // In one group there may be several flags set. This functions sets the flags in a logical manner
 void ProgramOption::checkPrioritiesWithinGroups(uint index)
 {
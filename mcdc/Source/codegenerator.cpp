@@ -155,6 +155,37 @@ void CodeGeneratorForVM::setRegisterToAvailable(uint index)
 }
 
 
+// For the boolean short cut evaluation. Insert a conditional jump between the code of the left and the right hand operand
+// The code of the left hand operand has already been generated and also the code of the right hand operand.
+// Because the parser reduces the right hand operand, before it sees the operation.
+// So the jump must be inserted in front of the code of the right hand operand.
+void CodeGeneratorForVM::insertConditionalJump(Token operation, uint leftOperandRegister, uint rightOperandCodeStartIndex, uint destinationRegister)
+{
+	OpCodeLine opCodeLine;
+	// AND: If the left hand operand is false, the result is false. OR: If the left hand operand is true, the result is true
+	opCodeLine.token = (Token::AND == operation) ? Token::JUMPFALSE : Token::JUMPTRUE;
+	// The condition will be checked with this register
+	opCodeLine.parameter1 = leftOperandRegister;
+	// Jump target: Behind the operation. The operation will be added after the jump and after the right hand operand
+	opCodeLine.parameter2 = narrow_cast<uint>(objectCode.opCode.size()) + 2U;
+	// The value of the left hand operand will be copied to this register, if the jump is taken
+	opCodeLine.parameter3 = destinationRegister;
+
+	// All jumps in the right hand operand, that go to a position behind the insertion point, must be corrected
+	// Jumps in the left hand operand may go exactly to the insertion point. Then they will reach the new jump. That is OK
+	for (uint i = rightOperandCodeStartIndex; i < objectCode.opCode.size(); ++i)
+	{
+		OpCodeLine& ocl{ objectCode.opCode[i] };
+		if (((Token::JUMPFALSE == ocl.token) || (Token::JUMPTRUE == ocl.token)) && (ocl.parameter2 > rightOperandCodeStartIndex))
+		{
+			++ocl.parameter2;
+		}
+	}
+	// And insert the jump in front of the right hand operand
+	objectCode.opCode.insert(objectCode.opCode.begin() + static_cast<std::ptrdiff_t>(rightOperandCodeStartIndex), opCodeLine);
+}
+
+
 
 // This are the actual code generation routines.
 //
@@ -200,6 +231,8 @@ TokenWithAttribute CodeGeneratorForVM::generate(const Production &production, To
 		result.token = Token::EXPR;
 		// Number of destination register
 		result.sourceIndex = opCodeLine.parameter2;
+		// The code for this expression starts with the load operation
+		result.codeStartIndex = narrow_cast<uint>(objectCode.opCode.size());
 	}
 	// Add the new opcode to the object code.
 	objectCode.add(std::move(opCodeLine));
@@ -230,6 +263,7 @@ TokenWithAttribute CodeGeneratorForVM::generate(const Production &production, To
 		// The result is always the non-terminal EXPR   (expression)
 		result.token = Token::EXPR;
 		result.sourceIndex = opCodeLine.parameter2;
+		result.codeStartIndex = tokenWithAttribute1.codeStartIndex;
 	}
 	// AND in concatenated form
 	else if (Token::AND == token)
@@ -244,10 +278,16 @@ TokenWithAttribute CodeGeneratorForVM::generate(const Production &production, To
 		// Both source registers no longer needed
 		setRegisterToAvailable(tokenWithAttribute1.sourceIndex);
 		setRegisterToAvailable(tokenWithAttribute2.sourceIndex);
+		// Left hand operand is the 2nd token. Skip the right hand operand, if the left hand operand is false
+		if (generateShortCircuitCode)
+		{
+			insertConditionalJump(token, tokenWithAttribute2.sourceIndex, tokenWithAttribute1.codeStartIndex, opCodeLine.parameter3);
+		}
 
 		// The result is always the non-terminal EXPR   (expression)
 		result.token = Token::EXPR;
 		result.sourceIndex = opCodeLine.parameter3;
+		result.codeStartIndex = tokenWithAttribute2.codeStartIndex;
 	}
 	else if (Token::END == token)
 	{
@@ -282,6 +322,7 @@ TokenWithAttribute CodeGeneratorForVM::generate(const Production &production, To
 		// Just copy the data
 		result.token = Token::EXPR;
 		result.sourceIndex = tokenWithAttribute2.sourceIndex;
+		result.codeStartIndex = tokenWithAttribute2.codeStartIndex;
 	}
 	// Same handling for OR XOR AND 
 	else if ((Token::OR == token) || (Token::AND == token) || (Token::XOR == token))
@@ -297,9 +338,15 @@ TokenWithAttribute CodeGeneratorForVM::generate(const Production &production, To
 		// Registers, which were holding the source values, are no longer needed and can be reused
 		setRegisterToAvailable(tokenWithAttribute3.sourceIndex);
 		setRegisterToAvailable(tokenWithAttribute1.sourceIndex);
+		// For AND and OR the right hand operand may be skipped. XOR needs always both operands
+		if (generateShortCircuitCode && (Token::XOR != token))
+		{
+			insertConditionalJump(token, tokenWithAttribute3.sourceIndex, tokenWithAttribute1.codeStartIndex, opCodeLine.parameter3);
+		}
 		// The result will be an exppression
 		result.token = Token::EXPR;
 		result.sourceIndex = opCodeLine.parameter3;
+		result.codeStartIndex = tokenWithAttribute3.codeStartIndex;
 		// Add this new opcode to the object code
 		objectCode.add(std::move(opCodeLine));
 	}
@@ -0,0 +1,77 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+
+
+
+
+//
+// Compile time evaluation of boolean expressions
+//
+// See header file for further explanations
+//
+// Everything in the header is constexpr and templated. So the compiler checks it only, if it is used.
+// This translation unit uses it with some known boolean expressions. The results are checked with static_assert
+// at build time. If the compile time evaluator does not compile or gives wrong results, then the build fails
+//
+
+#include "compiletimeevaluator.hpp"
+
+
+
+namespace
+{
+	// The example from the header file. Variables a, b, c. The alphabetically first variable is the most significant bit
+	// So the minterms are 1, 3, 5, 7 (c is true) and 6, 7 (a and b are true)
+	constexpr auto decision{ compileBooleanExpression("ab+c") };
+	static_assert(decision.isValid(), "Syntax error");
+	static_assert(3U == decision.getNumberOfBooleanVariables(), "Wrong number of boolean variables");
+
+	// Evaluate for single input values
+	static_assert(!decision(0U) && decision(1U) && !decision(2U) && decision(3U), "Wrong result of the evaluation");
+	static_assert(!decision(4U) && decision(5U) && decision(6U) && decision(7U), "Wrong result of the evaluation");
+
+	// The complete truth table
+	constexpr auto truthTable{ decision.truthTable() };
+	static_assert(8U == truthTable.numberOfInputValues(), "Wrong size of the truth table");
+	static_assert(5U == truthTable.numberOfMinterms(), "Wrong number of minterms");
+	static_assert(!truthTable[0U] && truthTable[1U] && !truthTable[4U] && truthTable[6U], "Wrong truth table");
+
+	// Brackets, negation and xor. Same precedence rules as in the runtime compiler
+	constexpr auto decisionWithBrackets{ compileBooleanExpression("!(a+b)^c") };
+	static_assert(decisionWithBrackets.isValid(), "Syntax error");
+	static_assert(decisionWithBrackets(0U) && !decisionWithBrackets(1U) && !decisionWithBrackets(2U) && decisionWithBrackets(3U), "Wrong result of the evaluation");
+
+	// A syntax error must be detected
+	static_assert(!compileBooleanExpression("ab+").isValid(), "Syntax error not detected");
+}
@@ -182,6 +182,8 @@
 
 #include "coverage.hpp"
 #include "petrick.hpp"
+#include "threadpool.hpp"
+#include "runbudget.hpp"
 
 #include <algorithm>
 #include <iostream>
@@ -370,6 +372,11 @@ void Coverage::findDominatingVector(TableVector &firstDimension, TableVector &se
 	// Go through all rows/columns
 	for (Index outer = 0; outer < firstDimension.size(); ++outer)
 	{
+		// This is the slowest part of the reduction. If the time is over, then drop nothing
+		if (runBudget.isExhausted())
+		{
+			return;
+		}
 		// if not already dropped. Otherweise skip
 		if (!firstDimension[outer].dropped)
 		{
@@ -424,6 +431,63 @@ void Coverage::dropColumnAndAllRowsInColumn(Index column)
 	dropColumn(column);
 }
 
+// Greedy heuristic for the set cover problem. Used, if there is no time left for Petricks method
+// Take always the column, that covers most of the not yet covered rows. The first one wins for equal numbers
+ProductTermVector Coverage::findGreedyCover()
+{
+	ProductTerm greedyCover;
+	// All rows, that are still in the table, need to be covered
+	std::set<Index> uncoveredRow;
+	for (Index indexRow = 0; indexRow < tableRows.size(); ++indexRow)
+	{
+		if (!tableRows[indexRow].dropped)
+		{
+			uncoveredRow.insert(indexRow);
+		}
+	}
+
+	while (!uncoveredRow.empty())
+	{
+		// Find the best column
+		Index bestColumn{ 0 };
+		uint maxNumberOfCoveredRows{ 0 };
+		for (Index indexColumn = 0; indexColumn < tableColumns.size(); ++indexColumn)
+		{
+			if (!tableColumns[indexColumn].dropped)
+			{
+				uint numberOfCoveredRows{ 0 };
+				for (const TableCell& tc : tableColumns[indexColumn].cell)
+				{
+					if (!tc.dropped && (uncoveredRow.count(tc.crossReference) > 0))
+					{
+						++numberOfCoveredRows;
+					}
+				}
+				if (numberOfCoveredRows > maxNumberOfCoveredRows)
+				{
+					maxNumberOfCoveredRows = numberOfCoveredRows;
+					bestColumn = indexColumn;
+				}
+			}
+		}
+		// Sanity check. If no column covers the remaining rows, then we cannot do anything
+		if (null<uint>() == maxNumberOfCoveredRows)
+		{
+			break;
+		}
+		// Take the column and remove the covered rows
+		greedyCover.insert(bestColumn);
+		for (const TableCell& tc : tableColumns[bestColumn].cell)
+		{
+			if (!tc.dropped)
+			{
+				uncoveredRow.erase(tc.crossReference);
+			}
+		}
+	}
+	return ProductTermVector{ greedyCover };
+}
+
 // Simple function, to check, if there are still dropped rows and columns in the table
 ulong Coverage::countNotDroppedTableElements() noexcept
 {
@@ -686,12 +750,12 @@ CoverageResult Coverage::reduce(std::ostream& os)
 		// Could we reduce somethin?
 		newNumberOfNoneDroppedCells = countNotDroppedTableElements();
 
-	} while ((null<ulong>() != newNumberOfNoneDroppedCells) && (newNumberOfNoneDroppedCells != oldNumberOfNoneDroppedCells));
+	} while ((null<ulong>() != newNumberOfNoneDroppedCells) && (newNumberOfNoneDroppedCells != oldNumberOfNoneDroppedCells) && !runBudget.isExhausted());
 
 
 	// All conventional reduction operation performed
 	// Now use Petricks methos in case of a cyclic core left
-	if (null<ulong>() != newNumberOfNoneDroppedCells)
+	if ((null<ulong>() != newNumberOfNoneDroppedCells) && !runBudget.isExhausted())
 	{
 		os << "\n\n------------------ Could not reduce Tables further.   Cyclic Core Left\n";
 		printTable(os);
@@ -728,6 +792,17 @@ CoverageResult Coverage::reduce(std::ostream& os)
 
 	}
 
+	// If the time is over, then the reduction or Petricks method may have been stopped
+	// Petricks method will only return an empty result in that case
+	if ((null<ulong>() != countNotDroppedTableElements()) && coverageSet.empty() && runBudget.isExhausted())
+	{
+		os << "\n\n------------------ Time limit reached. Table could not be reduced completely\n";
+		printTable(os);
+		os << "------------------ Using greedy heuristic to Calculate a Coverage Set. The result may not be minimal\n";
+		coverageSet = findGreedyCover();
+		partialResult = true;
+	}
+
 	// Compile Coverage Result
 	coverageResult.clear();
 
@@ -823,18 +898,34 @@ CoverageResult Coverage::reduce(std::ostream& os)
 // cell will be marked as having a cover
 void Coverage::checkAllCellsForCover()
 {
-	// Iterate over all rows
-	for (uint row = 0; row < tableRows.size(); ++row)
-	{
-		// Iterate over all columns in this row
-		for (uint column = 0; column < tableColumns.size(); ++column)
+	// The checks are independent from each other. So they can be done by the thread pool. But setting
+	// a cell modifies the table. So first, for each row, collect the columns with a cover
+	std::vector<std::vector<Index>> coveringColumns(tableRows.size());
+
+	threadPool.parallelFor(0U, narrow_cast<uint>(tableRows.size()), 64U, [this, &coveringColumns](uint begin, uint end)
 		{
-			// Call callback function, and check, if this cell chould be marked as a cover
-			if (checkForCover(tableRows[row].cellVectorHeader, tableColumns[column].cellVectorHeader))
+			// Iterate over the given rows
+			for (uint row = begin; row < end; ++row)
 			{
-				// Mark cell
-				setCellAsCover(row, column);
+				// Iterate over all columns in this row
+				for (uint column = 0; column < tableColumns.size(); ++column)
+				{
+					// Call callback function, and check, if this cell chould be marked as a cover
+					if (checkForCover(tableRows[row].cellVectorHeader, tableColumns[column].cellVectorHeader))
+					{
+						coveringColumns[row].push_back(column);
+					}
+				}
 			}
+		});
+
+	// Now mark the cells. In the same sequence as before
+	for (uint row = 0; row < coveringColumns.size(); ++row)
+	{
+		for (const Index column : coveringColumns[row])
+		{
+			// Mark cell
+			setCellAsCover(row, column);
 		}
 	}
 }
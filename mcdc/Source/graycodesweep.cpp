@@ -0,0 +1,238 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+//
+// Gray code sweep for the calculation of a complete truth table
+//
+// Blocks of 64 input values are visited in Gray code order. Only one of the variables above bit 5 changes from
+// one block to the next. Then only the fan-out cone of this variable is executed again.
+// See header file for further explanations
+//
+
+
+#include "graycodesweep.hpp"
+
+#include <algorithm>
+
+
+// Translate the object code into a program, where each instruction has its own value slot
+// And find the fan-out cone for each variable
+void GrayCodeSweepForBooleanExpressions::load(ObjectCode& objectCode)
+{
+	program.clear();
+	for (FanOutCone& foc : fanOutCone)
+	{
+		foc.clear();
+	}
+	resultIndex = 0U;
+
+	// Before starting, compact the symbol table to get the normalized input
+	objectCode.symbolTable.compact();
+
+	// The code generator reuses registers. So we need to know, which instruction did write the register last
+	std::vector<uint16_t> lastWriter;
+	// For each instruction: the set of variables, that it depends on, as bit mask
+	std::vector<uint32> dependsOnVariable;
+
+	// Convenience function. Get the instruction that did write the register last
+	auto getWriter = [&lastWriter](uint machineRegister) -> uint16_t { return (machineRegister < lastWriter.size()) ? lastWriter[machineRegister] : 0U; };
+	// Convenience function. Remember that the current instruction writes this register
+	auto setWriter = [&lastWriter, this](uint machineRegister) { if (machineRegister >= lastWriter.size()) { lastWriter.resize(machineRegister + 1U, 0U); } lastWriter[machineRegister] = narrow_cast<uint16_t>(program.size()); };
+
+	for (const OpCodeLine& opCodeLine : objectCode.opCode)
+	{
+		SweepInstruction sweepInstruction;
+		uint32 dependencies{ 0U };
+		uint destinationRegister{ 0U };
+		bool isInstruction{ true };
+		switch (opCodeLine.token)
+		{
+		case Token::ID:
+		case Token::IDNOT:
+			// Load a variable. The instruction depends only on this variable
+			sweepInstruction.operation = (Token::ID == opCodeLine.token) ? ByteCode::LoadID : ByteCode::LoadNotID;
+			sweepInstruction.operand1 = narrow_cast<uint16_t>(objectCode.symbolTable.normalizedInput[opCodeLine.parameter1]);
+			dependencies = bitMask[sweepInstruction.operand1];
+			destinationRegister = opCodeLine.parameter2;
+			break;
+		case Token::OR:
+		case Token::XOR:
+		case Token::AND:
+			// Binary operation. Depends on everything that the operands depend on
+			sweepInstruction.operation = (Token::OR == opCodeLine.token) ? ByteCode::Or : ((Token::XOR == opCodeLine.token) ? ByteCode::Xor : ByteCode::And);
+			sweepInstruction.operand1 = getWriter(opCodeLine.parameter1);
+			sweepInstruction.operand2 = getWriter(opCodeLine.parameter2);
+			dependencies = dependsOnVariable[sweepInstruction.operand1] | dependsOnVariable[sweepInstruction.operand2];
+			destinationRegister = opCodeLine.parameter3;
+			break;
+		case Token::NOT:
+			sweepInstruction.operation = ByteCode::Not;
+			sweepInstruction.operand1 = getWriter(opCodeLine.parameter1);
+			dependencies = dependsOnVariable[sweepInstruction.operand1];
+			destinationRegister = opCodeLine.parameter2;
+			break;
+		case Token::END:
+			// No instruction. Just remember where the result is
+			resultIndex = getWriter(opCodeLine.parameter1);
+			isInstruction = false;
+			break;
+		default:
+			isInstruction = false;
+			break;
+		}
+		if (isInstruction)
+		{
+			// Add the instruction to all fan-out cones of the variables, that it depends on
+			for (uint variable = 0U; variable < fanOutCone.size(); ++variable)
+			{
+				if (null<uint32>() != (dependencies&  bitMask[variable]))
+				{
+					fanOutCone[variable].push_back(narrow_cast<uint16_t>(program.size()));
+				}
+			}
+			setWriter(destinationRegister);
+			dependsOnVariable.push_back(dependencies);
+			program.push_back(sweepInstruction);
+		}
+	}
+}
+
+
+// Execute one instruction in bit sliced mode
+void GrayCodeSweepForBooleanExpressions::execute(uint instructionIndex, uint sourceValueBase, std::vector<BitSlicedRegisterType>& value) const noexcept
+{
+	const SweepInstruction& sweepInstruction{ program[instructionIndex] };
+	BitSlicedRegisterType result{ null<BitSlicedRegisterType>() };
+	switch (sweepInstruction.operation)
+	{
+	case ByteCode::LoadID:
+	case ByteCode::LoadNotID:
+		// The lowest 6 variables have a fixed lane pattern. All others are broadcasted from the source value
+		if (sweepInstruction.operand1 < bitSlicedLanePattern.size())
+		{
+			result = bitSlicedLanePattern[sweepInstruction.operand1];
+		}
+		else
+		{
+			result = (null<uint32>() == (sourceValueBase&  bitMask[sweepInstruction.operand1])) ? null<BitSlicedRegisterType>() : ~null<BitSlicedRegisterType>();
+		}
+		if (ByteCode::LoadNotID == sweepInstruction.operation)
+		{
+			result = ~result;
+		}
+		break;
+	case ByteCode::Or:
+		result = value[sweepInstruction.operand1] | value[sweepInstruction.operand2];
+		break;
+	case ByteCode::Xor:
+		result = value[sweepInstruction.operand1] ^ value[sweepInstruction.operand2];
+		break;
+	case ByteCode::And:
+		result = value[sweepInstruction.operand1]&  value[sweepInstruction.operand2];
+		break;
+	case ByteCode::Not:
+		result = ~value[sweepInstruction.operand1];
+		break;
+	case ByteCode::End:
+		break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+	}
+	value[instructionIndex] = result;
+}
+
+
+// Calculate the truth table for a range of input values
+//
+// A Gray code can only be used for a range of blocks, where the number of blocks is a power of 2 and
+// the first block is aligned to this power of 2. So the range is split into such parts. Normally the
+// ranges are already aligned and there will be only one part.
+// For each part, the first block is calculated completely. Then the blocks are visited in Gray code order.
+// Going from Gray code g(j-1) to g(j) changes the bit with the number of trailing zeros of j.
+void GrayCodeSweepForBooleanExpressions::sweep(uint sourceValueBegin, uint sourceValueEnd, BitSlicedRegisterType* truthTableWord) const
+{
+	// Number of blocks with 64 input values. The last block may be incomplete, if there are less than 6 variables
+	const uint numberOfBlocks{ (sourceValueEnd - sourceValueBegin + NumberOfBitSlicedLanes - 1U) / NumberOfBitSlicedLanes };
+	std::fill(truthTableWord, truthTableWord + numberOfBlocks, null<BitSlicedRegisterType>());
+
+	if (isAvailable())
+	{
+		// One value slot for each instruction. Local, so that many threads can sweep at the same time
+		std::vector<BitSlicedRegisterType> value(program.size(), null<BitSlicedRegisterType>());
+
+		uint firstBlock{ sourceValueBegin / NumberOfBitSlicedLanes };
+		uint blocksLeft{ numberOfBlocks };
+		while (blocksLeft > 0U)
+		{
+			// Find the biggest power of 2, which fits into the rest of the range and for which the first block is aligned
+			uint blocksInPart{ 1U };
+			while ((((blocksInPart * 2U) <= blocksLeft)) && (0U == (firstBlock % (blocksInPart * 2U))))
+			{
+				blocksInPart *= 2U;
+			}
+
+			// Calculate the first block of this part completely
+			uint sourceValueBase{ firstBlock * NumberOfBitSlicedLanes };
+			for (uint instructionIndex = 0U; instructionIndex < program.size(); ++instructionIndex)
+			{
+				execute(instructionIndex, sourceValueBase, value);
+			}
+			truthTableWord[firstBlock - (sourceValueBegin / NumberOfBitSlicedLanes)] = value[resultIndex];
+
+			// And now all other blocks of this part in Gray code order
+			for (uint j = 1U; j < blocksInPart; ++j)
+			{
+				// The number of trailing zeros of j is the bit in the Gray code that changes
+				uint changedBit{ 0U };
+				while (0U == (j&  bitMask[changedBit]))
+				{
+					++changedBit;
+				}
+				// The changed variable. The lowest 6 variables are in the lanes
+				const uint changedVariable{ changedBit + 6U };
+				// The next block in gray code order
+				const uint grayCode{ j ^ (j >> 1U) };
+				sourceValueBase = (firstBlock + grayCode) * NumberOfBitSlicedLanes;
+
+				// Execute only the instructions, that depend on the changed variable
+				for (const uint16_t instructionIndex : fanOutCone[changedVariable])
+				{
+					execute(instructionIndex, sourceValueBase, value);
+				}
+				truthTableWord[firstBlock + grayCode - (sourceValueBegin / NumberOfBitSlicedLanes)] = value[resultIndex];
+			}
+			firstBlock += blocksInPart;
+			blocksLeft -= blocksInPart;
+		}
+	}
+}
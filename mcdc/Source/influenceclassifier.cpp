@@ -0,0 +1,269 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+
+
+
+//
+// Influence Classifier. Word parallel check of test pairs for MC/DC
+//
+// See header file for further explanations
+//
+
+#include "influenceclassifier.hpp"
+
+#include <algorithm>
+
+
+// Collect everything about the structure of the AST that is needed for the classification
+InfluenceClassifier::InfluenceClassifier(const AST& ast, const NodeValueMatrix& nodeValueMatrixForAst) : nodeValueMatrix(nodeValueMatrixForAst)
+{
+	const std::vector<uint>& nodeIndexPostOrder{ nodeValueMatrix.getNodeIndexPostOrder() };
+	// Parents before children is the reverse of the evaluation sequence
+	nodeIndexPreOrder.assign(nodeIndexPostOrder.crbegin(), nodeIndexPostOrder.crend());
+
+	parentIndex.resize(ast.size(), ASTNoLinkedElement);
+	for (const uint index : nodeIndexPostOrder)
+	{
+		parentIndex[index] = ast[index].parentID;
+		if (NumberOfChildren::zero == ast[index].numberOfChildren)
+		{
+			leafIndex.push_back(index);
+			leafCondition.push_back(ast[index].tokenWithAttribute.inputSymbolLowerCase);
+			leafSourceMask.push_back(ast[index].tokenWithAttribute.sourceMask);
+		}
+	}
+	// Group the leaves by the name of the condition
+	std::vector<cchar> conditionName{ leafCondition };
+	std::sort(conditionName.begin(), conditionName.end());
+	conditionName.erase(std::unique(conditionName.begin(), conditionName.end()), conditionName.end());
+	leavesOfCondition.resize(conditionName.size());
+	for (uint leaf = 0U; leaf < narrow_cast<uint>(leafIndex.size()); ++leaf)
+	{
+		const std::vector<cchar>::iterator it{ std::lower_bound(conditionName.begin(), conditionName.end(), leafCondition[leaf]) };
+		leavesOfCondition[narrow_cast<uint>(it - conditionName.begin())].push_back(leaf);
+	}
+	leafExcluded.resize(leafIndex.size(), false);
+
+	changed.resize(ast.size(), null<BitSlicedRegisterType>());
+	onTruePath.resize(ast.size(), null<BitSlicedRegisterType>());
+}
+
+
+
+// Remember the leaves that are observable for the outer test value
+bool InfluenceClassifier::selectObservableLeaves(uint outer)
+{
+	observableLeafIndex.clear();
+	observableLeafValue.clear();
+	for (uint leaf = 0U; leaf < narrow_cast<uint>(leafIndex.size()); ++leaf)
+	{
+		const uint index{ leafIndex[leaf] };
+		if (!leafExcluded[leaf] && nodeValueMatrix.observable(index, outer))
+		{
+			observableLeafIndex.push_back(index);
+			observableLeafValue.push_back(nodeValueMatrix.value(index, outer) ? ~null<BitSlicedRegisterType>() : null<BitSlicedRegisterType>());
+		}
+	}
+	return !observableLeafIndex.empty();
+}
+
+
+
+// Mark all leaves with the name of the condition
+void InfluenceClassifier::excludeCondition(cchar condition)
+{
+	for (uint leaf = 0U; leaf < narrow_cast<uint>(leafIndex.size()); ++leaf)
+	{
+		if (condition == leafCondition[leaf])
+		{
+			leafExcluded[leaf] = true;
+		}
+	}
+}
+
+
+
+// A selected leaf is observable for the inner test value and its value changed
+BitSlicedRegisterType InfluenceClassifier::getCandidates(uint innerWordIndex) const noexcept
+{
+	BitSlicedRegisterType candidates{ null<BitSlicedRegisterType>() };
+	for (uint i = 0U; i < narrow_cast<uint>(observableLeafIndex.size()); ++i)
+	{
+		const uint index{ observableLeafIndex[i] };
+		candidates |= nodeValueMatrix.observableWord(index, innerWordIndex) & (nodeValueMatrix.valueWord(index, innerWordIndex) ^ observableLeafValue[i]);
+	}
+	return candidates;
+}
+
+
+
+// Check 64 test pairs at the same time
+void InfluenceClassifier::classify(uint outer, uint innerWordIndex)
+{
+	constexpr BitSlicedRegisterType allLanes{ ~null<BitSlicedRegisterType>() };
+
+	// Build the influence trees for all test pairs. Tree XOR. The values of the outer test value are the same for all lanes
+	// A node that has not been evaluated for one of the test values is not changed
+	for (const uint index : nodeIndexPreOrder)
+	{
+		const BitSlicedRegisterType outerValue{ nodeValueMatrix.value(index, outer) ? allLanes : null<BitSlicedRegisterType>() };
+		const BitSlicedRegisterType outerEvaluated{ nodeValueMatrix.notEvaluated(index, outer) ? null<BitSlicedRegisterType>() : allLanes };
+		changed[index] = (nodeValueMatrix.valueWord(index, innerWordIndex) ^ outerValue) & ~nodeValueMatrix.notEvaluatedWord(index, innerWordIndex) & outerEvaluated;
+	}
+	classifyChangedNodes();
+}
+
+
+
+// Check 64 independent test pairs at the same time. Lane by lane
+void InfluenceClassifier::classifyPairs(uint outerWordIndex, uint innerWordIndex)
+{
+	for (const uint index : nodeIndexPreOrder)
+	{
+		changed[index] = (nodeValueMatrix.valueWord(index, outerWordIndex) ^ nodeValueMatrix.valueWord(index, innerWordIndex)) &
+			~nodeValueMatrix.notEvaluatedWord(index, outerWordIndex) & ~nodeValueMatrix.notEvaluatedWord(index, innerWordIndex);
+	}
+	classifyChangedNodes();
+}
+
+
+
+// Check 64 test pairs, that differ only in one input bit, at the same time
+void InfluenceClassifier::classifyNeighbours(uint wordIndex, uint inputBit)
+{
+	// The values for the flipped input bit
+	const auto neighbourWord = [wordIndex, inputBit](const BitSlicedRegisterType word, const BitSlicedRegisterType otherWord) noexcept -> BitSlicedRegisterType
+	{
+		BitSlicedRegisterType result{ otherWord };
+		if (inputBit < bitSlicedLanePattern.size())
+		{
+			// The neighbour is in the same word. Swap the blocks of lanes with input bit 0 and 1
+			const uint shift{ 1U << inputBit };
+			result = ((word & bitSlicedLanePattern[inputBit]) >> shift) | ((word & ~bitSlicedLanePattern[inputBit]) << shift);
+		}
+		return result;
+	};
+	// For higher bits, the neighbour values are in another word
+	const uint otherWordIndex{ (inputBit < bitSlicedLanePattern.size()) ? wordIndex : (wordIndex ^ (1U << (inputBit - narrow_cast<uint>(bitSlicedLanePattern.size())))) };
+
+	for (const uint index : nodeIndexPreOrder)
+	{
+		const BitSlicedRegisterType value{ nodeValueMatrix.valueWord(index, wordIndex) };
+		const BitSlicedRegisterType notEvaluated{ nodeValueMatrix.notEvaluatedWord(index, wordIndex) };
+		const BitSlicedRegisterType neighbourValue{ neighbourWord(value, nodeValueMatrix.valueWord(index, otherWordIndex)) };
+		const BitSlicedRegisterType neighbourNotEvaluated{ neighbourWord(notEvaluated, nodeValueMatrix.notEvaluatedWord(index, otherWordIndex)) };
+		changed[index] = (value ^ neighbourValue) & ~notEvaluated & ~neighbourNotEvaluated;
+	}
+	classifyChangedNodes();
+}
+
+
+
+// Path check, counting and classification. The changed state of all nodes has been set before
+void InfluenceClassifier::classifyChangedNodes()
+{
+	// The path check is done top down. The root has no parent. So, its path is true, if it is changed
+	for (const uint index : nodeIndexPreOrder)
+	{
+		const uint parent{ parentIndex[index] };
+		onTruePath[index] = (ASTNoLinkedElement == parent) ? changed[index] : (changed[index] & onTruePath[parent]);
+	}
+
+	// Count modified and influencing conditions. We only need to know: none, one or more
+	BitSlicedRegisterType modifiedAtLeastOne{ null<BitSlicedRegisterType>() };
+	BitSlicedRegisterType modifiedAtLeastTwo{ null<BitSlicedRegisterType>() };
+	BitSlicedRegisterType influencingAtLeastOne{ null<BitSlicedRegisterType>() };
+	BitSlicedRegisterType influencingAtLeastTwo{ null<BitSlicedRegisterType>() };
+	for (const uint index : leafIndex)
+	{
+		modifiedAtLeastTwo |= modifiedAtLeastOne & changed[index];
+		modifiedAtLeastOne |= changed[index];
+		influencingAtLeastTwo |= influencingAtLeastOne & onTruePath[index];
+		influencingAtLeastOne |= onTruePath[index];
+	}
+	// Count the different names of modified conditions
+	BitSlicedRegisterType differentModifiedAtLeastTwo{ null<BitSlicedRegisterType>() };
+	BitSlicedRegisterType differentModifiedAtLeastOne{ null<BitSlicedRegisterType>() };
+	for (const std::vector<uint>& leaves : leavesOfCondition)
+	{
+		BitSlicedRegisterType conditionModified{ null<BitSlicedRegisterType>() };
+		for (const uint leaf : leaves)
+		{
+			conditionModified |= changed[leafIndex[leaf]];
+		}
+		differentModifiedAtLeastTwo |= differentModifiedAtLeastOne & conditionModified;
+		differentModifiedAtLeastOne |= conditionModified;
+	}
+
+	// Precondition for MCDC: Exactly one influencing condition. The influencing condition is always also modified
+	const BitSlicedRegisterType exactlyOneInfluencing{ influencingAtLeastOne & ~influencingAtLeastTwo };
+	// Additionally exactly one modified condition
+	uniqueCause = exactlyOneInfluencing & ~modifiedAtLeastTwo;
+	// More modified conditions, but all with the name of the influencing condition
+	uniqueCauseMasking = exactlyOneInfluencing & modifiedAtLeastTwo & ~differentModifiedAtLeastTwo;
+	// More different modified conditions
+	masking = exactlyOneInfluencing & modifiedAtLeastTwo & differentModifiedAtLeastTwo;
+}
+
+
+
+// All leaves for one input bit have the same name
+cchar InfluenceClassifier::getConditionOfInputBit(uint inputBit) const noexcept
+{
+	cchar result{ ' ' };
+	for (uint leaf = 0U; leaf < narrow_cast<uint>(leafIndex.size()); ++leaf)
+	{
+		if (leafSourceMask[leaf] == (1U << inputBit))
+		{
+			result = leafCondition[leaf];
+		}
+	}
+	return result;
+}
+
+
+
+// Find the leaf with a complete true path for one test pair of the last classification
+cchar InfluenceClassifier::getInfluencingCondition(uint lane) const noexcept
+{
+	cchar result{ ' ' };
+	for (uint leaf = 0U; leaf < narrow_cast<uint>(leafIndex.size()); ++leaf)
+	{
+		if (null<BitSlicedRegisterType>() != ((onTruePath[leafIndex[leaf]] >> lane) & 1U))
+		{
+			result = leafCondition[leaf];
+		}
+	}
+	return result;
+}
@@ -0,0 +1,400 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+//
+// Just in time compiler for boolean expressions
+//
+// The object code of the code generator for the virtual machine is translated into native x86-64 
+// machine code. The resulting function calculates 64 input values in bit sliced mode.
+//
+// Register usage of the generated code:
+//
+// r11		Pointer to the frame (variable values and spilled machine registers)
+// rax		Accumulator. All operations are done in rax and the result is then stored in the destination
+// others	Virtual machine registers 0..11 are mapped to rcx, rdx, rbx, rsi, rdi, r8, r9, r10, r12, r13, r14, r15
+//			All higher virtual machine registers are stored in the frame
+//
+// Callee saved registers are pushed in the prologue and restored in the epilogue. So the generated
+// code follows the Windows x64 and the System V calling convention. Only the register for the first
+// function argument is different.
+//
+
+
+#include "jitcompiler.hpp"
+
+#include <cstring>
+
+#ifdef JIT_COMPILER_X86_64
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+
+namespace
+{
+	// Register numbers of the x86-64 CPU
+	constexpr uint8_t CpuRegisterRax{ 0U };
+	constexpr uint8_t CpuRegisterRcx{ 1U };
+	constexpr uint8_t CpuRegisterRdx{ 2U };
+	constexpr uint8_t CpuRegisterRbx{ 3U };
+	constexpr uint8_t CpuRegisterRsi{ 6U };
+	constexpr uint8_t CpuRegisterRdi{ 7U };
+	constexpr uint8_t CpuRegisterR8{ 8U };
+	constexpr uint8_t CpuRegisterR9{ 9U };
+	constexpr uint8_t CpuRegisterR10{ 10U };
+	constexpr uint8_t CpuRegisterR11{ 11U };
+	constexpr uint8_t CpuRegisterR12{ 12U };
+	constexpr uint8_t CpuRegisterR13{ 13U };
+	constexpr uint8_t CpuRegisterR14{ 14U };
+	constexpr uint8_t CpuRegisterR15{ 15U };
+
+	// Frame pointer and accumulator
+	constexpr uint8_t CpuRegisterFrame{ CpuRegisterR11 };
+	constexpr uint8_t CpuRegisterAccumulator{ CpuRegisterRax };
+
+	// The first function argument
+#if defined(_WIN32)
+	constexpr uint8_t CpuRegisterFirstArgument{ CpuRegisterRcx };
+#else
+	constexpr uint8_t CpuRegisterFirstArgument{ CpuRegisterRdi };
+#endif
+
+	// CPU registers that will be used for virtual machine registers
+	constexpr std::array<uint8_t, 12> allocatableCpuRegister
+	{
+		CpuRegisterRcx, CpuRegisterRdx, CpuRegisterRbx, CpuRegisterRsi, CpuRegisterRdi, CpuRegisterR8,
+		CpuRegisterR9, CpuRegisterR10, CpuRegisterR12, CpuRegisterR13, CpuRegisterR14, CpuRegisterR15
+	};
+	// These registers must be preserved for the caller (Windows x64 and System V)
+	constexpr std::array<uint8_t, 7> calleeSavedCpuRegister
+	{
+		CpuRegisterRbx, CpuRegisterRsi, CpuRegisterRdi, CpuRegisterR12, CpuRegisterR13, CpuRegisterR14, CpuRegisterR15
+	};
+
+	// Op codes used for the generated code
+	constexpr uint8_t OpCodeMovRegisterFromOperand{ 0x8BU };	// mov r64, r/m64
+	constexpr uint8_t OpCodeMovOperandFromRegister{ 0x89U };	// mov r/m64, r64
+	constexpr uint8_t OpCodeAnd{ 0x23U };						// and r64, r/m64
+	constexpr uint8_t OpCodeOr{ 0x0BU };						// or  r64, r/m64
+	constexpr uint8_t OpCodeXor{ 0x33U };						// xor r64, r/m64
+	constexpr uint8_t OpCodeRet{ 0xC3U };						// ret
+}
+
+
+// Virtual machine registers 0..11 are held in CPU registers. All others are stored in the frame
+JitCompilerForBooleanExpressions::Operand JitCompilerForBooleanExpressions::getOperandForMachineRegister(uint machineRegister) const noexcept
+{
+	Operand operand;
+	if (machineRegister < allocatableCpuRegister.size())
+	{
+		operand.isCpuRegister = true;
+		operand.cpuRegister = allocatableCpuRegister[machineRegister];
+	}
+	else
+	{
+		operand.isCpuRegister = false;
+		operand.displacement = static_cast<sint>((FrameOffsetForSpilledRegisters + machineRegister) * sizeof(BitSlicedRegisterType));
+	}
+	return operand;
+}
+
+// The values of the variables are always in the frame
+JitCompilerForBooleanExpressions::Operand JitCompilerForBooleanExpressions::getOperandForVariable(uint variableIndex) const noexcept
+{
+	Operand operand;
+	operand.isCpuRegister = false;
+	operand.displacement = static_cast<sint>(variableIndex * sizeof(BitSlicedRegisterType));
+	return operand;
+}
+
+
+// Encode an instruction with a 64 bit CPU register and a register or memory operand
+// REX.W prefix, op code, ModRM byte and, for memory operands, a 32 bit displacement relative to the frame pointer
+void JitCompilerForBooleanExpressions::emitRegisterAndOperand(uint8_t opCode, uint8_t cpuRegister, const Operand& operand)
+{
+	// REX prefix. W for 64 bit operands, R for extension of the register, B for the extension of register/memory
+	const uint8_t operandRegister{ operand.isCpuRegister ? operand.cpuRegister : CpuRegisterFrame };
+	const uint8_t rex{ narrow_cast<uint8_t>(0x48U | ((cpuRegister >= 8U) ? 0x04U : 0x00U) | ((operandRegister >= 8U) ? 0x01U : 0x00U)) };
+	machineCode.push_back(rex);
+	machineCode.push_back(opCode);
+	if (operand.isCpuRegister)
+	{
+		// ModRM: Register direct
+		machineCode.push_back(narrow_cast<uint8_t>(0xC0U | ((cpuRegister&  7U) << 3U) | (operandRegister&  7U)));
+	}
+	else
+	{
+		// ModRM: Memory with base register and 32 bit displacement. The frame pointer r11 does not need a SIB byte
+		machineCode.push_back(narrow_cast<uint8_t>(0x80U | ((cpuRegister&  7U) << 3U) | (operandRegister&  7U)));
+		const uint32_t displacement{ static_cast<uint32_t>(operand.displacement) };
+		for (uint i = 0; i < 4U; ++i)
+		{
+			machineCode.push_back(narrow_cast<uint8_t>(displacement >> (i * 8U)));
+		}
+	}
+}
+
+// mov reg, r/m
+void JitCompilerForBooleanExpressions::emitLoad(uint8_t cpuRegister, const Operand& source)
+{
+	emitRegisterAndOperand(OpCodeMovRegisterFromOperand, cpuRegister, source);
+}
+
+// mov r/m, reg
+void JitCompilerForBooleanExpressions::emitStore(const Operand& destination, uint8_t cpuRegister)
+{
+	emitRegisterAndOperand(OpCodeMovOperandFromRegister, cpuRegister, destination);
+}
+
+// not reg
+void JitCompilerForBooleanExpressions::emitNot(uint8_t cpuRegister)
+{
+	machineCode.push_back(narrow_cast<uint8_t>(0x48U | ((cpuRegister >= 8U) ? 0x01U : 0x00U)));
+	machineCode.push_back(0xF7U);
+	machineCode.push_back(narrow_cast<uint8_t>(0xD0U | (cpuRegister&  7U)));
+}
+
+// push reg
+void JitCompilerForBooleanExpressions::emitPush(uint8_t cpuRegister)
+{
+	if (cpuRegister >= 8U)
+	{
+		machineCode.push_back(0x41U);
+	}
+	machineCode.push_back(narrow_cast<uint8_t>(0x50U | (cpuRegister&  7U)));
+}
+
+// pop reg
+void JitCompilerForBooleanExpressions::emitPop(uint8_t cpuRegister)
+{
+	if (cpuRegister >= 8U)
+	{
+		machineCode.push_back(0x41U);
+	}
+	machineCode.push_back(narrow_cast<uint8_t>(0x58U | (cpuRegister&  7U)));
+}
+
+
+
+// Translate the object code into native machine code
+// All operations are done in the accumulator
+// 
+// Example:  AND R1 R2 --> R3    will be translated to
+//
+//		mov rax, rdx
+//		and rax, rbx
+//		mov rsi, rax
+//
+bool JitCompilerForBooleanExpressions::compile(ObjectCode& objectCode)
+{
+	// Forget previously compiled code
+	releaseExecutableMemory();
+	machineCode.clear();
+
+#ifdef JIT_COMPILER_X86_64
+	// Before starting, compact the symbol table to get the normalized input
+	objectCode.symbolTable.compact();
+
+	// Check, if all virtual machine registers can be mapped
+	bool registersSufficient{ true };
+
+	// Prologue. Save callee saved registers and get the frame pointer
+	for (const uint8_t cpuRegister : calleeSavedCpuRegister)
+	{
+		emitPush(cpuRegister);
+	}
+	emitStore(Operand{ true, CpuRegisterFrame, 0 }, CpuRegisterFirstArgument);
+
+	// Translate the object code line by line
+	for (const OpCodeLine& opCodeLine : objectCode.opCode)
+	{
+		// Check the register numbers. Variable index is not a register
+		const uint maxRegisterInLine{ std::max(opCodeLine.parameter2, ((Token::ID == opCodeLine.token) || (Token::IDNOT == opCodeLine.token)) ? 0U : std::max(opCodeLine.parameter1, opCodeLine.parameter3)) };
+		if (maxRegisterInLine >= MaxNumberOfJitRegisters)
+		{
+			registersSufficient = false;
+			break;
+		}
+		switch (opCodeLine.token)
+		{
+		case Token::ID:
+			emitLoad(CpuRegisterAccumulator, getOperandForVariable(objectCode.symbolTable.normalizedInput[opCodeLine.parameter1]));
+			emitStore(getOperandForMachineRegister(opCodeLine.parameter2), CpuRegisterAccumulator);
+			break;
+		case Token::IDNOT:
+			emitLoad(CpuRegisterAccumulator, getOperandForVariable(objectCode.symbolTable.normalizedInput[opCodeLine.parameter1]));
+			emitNot(CpuRegisterAccumulator);
+			emitStore(getOperandForMachineRegister(opCodeLine.parameter2), CpuRegisterAccumulator);
+			break;
+		case Token::OR:
+			emitLoad(CpuRegisterAccumulator, getOperandForMachineRegister(opCodeLine.parameter1));
+			emitRegisterAndOperand(OpCodeOr, CpuRegisterAccumulator, getOperandForMachineRegister(opCodeLine.parameter2));
+			emitStore(getOperandForMachineRegister(opCodeLine.parameter3), CpuRegisterAccumulator);
+			break;
+		case Token::XOR:
+			emitLoad(CpuRegisterAccumulator, getOperandForMachineRegister(opCodeLine.parameter1));
+			emitRegisterAndOperand(OpCodeXor, CpuRegisterAccumulator, getOperandForMachineRegister(opCodeLine.parameter2));
+			emitStore(getOperandForMachineRegister(opCodeLine.parameter3), CpuRegisterAccumulator);
+			break;
+		case Token::AND:
+			emitLoad(CpuRegisterAccumulator, getOperandForMachineRegister(opCodeLine.parameter1));
+			emitRegisterAndOperand(OpCodeAnd, CpuRegisterAccumulator, getOperandForMachineRegister(opCodeLine.parameter2));
+			emitStore(getOperandForMachineRegister(opCodeLine.parameter3), CpuRegisterAccumulator);
+			break;
+		case Token::NOT:
+			emitLoad(CpuRegisterAccumulator, getOperandForMachineRegister(opCodeLine.parameter1));
+			emitNot(CpuRegisterAccumulator);
+			emitStore(getOperandForMachineRegister(opCodeLine.parameter2), CpuRegisterAccumulator);
+			break;
+		case Token::END:
+			// The result of the function is returned in rax
+			emitLoad(CpuRegisterAccumulator, getOperandForMachineRegister(opCodeLine.parameter1));
+			break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		}
+	}
+
+	// Epilogue. Restore callee saved registers in reverse order and return
+	for (auto cpuRegister = calleeSavedCpuRegister.rbegin(); cpuRegister != calleeSavedCpuRegister.rend(); ++cpuRegister)
+	{
+		emitPop(*cpuRegister);
+	}
+	machineCode.push_back(OpCodeRet);
+
+	// Copy the code to executable memory
+	if (registersSufficient)
+	{
+		makeCodeExecutable();
+	}
+#endif
+	return isAvailable();
+}
+
+
+// Run the generated native code for 64 input values
+// The values of the variables are calculated as in the bit sliced virtual machine
+BitSlicedRegisterType JitCompilerForBooleanExpressions::run(uint sourceValueBase) const
+{
+	BitSlicedRegisterType result{ null<BitSlicedRegisterType>() };
+	if (isAvailable())
+	{
+		// The frame is local. So different threads can run the same code
+		BitSlicedRegisterType frame[FrameSize];
+		for (uint variable = 0; variable < FrameOffsetForSpilledRegisters; ++variable)
+		{
+			if (variable < bitSlicedLanePattern.size())
+			{
+				frame[variable] = bitSlicedLanePattern[variable];
+			}
+			else
+			{
+				frame[variable] = (null<uint32>() == (sourceValueBase&  bitMask[variable])) ? null<BitSlicedRegisterType>() : ~null<BitSlicedRegisterType>();
+			}
+		}
+		result = nativeFunction(&frame[0]);
+	}
+	return result;
+}
+
+
+// Allocate memory, copy the machine code and make the memory executable
+// The memory will never be writable and executable at the same time
+bool JitCompilerForBooleanExpressions::makeCodeExecutable()
+{
+	bool result{ false };
+#ifdef JIT_COMPILER_X86_64
+	executableMemorySize = machineCode.size();
+#if defined(_WIN32)
+	executableMemory = VirtualAlloc(nullptr, executableMemorySize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+	if (nullptr != executableMemory)
+	{
+		std::memcpy(executableMemory, machineCode.data(), machineCode.size());
+		DWORD oldProtection{ 0 };
+		if (VirtualProtect(executableMemory, executableMemorySize, PAGE_EXECUTE_READ, &oldProtection))
+		{
+			FlushInstructionCache(GetCurrentProcess(), executableMemory, executableMemorySize);
+			result = true;
+		}
+	}
+#else
+	executableMemory = mmap(nullptr, executableMemorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (MAP_FAILED == executableMemory)
+	{
+		executableMemory = nullptr;
+	}
+	else
+	{
+		std::memcpy(executableMemory, machineCode.data(), machineCode.size());
+		if (0 == mprotect(executableMemory, executableMemorySize, PROT_READ | PROT_EXEC))
+		{
+			result = true;
+		}
+	}
+#endif
+	if (result)
+	{
+		nativeFunction = reinterpret_cast<NativeFunction>(executableMemory);
+	}
+	else
+	{
+		// Something went wrong. The interpreter must be used
+		releaseExecutableMemory();
+	}
+#endif
+	return result;
+}
+
+
+// Give back the executable memory to the operating system
+void JitCompilerForBooleanExpressions::releaseExecutableMemory() noexcept
+{
+#ifdef JIT_COMPILER_X86_64
+	if (nullptr != executableMemory)
+	{
+#if defined(_WIN32)
+		VirtualFree(executableMemory, 0, MEM_RELEASE);
+#else
+		munmap(executableMemory, executableMemorySize);
+#endif
+	}
+#endif
+	executableMemory = nullptr;
+	executableMemorySize = 0U;
+	nativeFunction = nullptr;
+}
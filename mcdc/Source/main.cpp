@@ -32,11 +32,18 @@
 #include "cloption.hpp"
 #include "quinemccluskey.hpp"
 #include "mcdc.hpp"
+#include "pipeline.hpp"
+#include "threadpool.hpp"
+#include "runbudget.hpp"
 
 #include <iostream>
+#include <future>
+#include <vector>
+#include <set>
 #include <assert.h>
 
 void showHelp();
+bool stagesShareOutputFiles();
 
 sint main(const sint argc, const cchar* const argv[])
 {
@@ -45,6 +52,8 @@ sint main(const sint argc, const cchar* const argv[])
     // Read the command line options and evaluate them
     programOption.readOptions(argc, argv);
     programOption.evaluateCommandLine();
+    // Start the clock for the time limit, if any
+    runBudget.start();
 
     // If the program is called without any parameters, then help is shown
     // The minimum necessary is that a boolean source expression is given
@@ -74,9 +83,16 @@ sint main(const sint argc, const cchar* const argv[])
 	// All symbols will be stored in the symbol table by the compiler as a part of the object code
     SymbolTable symbolTable;
 
-	// After evaluationg the boolean expression with all possible source values, we will receive a list of minterms
-    MintermVector mv;
+	// The sampled search for MC/DC test pairs evaluates the boolean expression only for random input values. If the AST analysis
+	// continues with the original boolean expression, then neither the truth table nor the minimum DNF is needed. Then also
+	// more boolean variables are possible
+    const bool sampledSearchOnly{ programOption.option[ProgramOption::sample].optionSelected && !programOption.option[ProgramOption::umdnf].optionSelected };
+
+	// After evaluationg the boolean expression with all possible source values, we will receive the truth table with all minterms
+    TruthTable truthTable;
     MintermCalculator mc(source);
+	// The Quine & McCluskey method. Its initial table will be built while the minterms are calculated
+    QuineMcluskey quineMcluskey;
 
 	// Compile the source code boolean expression 
 	const bool termIsOk{ mc.runCompiler() };
@@ -95,27 +111,42 @@ sint main(const sint argc, const cchar* const argv[])
         numberOfVariables = symbolTable.numberOfSymbols();
 
 		// Because increasing the number of variables makes the program geometrically slow, we
-		// limit the number of input varaiables
-        if (numberOfVariables > MaxNumberOfBitsForEvaluation)
+		// limit the number of input varaiables. Not for the sampled search only
+        if (!sampledSearchOnly && (numberOfVariables > MaxNumberOfBitsForEvaluation))
         {
             std::cerr << "\n\n*** Error: Too many boolean variables for this program version (" << narrow_cast<uint>(numberOfVariables) << "). Max is: " << MaxNumberOfBitsForEvaluation << "\n\n";
             booleanExpresionsValid = false;
         }
 
-        if (booleanExpresionsValid)
+        if (booleanExpresionsValid && !sampledSearchOnly)
         {
 			// So, the boolean expression was valid
-			// Now calculate the vector with the minterms (slow)
-            mv = mc.calculate();
+			// Now calculate the minterms (slow). The calculation runs asynchronously and streams the
+			// words of the truth table. Here we store them and build the initial Quine & McCluskey table at the same time
+            truthTable.reset(numberOfVariables);
+            TruthTableStream truthTableStream;
+            std::future<void> mintermCalculation{ std::async(std::launch::async, [&mc, &truthTableStream]() { mc.calculate(truthTableStream); }) };
+            TruthTableChunk truthTableChunk;
+            while (truthTableStream.next(truthTableChunk))
+            {
+                for (uint word = 0; word < truthTableChunk.word.size(); ++word)
+                {
+                    truthTable.setWord(truthTableChunk.firstWordIndex + word, truthTableChunk.word[word]);
+                }
+                quineMcluskey.addMinterms(truthTableChunk);
+            }
+            mintermCalculation.get();
+			// Count the minterms. Needed for the check for contradiction and tautology
+            truthTable.compact();
 
-            if (null<MintermVector::size_type>() == mv.size())
+            if (truthTable.isContradiction())
             {
 				// If there are no minterms, the boolean expressions evaluates always to false
 				// This is called a contradiction
                 std::cerr << "\n\n*** Contradiction. Boolean expression '" << source << "' is always false\n\n";
                 booleanExpresionsValid = false;
             }
-            if (narrow_cast<MintermVector::size_type>((narrow_cast <MintermVector::size_type>(1) << mc.getNumberOfBooleanVariables())) == mv.size())
+            if (truthTable.isTautology())
             {
 				// If there are minterms for every inpiut value, the boolean expressions evaluates always to true
 				// This is called a tautology
@@ -129,52 +160,111 @@ sint main(const sint argc, const cchar* const argv[])
 	// We checked the validity
     if (booleanExpresionsValid)
     {
+        std::cout << "\n\nStart to evaluate boolean expression\n\n'" << source << "'\n\nNumber of Variables : " << narrow_cast<uint>(numberOfVariables);
+        if (sampledSearchOnly)
+        {
+            std::cout << "   Sampled search only. No truth table and no minimum DNF\n\n\n";
+        }
+        else
+        {
+            std::cout << "   Calculated number of minterms : " << truthTable.numberOfMinterms() << "\n\n\n";
+        }
 
-        std::cout << "\n\nStart to evaluate boolean expression\n\n'" << source << "'\n\nNumber of Variables : " << narrow_cast<uint>(numberOfVariables) << "   Calculated number of minterms : " << mv.size() << "\n\n\n";
-        printTruthTable(source, mv, symbolTable);
+		// The following analyses are stages of a pipeline. Stages, that do not depend on each other, may run at the same time
+		// All console output in the stages must go to OutputHandling::console(). It will be shown in the sequence of the stages
+        Pipeline pipeline;
 
-		// Start the Quine & McCluskey Algorithm and get aminimum DNF
-        QuineMcluskey quineMcluskey;
-		std::string minimizedSource{ quineMcluskey.getMinimumDisjunctiveNormalForm(mv, symbolTable, source) };
-        std::cout << "\n\nResult of Quine and McCluskey minimizing algorithm:\n\n'" << minimizedSource << "'\n\n";
+		// Stage 1 and 2 need the truth table. There is none for the sampled search only
+        std::string minimizedSource;
+        Pipeline::StageIndex quineMcluskeyStage{ 0U };
+        if (!sampledSearchOnly)
+        {
+			// Stage 1: Show the truth table
+            pipeline.addStage([&source, &truthTable, &symbolTable]()
+            {
+                printTruthTable(source, truthTable, symbolTable);
+            });
+
+			// Stage 2: Start the Quine & McCluskey Algorithm and get aminimum DNF
+            quineMcluskeyStage = pipeline.addStage([&minimizedSource, &quineMcluskey, &truthTable, &symbolTable, &source]()
+            {
+                minimizedSource = quineMcluskey.getMinimumDisjunctiveNormalForm(truthTable, symbolTable, source);
+                OutputHandling::console() << "\n\nResult of Quine and McCluskey minimizing algorithm:\n\n'" << minimizedSource << "'\n\n";
+                if (quineMcluskey.isPartialResult())
+                {
+                    OutputHandling::console() << "*** Partial result. Time limit reached. The DNF is equivalent, but may not be minimal\n\n";
+                }
+            });
+        }
 
 		// We can continue to do the MCDC analysis with the original source code
 		// This may result in unnecessary large Abstract Syntax Trees
 		// Therefore there is an option to continue with the just calculated minimum DNF
-        if (programOption.option[ProgramOption::umdnf].optionSelected)
-        {
-			// In  that case, reassign the just found minimum DNF to the source code string
-            source = minimizedSource;
-            std::cout << "Continue Abstract Syntax Tree Analyis with minimized boolean expression\n\n'" << source << "'\n\n";
-        }
-        else
+		// Only in that case, the AST analysis has to wait for the Quine & McCluskey Algorithm
+        const bool useMinimizedSource{ programOption.option[ProgramOption::umdnf].optionSelected };
+        std::vector<Pipeline::StageIndex> astAnalysisPredecessor;
+        if (useMinimizedSource)
         {
-            std::cout << "Continue Abstract Syntax Tree Analyis with original boolean expression\n\n'" << source << "'\n\n";
+            astAnalysisPredecessor.push_back(quineMcluskeyStage);
         }
 
+		// Stage 3: Abstract Syntax Tree analysis and search for MC/DC test pairs
+        pipeline.addStage([useMinimizedSource, &minimizedSource, &source]()
+        {
+            std::string astSource{ (useMinimizedSource) ? minimizedSource : source };
+            if (useMinimizedSource)
+            {
+                OutputHandling::console() << "Continue Abstract Syntax Tree Analyis with minimized boolean expression\n\n'" << astSource << "'\n\n";
+            }
+            else
+            {
+                OutputHandling::console() << "Continue Abstract Syntax Tree Analyis with original boolean expression\n\n'" << astSource << "'\n\n";
+            }
 
+			// We and to create the AST
+            VirtualMachineForAST virtualMachineForAST;
 
-		// We and to create the AST
-        VirtualMachineForAST virtualMachineForAST;
-        
-		// Compile AST
-        CompilerForAST compilerForAST(source, virtualMachineForAST);
-		const bool compilerResult{ compilerForAST() };
-        
-        if (compilerResult)
-        {
-			// If that was OK. Show tree
-            virtualMachineForAST.printTreeStandard(source);
+			// Compile AST
+            CompilerForAST compilerForAST(astSource, virtualMachineForAST);
+            const bool compilerResult{ compilerForAST() };
 
-			// If selected, find MCDC test pairs and test set
-            if (!programOption.option[ProgramOption::nomcdc].optionSelected)
+            if (compilerResult)
             {
-                Mcdc mcdc;
-
-                mcdc.findMcdcIndependencePairs(virtualMachineForAST);
-                mcdc.generateTestSets();
+				// If that was OK. Show tree
+                virtualMachineForAST.printTreeStandard(astSource);
+
+#ifdef _DEBUG
+				// Debug builds only: With boolean short cut evaluation, the virtual machine with conditional jumps must evaluate
+				// exactly the leaves, that are evaluated in the AST. Check this for all input values. Not for the many variables of a sampled search
+                if (programOption.option[ProgramOption::bse].optionSelected && (virtualMachineForAST.maxConditionsInTree() <= static_cast<uint>(MaxNumberOfBitsForEvaluation)))
+                {
+                    ObjectCode objectCodeWithJumps;
+                    CompilerForVM compilerForVM(astSource, objectCodeWithJumps, true);
+                    if (compilerForVM())
+                    {
+                        VirtualMachineForBooleanExpressions virtualMachineWithJumps;
+                        virtualMachineWithJumps.load(objectCodeWithJumps);
+                        if (!virtualMachineWithJumps.isEquivalentTo(virtualMachineForAST))
+                        {
+                            OutputHandling::console() << "\n\n*** Internal error: Boolean short cut evaluation of the virtual machine differs from the evaluation of the AST\n\n";
+                        }
+                    }
+                }
+#endif
+
+				// If selected, find MCDC test pairs and test set
+                if (!programOption.option[ProgramOption::nomcdc].optionSelected)
+                {
+                    Mcdc mcdc;
+
+                    mcdc.findMcdcIndependencePairs(virtualMachineForAST);
+                    mcdc.generateTestSets();
+                }
             }
-        }
+        }, astAnalysisPredecessor);
+
+		// Stages may only run at the same time, if there are more threads and if they do not write into the same files
+        pipeline.run((threadPool.getNumberOfThreads() > 1U) && !stagesShareOutputFiles());
     }
     return 0;
 }
@@ -335,6 +425,22 @@ void showHelp()
 	std::cout << " -pmcsfautoa                   Automatically write big data for all MC/DC coverage sets to file with automatic created filename, write small data to console. Default\n";
 	std::cout << "\n";
 	std::cout << "\n";
+	std::cout << " ---------------------------------------------------------------\n";
+	std::cout << " 4. Performance options\n";
+	std::cout << "\n";
+	std::cout << " -jit                          Translate the boolean expression to native x86-64 machine code for the minterm calculation. Falls back to the interpreter, if not possible\n";
+	std::cout << " -gcs                          Calculate the minterms with a Gray code sweep. Only instructions depending on the changed variable will be executed again\n";
+	std::cout << " -nocopt                       Do not optimize the object code for the virtual machine (common sub expressions, simplification, constant folding)\n";
+	std::cout << " -threads \"n\"                  Number of worker threads for all parallel calculations. Default is the number of hardware threads\n";
+	std::cout << " -grain \"n\"                    Number of truth table words (64 input values each) per task of the minterm calculation. Default is calculated by a cost model\n";
+	std::cout << " -tl \"s\"                       Time limit in seconds for the whole run. When reached, all searches stop and the best partial results are shown, marked as partial\n";
+	std::cout << " -mp \"n\"                       Stop the search for MC/DC test pairs after n test pairs have been found. The test pairs and test sets are marked as partial\n";
+	std::cout << " -ucf                          Unique cause fast mode. Search MC/DC test pairs only among test values that differ in exactly one condition\n";
+	std::cout << " -quota \"n\"                    Per condition quota. Stop the search for a condition after n unique cause test pairs have been found. Other test pairs are kept up to n per type and stop the search, if all conditions have reached their quota\n";
+	std::cout << " -sample \"n\"                   Sampled search for MC/DC test pairs. Check n random test pairs instead of all. For decisions with many conditions. Without -umdnf, there is no truth table and no minimum DNF and up to 26 conditions are possible\n";
+	std::cout << " -seed \"n\"                     Seed for the random numbers of the sampled search. Same seed, same result. Default is 1\n";
+	std::cout << "\n";
+	std::cout << "\n";
 	std::cout << " Any 3.7 option switches on the respective 3.8 options\n";
 	std::cout << "\n";
 	std::cout << "\n";
@@ -349,3 +455,32 @@ void showHelp()
 }
 
 
+
+// The stages of the pipeline in main may write into files. If 2 stages would write into the same file, then the
+// data would be mixed up and the file open modes (overwrite/append) would not work. Then the stages must run one after the other
+bool stagesShareOutputFiles()
+{
+	// The output option groups used by the stages. Truth table, Quine & McCluskey and AST/MCDC analysis
+	const std::vector<std::set<std::string>> stageOutputFileNames
+	{
+		programOption.getSelectedOutputFileNames({ ProgramOption::pttc }),
+		programOption.getSelectedOutputFileNames({ ProgramOption::pqmtc, ProgramOption::ppirtc }),
+		programOption.getSelectedOutputFileNames({ ProgramOption::pastc, ProgramOption::pmastc, ProgramOption::pmtpc, ProgramOption::pmcsc })
+	};
+
+	bool outputFilesShared{ false };
+	for (uint i = 0; i < stageOutputFileNames.size(); ++i)
+	{
+		for (uint k = i + 1U; k < stageOutputFileNames.size(); ++k)
+		{
+			for (const std::string& outputFileName : stageOutputFileNames[i])
+			{
+				if (stageOutputFileNames[k].count(outputFileName) > 0U)
+				{
+					outputFilesShared = true;
+				}
+			}
+		}
+	}
+	return outputFilesShared;
+}
@@ -122,9 +122,69 @@
 
 #include "coverage.hpp"
 #include "ast.hpp"
+#include "threadpool.hpp"
+#include "runbudget.hpp"
+#include "outputsink.hpp"
+#include "influenceclassifier.hpp"
 
 #include <iostream>
 #include <iomanip>
+#include <future>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <bitset>
+
+
+namespace
+{
+	// Number of set bits in a test value. The test values of the sampled search may have more bits than a minterm
+	sint numberOfSetBitsInTestValue(const uint testValue) noexcept
+	{
+		return static_cast<sint>(std::bitset<sizeof(uint) * 8U>(testValue).count());
+	}
+
+	// Type of MCDC for one lane of the result of the influence classifier
+	McdcType mcdcTypeOfLane(const BitSlicedRegisterType uniqueCause, const BitSlicedRegisterType uniqueCauseMasking, const BitSlicedRegisterType masking, const uint lane) noexcept
+	{
+		McdcType mcdcType{ McdcType::NONE };
+		if (null<BitSlicedRegisterType>() != ((uniqueCause >> lane) & 1U))
+		{
+			mcdcType = McdcType::UniqueCause;
+		}
+		else if (null<BitSlicedRegisterType>() != ((uniqueCauseMasking >> lane) & 1U))
+		{
+			mcdcType = McdcType::UniqueCauseMasking;
+		}
+		else if (null<BitSlicedRegisterType>() != ((masking >> lane) & 1U))
+		{
+			mcdcType = McdcType::Masking;
+		}
+		return mcdcType;
+	}
+
+	// Inform the user about the result of the check of one test pair
+	void showTestPair(std::ostream& os, const McdcType mcdcType, const cchar influencingCondition, const uint outer, const uint inner)
+	{
+		switch (mcdcType)
+		{
+		case McdcType::UniqueCause:
+			os << "\n----------------------- Found   Unique Cause          MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
+			break;
+		case McdcType::UniqueCauseMasking:
+			os << "\n----------------------- Found   Unique Cause+Masking  MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
+			break;
+		case McdcType::Masking:
+			os << "\n----------------------- Found   Masking               MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
+			break;
+		case McdcType::NONE: //fallthrough
+		default:
+			os << "....................... Could not be identified as MCDC of any type.  Test Pair: " << outer << ' ' << inner << '\n';
+			break;
+		}
+	}
+}
+
 
 // Add MCDC test pair to internal variable structures
 // Partly redundant storage of values
@@ -196,7 +256,7 @@ sint Mcdc::calculateScoreForOneTest(uint test) noexcept
 				break;
 			}
 			// An additional plus is a lower number of set bits in the test value
-			resultingScore += (MaxNumberOfBitsForEvaluation-numberOfSetBits(test));
+			resultingScore += (MaxNumberOfBitsForEvaluation - numberOfSetBitsInTestValue(test));
 		}
 	}
 	return resultingScore;
@@ -530,13 +590,23 @@ void Mcdc::generateTestSets()
 	}
 
 	// We went through all coverage sets
+	// If the search or the coverage analysis has been stopped, then the user shall know this
+	const bool resultIsPartial{ searchIsPartial || coverage.isPartialResult() };
+	if (resultIsPartial)
+	{
+		os << "\n\n*** Partial result. Time limit or maximum number of test pairs reached. Test sets may not be minimal or may not cover all conditions\n";
+	}
 	// Now we want to show the recomended test set to the user
 	printResult(allTestSets, os);
 
 	// If it has not yet been printed to cout, then print it anyway
 	if (!outStreamSelection.hasStdOut())
 	{
-		printResult(allTestSets, std::cout);
+		if (resultIsPartial)
+		{
+			OutputHandling::console() << "\n\n*** Partial result. Time limit or maximum number of test pairs reached. Test sets may not be minimal or may not cover all conditions\n";
+		}
+		printResult(allTestSets, OutputHandling::console());
 	}
 
 	// Done
@@ -547,7 +617,8 @@ McdcIndependencePair Mcdc::findBestResultingIndependencePair(TestVector& resulti
 {
 	uint bestSelectionIndex{ 0 };
 	uint bestCostSum{ 0 };
-	auto deltaBitCount = [](uint first, uint second) { return static_cast<uint>(MaxNumberOfBitsForEvaluation - std::abs(static_cast<int>(numberOfSetBits(first)) - static_cast<int>(numberOfSetBits(second)))); };
+	// Test values of the sampled search may differ in more bits than MaxNumberOfBitsForEvaluation. Then there is no bonus
+	auto deltaBitCount = [](uint first, uint second) { return static_cast<uint>(std::max(0, MaxNumberOfBitsForEvaluation - std::abs(numberOfSetBitsInTestValue(first) - numberOfSetBitsInTestValue(second)))); };
 	
 	//numberOfSetBits
 	
@@ -698,11 +769,11 @@ bool Mcdc::isMax1IndependencePairPerCondition()
 // Then number of combinations is (k(k-1)/2) with k being 2^(number of conditions)
 // After 2 AST have been evaluated we perform a tree xor to find the difference between 2 trees
 // And finally to check, if it is a valid MCDC test pair
+// The outer loop is split into ranges, which are checked by the tasks of the thread pool
+// The results of the tasks are merged in ascending order. So the result is the same as with one thread
 void Mcdc::findMcdcIndependencePairs(VirtualMachineForAST& ast)
 {
 
-	sint counter{ 0 };
-
 	sint counterUniqueCauseMCDC{ 0 };
 	sint counterUniqueCauseMaskingMCDC{ 0 };
 	sint counterMaskingMCDC{ 0 };
@@ -727,131 +798,154 @@ void Mcdc::findMcdcIndependencePairs(VirtualMachineForAST& ast)
 		osMcdc << "\n\n\n\n-------------------------------------------------- Searching for MCDC Test pairs \n\n\n";
 
 
-		// We will use this for calculating all AST for all possible test values
-		VirtualMachineForAST astForEvaluation{ ast };
-		// The we will tree XOR the 2 calculated AST to find out, if this is an influencing set
-		VirtualMachineForAST astInfluenceSet{ ast };
+		// We will calculate the values of all nodes of the AST for all possible test values
+		// Not a copy of the AST per test value, but one truth table per node. Evaluated 64 test values at a time
+		// Not needed for the sampled search
+		const bool sampledSearch{ programOption.option[ProgramOption::sample].optionSelected };
+		NodeValueMatrix nodeValueMatrix;
+		if (!sampledSearch)
+		{
+			nodeValueMatrix.calculate(ast, maxConditions, programOption.option[ProgramOption::bse].optionSelected);
+		}
 
 		// Calculate maximum number of possible tests. We will compare everything with the other 
-		const uint maxLoop{ static_cast<uint>(1U << static_cast<uint>(maxConditions)) };
-		// Number of nodes in the AST	
-		const uint astSize{ narrow_cast<uint>(astInfluenceSet.ast.size()) };
+		const uint maxLoop{ sampledSearch ? (1U << maxConditions) : nodeValueMatrix.getNumberOfInputValues() };
 
-		// We will calculate results for the AST for all possible test values
-		std::vector<VirtualMachineForAST> astPreEvaluated;
-		astPreEvaluated.reserve(maxLoop);	// Wow, what a waste of memory
+		// Text output is only needed, if it goes somewhere
+		const bool withOutput{ !outStreamSelection.isNull() };
 
-		// For all possible test values, depending on the number of conditions
-		for (uint i = 0U; i < maxLoop; ++i)
+		// The user may limit the number of test pairs. The value has been checked already
+		uint maxNumberOfTestPairs{ UINT_MAX };
+		if (programOption.option[ProgramOption::mp].optionSelected)
 		{
-			static_cast<void>(astForEvaluation.evaluateTree(i));		// EValuate the result
-			astPreEvaluated.push_back(astForEvaluation);	// And store it for later reference
+			maxNumberOfTestPairs = narrow_cast<uint>(programOption.getNumericParameter(ProgramOption::mp));
 		}
+		uint numberOfFoundTestPairs{ 0U };
 
-
-		// Check all possible test pairs, if they have an influencing condition
-		for (uint outer = 0U; outer < (maxLoop - 1); ++outer)
+		// Add the result of one range to the overall result. Must be called in ascending order of the ranges
+		// The text output has already been written
+		const auto mergeResult = [&](const TestVector& foundTestPairs)
 		{
-			for (uint inner = outer + 1; inner < maxLoop; inner++)
+			// Save the test values for further processing
+			for (const McdcIndependencePair& mcdcIndependencePair : foundTestPairs)
 			{
-				// Perform TREE XOR. To be able to check, what conditions and what operators changed values
-				// Tree exor means: we perfrom an XOR for every node in the AST
-				// If we have a not evaluated node, then the result is 0
-				// With that, we can check, what values (nodes) changed between 2 test pairs
-				// The result of this activity is the "influence tree"
-				// It is not important, if the source values were 0.
-				// If the complete path, starting from the condition to the root, is all true,
-				// than the condition has an influence.
-				// If only one condition changes (only one condition is true) and this is an influencing condition
-				// then we have unique cause MCDC. If more conditions changed, but only one of them is in an
-				// influencing path, then we have masking MCDC
-				// For strongly coupled conditions (meaningm the same condition is in the AST more than one)
-				// Unique cause is per definition not possible.
-				// If only one of the multiple same conditions is part of the influencing path, 
-				// then we talk about Unique+Maskin MCDC
-				for (uint i = 0; i < astSize; ++i)
-				{
-					astInfluenceSet.ast[i].value = (astPreEvaluated[outer].ast[i].value != astPreEvaluated[inner].ast[i].value) &&
-						!astPreEvaluated[outer].ast[i].notEvaluated &&
-						!astPreEvaluated[inner].ast[i].notEvaluated;
-				}
-	
-				// Now check the influence tree. And determine the type of MCDC (if any) and the influcening condition for this test pair
-				const auto [mcdcType, influencingCondition] = getMcdcType(astInfluenceSet.ast);
-
-
-				// Now, depending on the found MCDC type or if MCDC at all
-				// Inform the user about what we found
-				// And save the test values for further processing
-				switch (mcdcType)
+				const uint outer{ mcdcIndependencePair.independencePair.first };
+				const uint inner{ mcdcIndependencePair.independencePair.second };
+				switch (mcdcIndependencePair.mcdcType)
 				{
 				case McdcType::UniqueCause:
-					if (!programOption.option[ProgramOption::dnpast].optionSelected)
-					{
-						osMcdc << "\n----------------------- Found   Unique Cause          MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
-					}
 					testSetUniqueCauseMCDC.insert(outer);
 					testSetUniqueCauseMCDC.insert(inner);
 					++counterUniqueCauseMCDC;
 					break;
 				case McdcType::UniqueCauseMasking:
-					if (!programOption.option[ProgramOption::dnpast].optionSelected)
-					{
-						osMcdc << "\n----------------------- Found   Unique Cause+Masking  MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
-					}
 					testSetUniqueCauseMaskingMCDC.insert(outer);
 					testSetUniqueCauseMaskingMCDC.insert(inner);
 					++counterUniqueCauseMaskingMCDC;
 					break;
 				case McdcType::Masking:
-					if (!programOption.option[ProgramOption::dnpast].optionSelected)
-					{
-						osMcdc << "\n----------------------- Found   Masking               MCDC Test pair for condition: " << influencingCondition << "     Test Pair: " << outer << ' ' << inner << '\n';
-					}
 					testSetMaskingMCDC.insert(outer);
 					testSetMaskingMCDC.insert(inner);
 					++counterMaskingMCDC;
 					break;
 				case McdcType::NONE: //fallthrough
 				default:
-					if (!programOption.option[ProgramOption::dnpast].optionSelected)
-					{
-						osMcdc << "....................... Could not be identified as MCDC of any type.  Test Pair: " << outer << ' ' << inner << '\n';
-					}
 					break;
 				}
+				// Then we add it to all internal containers
+				add(mcdcIndependencePair);
+				++numberOfFoundTestPairs;
+			}
+		};
+
+		// Split the outer loop into ranges. The number of test pairs for one outer value is roughly maxLoop
+		// In unique cause fast mode, it is the number of conditions. Then the ranges are whole words of the node value matrix,
+		// because the classification is done for 64 outer values at the same time
+		const bool uniqueCauseFastMode{ programOption.option[ProgramOption::ucf].optionSelected };
+		const uint testPairsPerTask{ (withOutput && !programOption.option[ProgramOption::dnpast].optionSelected) ? NumberOfTestPairsPerTaskWithOutput : NumberOfTestPairsPerTask };
+		const uint testPairsPerOuterValue{ uniqueCauseFastMode ? std::max(maxConditions, 1U) : maxLoop };
+		uint outerValuesPerTask{ (testPairsPerOuterValue >= testPairsPerTask) ? 1U : (testPairsPerTask / testPairsPerOuterValue) };
+		if (uniqueCauseFastMode)
+		{
+			outerValuesPerTask = ((outerValuesPerTask + NumberOfBitSlicedLanes - 1U) / NumberOfBitSlicedLanes) * NumberOfBitSlicedLanes;
+		}
+		const uint numberOfTasks{ ((maxLoop - 1U) + outerValuesPerTask - 1U) / outerValuesPerTask };
 
-				// If we have a valid MCDC Test Pair
-				if (McdcType::NONE != mcdcType)
+		if (sampledSearch)
+		{
+			// Random test pairs. The sampled search uses the thread pool itself
+			TestVector foundTestPairs;
+			searchIsPartial = !findMcdcIndependencePairsSampled(maxConditions, withOutput, osMcdc, foundTestPairs, maxNumberOfTestPairs);
+			mergeResult(foundTestPairs);
+		}
+		else if (!nodeValueMatrix.isComplete())
+		{
+			// The time was over, while the node values have been calculated. Nothing can be searched
+			searchIsPartial = true;
+		}
+		// With a per condition quota, the search depends on the test pairs found before. So it is always done in one task
+		else if ((numberOfTasks > 1U) && (threadPool.getNumberOfThreads() > 1U) && !programOption.option[ProgramOption::quota].optionSelected)
+		{
+			// Results of the tasks. Will be merged in ascending order
+			std::vector<McdcSearchResult> mcdcSearchResult(numberOfTasks);
+			// The text output of each task goes into its own part of the sink. The sink writes the parts in the order of the tasks
+			// Writing to the files or the console is done by the writer thread of the sink, while the search continues
+			OutputHandling::OrderedOutputSink outputSink(osMcdc);
+			// Not all tasks are submitted at once. Only so many results may be calculated in advance. This limits the memory consumption
+			threadPool.parallelForOrdered(numberOfTasks,
+				[this, outerValuesPerTask, maxLoop, &nodeValueMatrix, withOutput, &mcdcSearchResult, &outputSink, maxNumberOfTestPairs](uint task)
 				{
-					// Then we add it to all internal containers
-					add(McdcIndependencePair(mcdcType, outer, inner, influencingCondition));
-					// And show 3 ASTs
-					if (!outStreamSelection.isNull() && !programOption.option[ProgramOption::dnpast].optionSelected)
+					const uint outerBegin{ task * outerValuesPerTask };
+					const uint outerEnd{ std::min(outerBegin + outerValuesPerTask, maxLoop - 1U) };
+					McdcSearchResult& result{ mcdcSearchResult[task] };
+					result.rangeComplete = findMcdcIndependencePairsForRange(outerBegin, outerEnd, nodeValueMatrix, withOutput, outputSink.part(task), result.mcdcIndependencePair, maxNumberOfTestPairs);
+				},
+				// Merge the results in sequence
+				[&](uint task)
+				{
+					bool rangeComplete{ mcdcSearchResult[task].rangeComplete };
+					if ((numberOfFoundTestPairs + mcdcSearchResult[task].mcdcIndependencePair.size()) >= maxNumberOfTestPairs)
 					{
-						++counter;
-						osMcdc << "\n-------------------------------------- AST for value: " << outer << "\n\n";
-						astPreEvaluated[outer].printTree(osMcdc);
-						osMcdc << "\n-------------------------------------- AST for value: " << inner << "\n\n";
-						astPreEvaluated[inner].printTree(osMcdc);
-						osMcdc << "\n-------------------------------------- AST for influencing condition check\n\n";
-						astInfluenceSet.printTree(osMcdc);
-						osMcdc << "\n\n";
+						// The maximum number of test pairs will be reached in this range. The task did not know, how many test pairs
+						// have been found before. Repeat the search for this range with the remaining number of test pairs
+						// So the search stops at exactly the same test pair as with one thread. The output of the task is replaced
+						const uint outerBegin{ task * outerValuesPerTask };
+						const uint outerEnd{ std::min(outerBegin + outerValuesPerTask, maxLoop - 1U) };
+						std::ostringstream& output{ outputSink.part(task) };
+						output.str(std::string());
+						TestVector foundTestPairs;
+						rangeComplete = findMcdcIndependencePairsForRange(outerBegin, outerEnd, nodeValueMatrix, withOutput, output, foundTestPairs, maxNumberOfTestPairs - numberOfFoundTestPairs);
+						mergeResult(foundTestPairs);
 					}
-				}
-				else if (!outStreamSelection.isNull() && programOption.option[ProgramOption::paast].optionSelected && !programOption.option[ProgramOption::dnpast].optionSelected)
-				{
-					// It is alsa possible to show all ASTs regardless if they are MCDC pair or not. Controlled via command line
-					// That is the case here
-					osMcdc << "\n-------------------------------------- AST for value: " << outer << "\n\n";
-					astPreEvaluated[outer].printTree(osMcdc);
-					osMcdc << "\n-------------------------------------- AST for value: " << inner << "\n\n";
-					astPreEvaluated[inner].printTree(osMcdc);
-					osMcdc << "\n-------------------------------------- AST for influencing condition check\n\n";
-					astInfluenceSet.printTree(osMcdc);
-					osMcdc << "\n\n";
-				}
+					else
+					{
+						mergeResult(mcdcSearchResult[task].mcdcIndependencePair);
+					}
+					// The output of this range may be written now
+					outputSink.complete(task);
+					// Stop, if the maximum number of test pairs has been found or if the time was over
+					searchIsPartial = !rangeComplete;
+					// Free the memory of the merged result
+					mcdcSearchResult[task] = McdcSearchResult();
+					return !searchIsPartial;
+				});
+			// Write the remaining output. The output of ranges after the stop will be discarded. Then osMcdc may be used again
+			outputSink.finish();
+		}
+		else
+		{
+			// No multitasking. Check all test pairs at once. The output goes directly to the stream
+			TestVector foundTestPairs;
+			searchIsPartial = !findMcdcIndependencePairsForRange(0U, maxLoop - 1U, nodeValueMatrix, withOutput, osMcdc, foundTestPairs, maxNumberOfTestPairs);
+			mergeResult(foundTestPairs);
+		}
 
+		if (searchIsPartial)
+		{
+			osMcdc << "\n\n*** Partial result. Search for MC/DC test pairs stopped after " << numberOfFoundTestPairs << " test pairs (time limit or maximum number of test pairs reached)\n";
+			if (!outStreamSelection.hasStdOut())
+			{
+				OutputHandling::console() << "\n\n*** Partial result. Search for MC/DC test pairs stopped after " << numberOfFoundTestPairs << " test pairs (time limit or maximum number of test pairs reached)\n";
 			}
 		}
 
@@ -895,136 +989,595 @@ void Mcdc::findMcdcIndependencePairs(VirtualMachineForAST& ast)
 
 
 
-// Get tree xored AST and check, if we have at all, anf if what MCDC type
-// It is not important, if the source values were 0.
-// If the complete path, starting from the condition to the root, is all true,
-// than the condition has an influence.
-// If only one condition changes (only one condition is true) and this is an influencing condition
-// then we have unique cause MCDC. If more conditions changed, but only one of them is in an
-// influencing path, then we have masking MCDC
-// For strongly coupled conditions (meaningm the same condition is in the AST more than one)
-// Unique cause is per definition not possible.
-// If only one of the multiple same conditions is part of the influencing path, 
-// then we talk about Unique+Masking MCDC
-
-std::pair<McdcType, cchar> Mcdc::getMcdcType(AST& astInfluencingTree)
+// Check all test pairs for a range of outer test values
+// This is the inner part of the brute force search. It is executed by the tasks of the thread pool
+// The node value matrix and the Mcdc object are only read. The influence classifier is local
+// One outer test value is checked against 64 inner test values at a time. See InfluenceClassifier
+// Found test pairs and the text output are stored in the search result of this range
+bool Mcdc::findMcdcIndependencePairsForRange(uint outerBegin, uint outerEnd, const NodeValueMatrix& nodeValueMatrix, bool withOutput, std::ostream& os, TestVector& foundTestPairs, uint maxNumberOfTestPairs) const
 {
-	// For function result
-	McdcType resultingMcdcType{ McdcType::NONE };
-	cchar lastInfluencingSymbol{ ' ' };
-	constexpr uint MaxIndexForTerminal{ static_cast<uint>('z') + 1U };
+	// Word parallel classification of test pairs
+	InfluenceClassifier influenceClassifier(astUsedForMcdcCalculation.ast, nodeValueMatrix);
+	// The influence tree is only needed for printing. We will tree XOR the 2 calculated AST for that
+	VirtualMachineForAST astInfluenceSet{ astUsedForMcdcCalculation };
+	// For printing the evaluated ASTs. The values are copied from the node value matrix
+	VirtualMachineForAST astForPrinting{ astUsedForMcdcCalculation };
+	// Calculate maximum number of possible tests. We will compare everything with the other 
+	const uint maxLoop{ nodeValueMatrix.getNumberOfInputValues() };
+	// Number of nodes in the AST	
+	const uint astSize{ narrow_cast<uint>(astInfluenceSet.ast.size()) };
+
+	// Text for every test pair and ASTs for MCDC test pairs
+	const bool withTestPairOutput{ withOutput && !programOption.option[ProgramOption::dnpast].optionSelected };
+	// ASTs also for test pairs that are not MCDC
+	const bool withAllAstOutput{ withTestPairOutput && programOption.option[ProgramOption::paast].optionSelected };
+
+	// Print the ASTs of a test pair and the influence tree
+	const auto printAsts = [&](const uint outer, const uint inner)
+	{
+		// Perform TREE XOR. To be able to check, what conditions and what operators changed values
+		// Tree exor means: we perfrom an XOR for every node in the AST
+		// If we have a not evaluated node, then the result is 0
+		// The result of this activity is the "influence tree"
+		for (uint i = 0; i < astSize; ++i)
+		{
+			const bool changed{ (nodeValueMatrix.value(i, outer) != nodeValueMatrix.value(i, inner)) &&
+				!nodeValueMatrix.notEvaluated(i, outer) &&
+				!nodeValueMatrix.notEvaluated(i, inner) };
+			astInfluenceSet.setNodeResult(i, changed, false);
+		}
+		os << "\n-------------------------------------- AST for value: " << outer << "\n\n";
+		nodeValueMatrix.copyTo(astForPrinting, outer);
+		astForPrinting.printTree(os);
+		os << "\n-------------------------------------- AST for value: " << inner << "\n\n";
+		nodeValueMatrix.copyTo(astForPrinting, inner);
+		astForPrinting.printTree(os);
+		os << "\n-------------------------------------- AST for influencing condition check\n\n";
+		astInfluenceSet.printTree(os);
+		os << "\n\n";
+	};
 
-	// We need to count, how often a condition is present in the influencing tree
-	uint countOfOneModfiedPerVariable[MaxIndexForTerminal];
-	std::memset(&countOfOneModfiedPerVariable[0], 0, sizeof(countOfOneModfiedPerVariable));
+	// Inform the user about a checked test pair and store it, if it is a valid MCDC test pair
+	const auto handleTestPair = [&](const uint outer, const uint inner, const McdcType mcdcType, const cchar influencingCondition)
+	{
+		// Now, depending on the found MCDC type or if MCDC at all
+		// Inform the user about what we found
+		// And save the test values for the merge
+		if (withTestPairOutput)
+		{
+			showTestPair(os, mcdcType, influencingCondition, outer, inner);
+		}
 
-	// For Masking we need to count all modified conditions
-	uint modifiedCondition{ 0U };
-	// And, how often an influencing symbol is present
-	uint influencingSymbolCounter{ 0U };
+		// If we have a valid MCDC Test Pair
+		if (McdcType::NONE != mcdcType)
+		{
+			// Then we store it for the merge
+			foundTestPairs.emplace_back(McdcIndependencePair(mcdcType, outer, inner, influencingCondition));
+			// And show 3 ASTs
+			if (withTestPairOutput)
+			{
+				printAsts(outer, inner);
+			}
+		}
+		else if (withAllAstOutput)
+		{
+			// It is alsa possible to show all ASTs regardless if they are MCDC pair or not. Controlled via command line
+			// That is the case here
+			printAsts(outer, inner);
+		}
+	};
 
-	bool oneInfluencingPathFound{ false }; // Check if at least one influencing path is available
-	const uint astSize{ narrow_cast<uint> (astInfluencingTree.size()) };
+	// Will be set, if the search is stopped before all test pairs have been checked
+	bool rangeComplete{ true };
 
-	// Check the complete influencing tree
-	for (uint i = 0; i < astSize; ++i)
+	// Per condition quota. Only so many test pairs for each condition are searched
+	const uint quota{ narrow_cast<uint>(programOption.getNumericParameter(ProgramOption::quota)) };
+	if (quota > 0U)
 	{
-		// Reference to current node
-		const AstNode& astNode{ astInfluencingTree[i] };
-
-		// Is this a leaf, meaning do we have a condition here
-		// A condition would be the staring point for a path analysis
-		if ((NumberOfChildren::zero == astNode.numberOfChildren) && astNode.value)
+		// Number of found test pairs for each condition and each MC/DC type. A condition that is never observable
+		// can never be the influencing condition of an MC/DC test pair. It is not searched at all
+		// A condition is searched, until quota unique cause test pairs have been found. Test pairs of a lower type
+		// are stored only up to the quota. They are used, if there is no test pair of a better type
+		struct QuotaOfCondition
+		{
+			std::array<uint, 3U> pairsFound{};
+			bool searched{ true };
+		};
+		std::map<cchar, QuotaOfCondition> quotaOfCondition{};
+		for (const uint index : nodeValueMatrix.getNodeIndexPostOrder())
+		{
+			const AstNode& node{ astUsedForMcdcCalculation.ast[index] };
+			if (NumberOfChildren::zero == node.numberOfChildren)
+			{
+				bool isObservable{ false };
+				for (uint wordIndex = 0U; ((wordIndex * NumberOfBitSlicedLanes) < maxLoop) && !isObservable; ++wordIndex)
+				{
+					const uint lanesInWord{ std::min(maxLoop - (wordIndex * NumberOfBitSlicedLanes), NumberOfBitSlicedLanes) };
+					const BitSlicedRegisterType usedLanes{ (lanesInWord >= NumberOfBitSlicedLanes) ? ~null<BitSlicedRegisterType>() : ((static_cast<BitSlicedRegisterType>(1U) << lanesInWord) - 1U) };
+					isObservable = null<BitSlicedRegisterType>() != (nodeValueMatrix.observableWord(index, wordIndex) & usedLanes);
+				}
+				if (isObservable)
+				{
+					quotaOfCondition[node.tokenWithAttribute.inputSymbolLowerCase] = QuotaOfCondition();
+				}
+			}
+		}
+		uint conditionsStillNeeded{ narrow_cast<uint>(quotaOfCondition.size()) };
+		const auto isNeeded = [&](const cchar condition)
+		{
+			const std::map<cchar, QuotaOfCondition>::const_iterator it{ quotaOfCondition.find(condition) };
+			return (it != quotaOfCondition.cend()) && it->second.searched;
+		};
+		// Store a test pair, if its condition did not yet reach the quota for its type. Returns true, if the quota of
+		// unique cause test pairs has been reached now
+		const auto addTestPair = [&](const uint outer, const uint inner, const McdcType mcdcType, const cchar influencingCondition)
 		{
-			// Yes, Leaf. Read the condition. Only lowercase is important for counting
-			cchar inputTerminalSymbol{ astNode.tokenWithAttribute.inputSymbolLowerCase };
+			bool quotaReached{ false };
+			if (isNeeded(influencingCondition))
+			{
+				uint& pairsFound{ quotaOfCondition[influencingCondition].pairsFound[static_cast<uint>(mcdcType)] };
+				if (pairsFound < quota)
+				{
+					handleTestPair(outer, inner, mcdcType, influencingCondition);
+					++pairsFound;
+					if ((McdcType::UniqueCause == mcdcType) && (quota == pairsFound))
+					{
+						// Stop searching for this condition
+						quotaOfCondition[influencingCondition].searched = false;
+						influenceClassifier.excludeCondition(influencingCondition);
+						--conditionsStillNeeded;
+						quotaReached = true;
+					}
+				}
+			}
+			return quotaReached;
+		};
+		const uint numberOfInputBits{ astUsedForMcdcCalculation.symbolTable.numberOfSymbols() };
 
-			// Count the number of that condition that have value true. 
-			// That means the variable has been changed from on test to the other
-			++countOfOneModfiedPerVariable[inputTerminalSymbol];
+		// Good test pairs first: The test pairs with Hamming distance 1. So, mostly unique cause test pairs
+		// Same as in unique cause fast mode, but only for conditions that still need test pairs
+		for (uint wordIndex = 0U; ((wordIndex * NumberOfBitSlicedLanes) < maxLoop) && (conditionsStillNeeded > 0U) && rangeComplete; ++wordIndex)
+		{
+			// Stop, if the time is over
+			if (runBudget.isExhausted())
+			{
+				rangeComplete = false;
+				break;
+			}
+			for (uint inputBit = 0U; (inputBit < numberOfInputBits) && (conditionsStillNeeded > 0U) && rangeComplete; ++inputBit)
+			{
+				const cchar condition{ influenceClassifier.getConditionOfInputBit(inputBit) };
+				if (!isNeeded(condition))
+				{
+					continue;
+				}
+				influenceClassifier.classifyNeighbours(wordIndex, inputBit);
+				const BitSlicedRegisterType uniqueCause{ influenceClassifier.getUniqueCause() };
+				const BitSlicedRegisterType uniqueCauseMasking{ influenceClassifier.getUniqueCauseMasking() };
+				const BitSlicedRegisterType masking{ influenceClassifier.getMasking() };
+				// The unique cause test pairs of this word first, then the others
+				for (const BitSlicedRegisterType mcdcLanes : { uniqueCause, (uniqueCauseMasking | masking) & ~uniqueCause })
+				{
+					for (uint lane = 0U; (lane < NumberOfBitSlicedLanes) && isNeeded(condition) && rangeComplete; ++lane)
+					{
+						const uint outer{ (wordIndex * NumberOfBitSlicedLanes) + lane };
+						// The flipped bit must be 0 in outer. Otherwise the test pair has already been checked
+						if ((outer >= maxLoop) || (0U != ((outer >> inputBit) & 1U)) || (null<BitSlicedRegisterType>() == ((mcdcLanes >> lane) & 1U)))
+						{
+							continue;
+						}
+						// Stop, if we found enough test pairs
+						if (foundTestPairs.size() >= maxNumberOfTestPairs)
+						{
+							rangeComplete = false;
+							break;
+						}
+						addTestPair(outer, outer | (1U << inputBit), mcdcTypeOfLane(uniqueCause, uniqueCauseMasking, masking, lane), condition);
+					}
+				}
+			}
+		}
 
-			// Count overall number of modifed conditions, regardless, what condition is is
-			++modifiedCondition;
+		// Then all other test pairs for the conditions that still need test pairs. Not in unique cause fast mode
+		// Only candidates from the observability of the conditions are checked
+		for (uint outer = outerBegin; (outer < outerEnd) && (conditionsStillNeeded > 0U) && rangeComplete && !programOption.option[ProgramOption::ucf].optionSelected; ++outer)
+		{
+			// Stop, if the time is over
+			if (runBudget.isExhausted())
+			{
+				rangeComplete = false;
+				break;
+			}
+			bool hasObservableLeaves{ influenceClassifier.selectObservableLeaves(outer) };
+			const std::vector<uint>& innerWords{ nodeValueMatrix.getWordsWithOutcome(!nodeValueMatrix.outcome(outer)) };
+			for (std::vector<uint>::const_iterator innerWord = std::lower_bound(innerWords.cbegin(), innerWords.cend(), (outer + 1U) / NumberOfBitSlicedLanes); (innerWord != innerWords.cend()) && hasObservableLeaves && rangeComplete; ++innerWord)
+			{
+				// The test pairs with Hamming distance 1 have already been checked
+				BitSlicedRegisterType neighbours{ null<BitSlicedRegisterType>() };
+				for (uint inputBit = 0U; inputBit < numberOfInputBits; ++inputBit)
+				{
+					const uint neighbour{ outer ^ (1U << inputBit) };
+					if ((neighbour / NumberOfBitSlicedLanes) == *innerWord)
+					{
+						neighbours |= static_cast<BitSlicedRegisterType>(1U) << (neighbour % NumberOfBitSlicedLanes);
+					}
+				}
+				const BitSlicedRegisterType candidates{ influenceClassifier.getCandidates(*innerWord) & ~neighbours };
+				if (null<BitSlicedRegisterType>() == candidates)
+				{
+					continue;
+				}
+				influenceClassifier.classify(outer, *innerWord);
+				const BitSlicedRegisterType uniqueCause{ influenceClassifier.getUniqueCause() };
+				const BitSlicedRegisterType uniqueCauseMasking{ influenceClassifier.getUniqueCauseMasking() };
+				const BitSlicedRegisterType masking{ influenceClassifier.getMasking() };
+				const BitSlicedRegisterType mcdcLanes{ (uniqueCause | uniqueCauseMasking | masking) & candidates };
+
+				const uint firstInner{ std::max(outer + 1U, *innerWord * NumberOfBitSlicedLanes) };
+				const uint endInner{ std::min(maxLoop, (*innerWord + 1U) * NumberOfBitSlicedLanes) };
+				for (uint inner = firstInner; (inner < endInner) && hasObservableLeaves; ++inner)
+				{
+					const uint lane{ inner % NumberOfBitSlicedLanes };
+					if (null<BitSlicedRegisterType>() == ((mcdcLanes >> lane) & 1U))
+					{
+						continue;
+					}
+					// Stop, if we found enough test pairs
+					if (foundTestPairs.size() >= maxNumberOfTestPairs)
+					{
+						rangeComplete = false;
+						break;
+					}
+					// If a condition reached its quota, then the observable leaves of outer must be selected again
+					if (addTestPair(outer, inner, mcdcTypeOfLane(uniqueCause, uniqueCauseMasking, masking, lane), influenceClassifier.getInfluencingCondition(lane)))
+					{
+						hasObservableLeaves = influenceClassifier.selectObservableLeaves(outer);
+					}
+				}
+			}
+		}
 
-			// Check if the condition is influencing
-			// That means all true in a path up to the root node
-			uint indexNodeUnderEvaluation{ i };
-			bool pathIsTrue{ true };
-			do
+		// Inform the user about conditions that did not reach the quota with test pairs of their best type
+		if (rangeComplete)
+		{
+			std::string conditionsBelowQuota{};
+			for (const auto& [condition, quotaForCondition] : quotaOfCondition)
+			{
+				const std::array<uint, 3U>& pairsFound{ quotaForCondition.pairsFound };
+				const uint pairsOfBestType{ (pairsFound[0] > 0U) ? pairsFound[0] : ((pairsFound[1] > 0U) ? pairsFound[1] : pairsFound[2]) };
+				if (pairsOfBestType < quota)
+				{
+					conditionsBelowQuota += ' ';
+					conditionsBelowQuota += condition;
+				}
+			}
+			if (!conditionsBelowQuota.empty())
 			{
-				// All values along the path must be true. If not, we can terminate this loo´p
-				pathIsTrue = pathIsTrue && astInfluencingTree[indexNodeUnderEvaluation].value;
-				// Set next node to check to the parent of this node. So go up the path to the root
-				indexNodeUnderEvaluation = astInfluencingTree[indexNodeUnderEvaluation].parentID;
+				os << "\n*** Quota of " << quota << " test pairs per condition not reached for conditions:" << conditionsBelowQuota << '\n';
+			}
+		}
+		return rangeComplete;
+	}
 
-				// COntinue until we reached the root node and as long as all elements in the path are true
-			} while (pathIsTrue && (indexNodeUnderEvaluation != ASTNoLinkedElement));
+	if (programOption.option[ProgramOption::ucf].optionSelected)
+	{
+		// Unique cause fast mode. Unique cause test pairs differ always in exactly one condition
+		// So check only the test pairs (outer, outer with one flipped input bit). The flipped bit must be 0 in outer
+		// Otherwise the test pair has already been checked with the smaller test value as outer
+		// The classification is done for 64 outer values at the same time. One result per input bit
+		const uint numberOfInputBits{ astUsedForMcdcCalculation.symbolTable.numberOfSymbols() };
+		std::vector<BitSlicedRegisterType> neighbourUniqueCause(numberOfInputBits);
+		std::vector<BitSlicedRegisterType> neighbourUniqueCauseMasking(numberOfInputBits);
+		std::vector<BitSlicedRegisterType> neighbourMasking(numberOfInputBits);
+
+		for (uint outer = outerBegin; (outer < outerEnd) && rangeComplete; ++outer)
+		{
+			// Stop, if the time is over
+			if (runBudget.isExhausted())
+			{
+				rangeComplete = false;
+				break;
+			}
+			const uint lane{ outer % NumberOfBitSlicedLanes };
+			if ((outer == outerBegin) || (0U == lane))
+			{
+				// Next 64 outer test values. Check them against their neighbours for all input bits
+				for (uint inputBit = 0U; inputBit < numberOfInputBits; ++inputBit)
+				{
+					influenceClassifier.classifyNeighbours(outer / NumberOfBitSlicedLanes, inputBit);
+					neighbourUniqueCause[inputBit] = influenceClassifier.getUniqueCause();
+					neighbourUniqueCauseMasking[inputBit] = influenceClassifier.getUniqueCauseMasking();
+					neighbourMasking[inputBit] = influenceClassifier.getMasking();
+				}
+			}
+			// The inner test values in ascending order
+			for (uint inputBit = 0U; inputBit < numberOfInputBits; ++inputBit)
+			{
+				const uint inner{ outer | (1U << inputBit) };
+				if (inner == outer)
+				{
+					continue;
+				}
+				// Stop, if we found enough test pairs
+				if (foundTestPairs.size() >= maxNumberOfTestPairs)
+				{
+					rangeComplete = false;
+					break;
+				}
+				const McdcType mcdcType{ mcdcTypeOfLane(neighbourUniqueCause[inputBit], neighbourUniqueCauseMasking[inputBit], neighbourMasking[inputBit], lane) };
+				if (withTestPairOutput || (McdcType::NONE != mcdcType))
+				{
+					handleTestPair(outer, inner, mcdcType, (McdcType::NONE != mcdcType) ? influenceClassifier.getConditionOfInputBit(inputBit) : ' ');
+				}
+			}
+		}
+		return rangeComplete;
+	}
 
-			// OK, we found a comlte true path. So this condition is influencing
-			if (pathIsTrue)
+	// Check the test pairs of one outer test value with the 64 inner test values of one word of the node value matrix
+	const auto checkInnerWord = [&](const uint outer, const uint innerWordIndex)
+	{
+		// Stop, if we found enough test pairs
+		if (foundTestPairs.size() >= maxNumberOfTestPairs)
+		{
+			rangeComplete = false;
+			return;
+		}
+		// Now check the influence trees. And determine the type of MCDC (if any) for 64 test pairs
+		influenceClassifier.classify(outer, innerWordIndex);
+		const BitSlicedRegisterType uniqueCause{ influenceClassifier.getUniqueCause() };
+		const BitSlicedRegisterType uniqueCauseMasking{ influenceClassifier.getUniqueCauseMasking() };
+		const BitSlicedRegisterType masking{ influenceClassifier.getMasking() };
+		// Without output, only the MCDC test pairs are of interest
+		const BitSlicedRegisterType lanesToCheck{ withTestPairOutput ? ~null<BitSlicedRegisterType>() : (uniqueCause | uniqueCauseMasking | masking) };
+
+		const uint firstInner{ std::max(outer + 1U, innerWordIndex * NumberOfBitSlicedLanes) };
+		const uint endInner{ std::min(maxLoop, (innerWordIndex + 1U) * NumberOfBitSlicedLanes) };
+		for (uint inner = firstInner; inner < endInner; ++inner)
+		{
+			const uint lane{ inner % NumberOfBitSlicedLanes };
+			// No more interesting test pairs in this word
+			if (null<BitSlicedRegisterType>() == (lanesToCheck >> lane))
+			{
+				break;
+			}
+			if (null<BitSlicedRegisterType>() == ((lanesToCheck >> lane) & 1U))
 			{
-				// Count all influencing conditions
-				++influencingSymbolCounter;
+				continue;
+			}
+
+			const McdcType mcdcType{ mcdcTypeOfLane(uniqueCause, uniqueCauseMasking, masking, lane) };
+			handleTestPair(outer, inner, mcdcType, (McdcType::NONE != mcdcType) ? influenceClassifier.getInfluencingCondition(lane) : ' ');
 
-				// And remember the name of the condition
-				// If there is only one influencing variable in the whole tree, then this it is
-				// This is important to detect the type of MCDC
-				lastInfluencingSymbol = inputTerminalSymbol;
+			// Stop, if we found enough test pairs and there are more test pairs to check in this range
+			if ((McdcType::NONE != mcdcType) && (foundTestPairs.size() >= maxNumberOfTestPairs) && (((inner + 1U) < maxLoop) || (((outer + 1U) < outerEnd) && ((outer + 2U) < maxLoop))))
+			{
+				rangeComplete = false;
+				break;
 			}
-			// So, note, if at least one influencing path could be found
-			oneInfluencingPathFound = oneInfluencingPathFound || pathIsTrue;
 		}
+	};
 
-	}
-
-	// There was at least one influencing path. So it could be MCDC
-	if (oneInfluencingPathFound)
+	for (uint outer = outerBegin; (outer < outerEnd) && rangeComplete; ++outer)
 	{
-		// Sum up all modified conditions from the per condition count
-		uint overallModifiedVariables{ 0 };
-		for (uint i = 0; i < MaxIndexForTerminal; ++i)
+		// Stop, if the time is over
+		if (runBudget.isExhausted())
 		{
-			overallModifiedVariables += countOfOneModfiedPerVariable[i];
+			rangeComplete = false;
+			break;
 		}
+		const uint firstInnerWordIndex{ (outer + 1U) / NumberOfBitSlicedLanes };
+		if (withTestPairOutput)
+		{
+			// All inner test values greater than outer. 64 at a time. Also the pairs with the same outcome will be shown
+			for (uint innerWordIndex = firstInnerWordIndex; ((innerWordIndex * NumberOfBitSlicedLanes) < maxLoop) && rangeComplete; ++innerWordIndex)
+			{
+				checkInnerWord(outer, innerWordIndex);
+			}
+		}
+		else
+		{
+			// Stop, if we found enough test pairs. There are more test pairs, but they may be skipped below
+			if (foundTestPairs.size() >= maxNumberOfTestPairs)
+			{
+				rangeComplete = false;
+				break;
+			}
+			// If no condition is observable for the outer test value, then it cannot be part of an MCDC test pair
+			if (!influenceClassifier.selectObservableLeaves(outer))
+			{
+				continue;
+			}
+			// Only test pairs with a different outcome can be MCDC test pairs. So check only the words that contain
+			// inner test values with the opposite outcome of the outer test value
+			const std::vector<uint>& innerWords{ nodeValueMatrix.getWordsWithOutcome(!nodeValueMatrix.outcome(outer)) };
+			for (std::vector<uint>::const_iterator innerWord = std::lower_bound(innerWords.cbegin(), innerWords.cend(), firstInnerWordIndex); (innerWord != innerWords.cend()) && rangeComplete; ++innerWord)
+			{
+				// And only the words, where an observable condition of the outer test value is also observable and changed
+				if (null<BitSlicedRegisterType>() != influenceClassifier.getCandidates(*innerWord))
+				{
+					checkInnerWord(outer, *innerWord);
+				}
+			}
+		}
+	}
+	return rangeComplete;
+}
 
 
-		// Evaluation:
 
-		// Precondition for MCDC is:
+// Sampled search for MC/DC test pairs. For decisions with many conditions, where checking all test pairs takes too long
+bool Mcdc::findMcdcIndependencePairsSampled(uint numberOfConditions, bool withOutput, std::ostream& os, TestVector& foundTestPairs, uint maxNumberOfTestPairs) const
+{
+	// Number of random test pairs to check and seed of the random numbers. The values have been checked already
+	const uint numberOfSamples{ narrow_cast<uint>(programOption.getNumericParameter(ProgramOption::sample)) };
+	uint64 seed{ 1U };
+	if (programOption.option[ProgramOption::seed].optionSelected)
+	{
+		seed = programOption.getNumericParameter(ProgramOption::seed);
+	}
+	// The sequence of the Mersenne Twister is defined by the standard. So the same seed gives the same test pairs on all platforms
+	std::mt19937_64 randomNumber{ seed };
 
-		// There must be only one influencing variable --> Masking MCDC
-		// If additionally only one variable changed value --> Unique Cause MCDC
+	const bool withTestPairOutput{ withOutput && !programOption.option[ProgramOption::dnpast].optionSelected };
+	const bool booleanShortCutEvaluation{ programOption.option[ProgramOption::bse].optionSelected };
+	const uint inputMask{ (numberOfConditions >= (sizeof(uint) * 8U)) ? UINT_MAX : ((1U << numberOfConditions) - 1U) };
 
-		// For strongly coupled variables (e.g Variable appears mor than one time in a boolean expression)
-		// masking is allowed for that variable. That means the strongly coupled variable may have
-		// several truth values in the influence set
+	// The name of the condition for each input bit. An input bit without condition needs no test pair
+	std::vector<cchar> conditionOfInputBit(numberOfConditions, ' ');
+	for (const AstNode& node : astUsedForMcdcCalculation.ast)
+	{
+		if ((Token::ID == node.tokenWithAttribute.token) || (Token::IDNOT == node.tokenWithAttribute.token))
+		{
+			for (uint inputBit = 0U; inputBit < numberOfConditions; ++inputBit)
+			{
+				if (0U != (node.tokenWithAttribute.sourceMask & (1U << inputBit)))
+				{
+					conditionOfInputBit[inputBit] = node.tokenWithAttribute.inputSymbolLowerCase;
+				}
+			}
+		}
+	}
+	std::vector<bool> inputBitCovered(numberOfConditions, false);
+	uint inputBitsWithoutTestPair{ 0U };
+	for (uint inputBit = 0U; inputBit < numberOfConditions; ++inputBit)
+	{
+		inputBitCovered[inputBit] = (' ' == conditionOfInputBit[inputBit]);
+		inputBitsWithoutTestPair += inputBitCovered[inputBit] ? 0U : 1U;
+	}
 
-		// Check for MCDC
+	// The test pairs are checked in rounds. One round has at most so many words with 64 test pairs each
+	constexpr uint TestPairWordsPerRound{ 64U };
+	// Every test pair is only reported once
+	std::set<std::pair<uint, uint>> knownTestPairs{};
+	NodeValueMatrix nodeValueMatrix;
+	uint numberOfCheckedTestPairs{ 0U };
+	uint nextInputBit{ 0U };
+	bool searchComplete{ true };
 
-		// There must be only one influencing variable
-		if (1U == influencingSymbolCounter)
+	while ((numberOfCheckedTestPairs < numberOfSamples) && (inputBitsWithoutTestPair > 0U) && searchComplete)
+	{
+		// Stop, if the time is over
+		if (runBudget.isExhausted())
+		{
+			searchComplete = false;
+			break;
+		}
+		// Select the random test pairs for this round. The first test value is random. For the second test value one
+		// condition without test pair is flipped. For every second test pair, also some other random conditions are flipped.
+		// The outer test values of 64 test pairs are in one word of the node value matrix, the inner test values in the next word
+		// Exactly numberOfSamples test pairs are checked. In the last word of the last round, the unused lanes are ignored
+		const uint testPairsInRound{ std::min(TestPairWordsPerRound * NumberOfBitSlicedLanes, numberOfSamples - numberOfCheckedTestPairs) };
+		const uint wordsInRound{ (testPairsInRound + NumberOfBitSlicedLanes - 1U) / NumberOfBitSlicedLanes };
+		std::vector<uint> inputValue(static_cast<std::size_t>(wordsInRound) * 2U * NumberOfBitSlicedLanes, 0U);
+		for (uint testPair = 0U; testPair < testPairsInRound; ++testPair)
+		{
+			while (inputBitCovered[nextInputBit])
+			{
+				nextInputBit = (nextInputBit + 1U) % numberOfConditions;
+			}
+			uint flippedBits{ 1U << nextInputBit };
+			if (0U != (testPair & 1U))
+			{
+				// Each other condition is flipped with a probability of 1/4
+				flippedBits |= narrow_cast<uint>(randomNumber() & randomNumber()) & inputMask;
+			}
+			const uint outer{ narrow_cast<uint>(randomNumber()) & inputMask };
+			const std::size_t outerIndex{ ((static_cast<std::size_t>(testPair) / NumberOfBitSlicedLanes) * 2U * NumberOfBitSlicedLanes) + (testPair % NumberOfBitSlicedLanes) };
+			inputValue[outerIndex] = outer;
+			inputValue[outerIndex + NumberOfBitSlicedLanes] = outer ^ flippedBits;
+			nextInputBit = (nextInputBit + 1U) % numberOfConditions;
+		}
+		nodeValueMatrix.calculate(astUsedForMcdcCalculation, inputValue, booleanShortCutEvaluation);
+		if (!nodeValueMatrix.isComplete())
 		{
-			// Unique cause MCDC. Exactly one influencing condition / exactly one modified condition
-			if (1 == modifiedCondition)
+			searchComplete = false;
+			break;
+		}
+
+		// Classify the test pairs in parallel. The results of each word are merged in ascending order. So the result does not
+		// depend on the number of threads
+		std::vector<TestVector> roundResult(wordsInRound);
+		threadPool.parallelFor(0U, wordsInRound, 1U, [this, &nodeValueMatrix, &inputValue, &roundResult, testPairsInRound](uint begin, uint end)
 			{
-				resultingMcdcType = McdcType::UniqueCause;
+				InfluenceClassifier influenceClassifier(astUsedForMcdcCalculation.ast, nodeValueMatrix);
+				for (uint pairWordIndex = begin; pairWordIndex < end; ++pairWordIndex)
+				{
+					influenceClassifier.classifyPairs(2U * pairWordIndex, (2U * pairWordIndex) + 1U);
+					const BitSlicedRegisterType uniqueCause{ influenceClassifier.getUniqueCause() };
+					const BitSlicedRegisterType uniqueCauseMasking{ influenceClassifier.getUniqueCauseMasking() };
+					const BitSlicedRegisterType masking{ influenceClassifier.getMasking() };
+					const uint lanesInWord{ std::min(testPairsInRound - (pairWordIndex * NumberOfBitSlicedLanes), NumberOfBitSlicedLanes) };
+					for (uint lane = 0U; lane < lanesInWord; ++lane)
+					{
+						const McdcType mcdcType{ mcdcTypeOfLane(uniqueCause, uniqueCauseMasking, masking, lane) };
+						if (McdcType::NONE != mcdcType)
+						{
+							// Smaller test value first. Same as in the exhaustive search
+							const std::size_t outerIndex{ (static_cast<std::size_t>(pairWordIndex) * 2U * NumberOfBitSlicedLanes) + lane };
+							const uint first{ std::min(inputValue[outerIndex], inputValue[outerIndex + NumberOfBitSlicedLanes]) };
+							const uint second{ std::max(inputValue[outerIndex], inputValue[outerIndex + NumberOfBitSlicedLanes]) };
+							roundResult[pairWordIndex].emplace_back(McdcIndependencePair(mcdcType, first, second, influenceClassifier.getInfluencingCondition(lane)));
+						}
+					}
+				}
+			});
+		numberOfCheckedTestPairs += testPairsInRound;
 
+		// Merge the results of this round
+		for (const TestVector& testPairsOfWord : roundResult)
+		{
+			for (const McdcIndependencePair& mcdcIndependencePair : testPairsOfWord)
+			{
+				// Stop, if we found enough test pairs
+				if (foundTestPairs.size() >= maxNumberOfTestPairs)
+				{
+					searchComplete = false;
+					break;
+				}
+				if (!knownTestPairs.insert(mcdcIndependencePair.independencePair).second)
+				{
+					continue;
+				}
+				foundTestPairs.push_back(mcdcIndependencePair);
+				if (withTestPairOutput)
+				{
+					showTestPair(os, mcdcIndependencePair.mcdcType, mcdcIndependencePair.influencingCondition, mcdcIndependencePair.independencePair.first, mcdcIndependencePair.independencePair.second);
+				}
+				// The condition has a test pair now
+				for (uint inputBit = 0U; inputBit < numberOfConditions; ++inputBit)
+				{
+					if (!inputBitCovered[inputBit] && (mcdcIndependencePair.influencingCondition == conditionOfInputBit[inputBit]))
+					{
+						inputBitCovered[inputBit] = true;
+						--inputBitsWithoutTestPair;
+					}
+				}
 			}
-			// Unique Cause + Masking MCDC
-			// Only one influencing condition. But more modified condition. and thos all of the same name.
-			else if ((1 < modifiedCondition) && (1 < countOfOneModfiedPerVariable[lastInfluencingSymbol]) && (countOfOneModfiedPerVariable[lastInfluencingSymbol] == overallModifiedVariables))
+			if (!searchComplete)
 			{
-				resultingMcdcType = McdcType::UniqueCauseMasking;
+				break;
 			}
-			// Masking
-			// Only one influencing condition. But more different modified conditions
-			else if (1 < modifiedCondition)
+		}
+	}
+
+	// Inform the user about the conditions that have no test pair
+	os << "\n*** Sampled search. " << numberOfCheckedTestPairs << " random test pairs checked (seed " << seed << "). ";
+	if (0U == inputBitsWithoutTestPair)
+	{
+		os << "MC/DC test pairs found for all conditions\n";
+	}
+	else
+	{
+		os << "No MC/DC test pair found for conditions:";
+		for (uint inputBit = 0U; inputBit < numberOfConditions; ++inputBit)
+		{
+			if (!inputBitCovered[inputBit])
 			{
-				resultingMcdcType = McdcType::Masking;
+				os << ' ' << conditionOfInputBit[inputBit];
 			}
 		}
+		os << '\n';
 	}
-	// Now we kno the type and the influencing condition
-	return std::make_pair(resultingMcdcType, lastInfluencingSymbol);
+	return searchComplete;
 }
-
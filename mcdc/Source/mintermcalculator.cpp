@@ -51,14 +51,17 @@
 //
 // The boolean function a+b (a or b) has the Minterms: 1,2,3
 //
-// All Minterms will be calculated and the result will be stored in a vector
+// All Minterms will be calculated and the result will be stored in a packed truth table
+// (1 bit per input value. See truthtable.hpp)
+// The words of the truth table can also be streamed to consumers while the calculation
+// is still running (See truthtablestream.hpp)
 // The complexity of the function is O(2**N). Meaning, needed space and calculation
 // time grows geometrically. 
 //
 //  More than 12 variables cannot be used in a reasonable timeframe.
-// This programm implements multithreading. But this is basically a meaningless approach
-// Even running on 8 threads, you can do 3 variables more. And then?
-// So, no further effort on runtime speed optimization
+// This programm implements multithreading. The input values are split into chunks of truth table
+// words, which are calculated by the thread pool. A cost model selects the size of the chunks.
+// All tasks share the loaded evaluators and write directly to the preallocated results.
 // 
 // The resulting Mintermvector and the gathered Symbols will be used by other program
 // Parts for further evaluation.
@@ -67,6 +70,7 @@
 
 #include "mintermcalculater.hpp"
 #include "cloption.hpp"
+#include "threadpool.hpp"
 
 #include <future>
 #include <iostream>
@@ -78,59 +82,42 @@
 // Calculating Minterms is slow
 // And the complexity is O(2^n). Meaning Rowing expeonentially
 // SO, for biiger number of boolean variables, we use multi threading
-// One tread calculates a range of Minterms
-// The ranges for the trheads are claculated in this function
-// numberOfRanges is equal to number of threads. Upper bound is 2^number of variables
-MintermCalculator::MintermRangeVector MintermCalculator::calculateMintermRanges(uint numberOfRanges, uint upperBound)
+// One task calculates a range of Minterms
+// The ranges for the tasks are claculated in this function
+// Each range has the given number of truth table words (64 input values each). Only the last range may be smaller
+// Upper bound is 2^number of variables
+MintermCalculator::MintermRangeVector MintermCalculator::calculateMintermRanges(uint numberOfWordsPerRange, uint upperBound)
 {
 	// Resulting minterm ranges (not overlapping)
 	MintermRangeVector mrv;
-	// If there are less values to calculate then threads available, use only one range
-	if (upperBound < numberOfRanges)
+	// So many input values are in one range
+	const uint rangeValue{ ((0U == numberOfWordsPerRange) ? 1U : numberOfWordsPerRange) * NumberOfBitSlicedLanes };
+	// We of course always start with 0
+	uint startValue{ 0 };
+	do
 	{
-		// One range from 0 to upper bound
-		mrv.emplace_back(MintermRange(0, upperBound));
-	}
-	else
-	{
-		// More values to calculate than available threads
-		// Used to calculate the next begin of range
-		const uint rangeValue = { upperBound / numberOfRanges };
-		// We of course always start with 0
-		uint startValue{ 0 };
-
-		for (uint ui = 0; ui < numberOfRanges; ++ui)
+		// Calculate next end of range value
+		uint endValue{ startValue + rangeValue };
+		// If this is already over  the edge (or the range is very big and the value wrapped around)
+		if ((endValue > upperBound) || (endValue < startValue))
 		{
-			// Calculate next end of range value
-			uint endValue{ startValue + rangeValue };
-			// If this is already over  the edge
-			if (endValue > (upperBound))
-			{
-				// Limit the upper bound
-				endValue = upperBound;
-			}
-			// Store resulting range
-			mrv.emplace_back(MintermRange(startValue, endValue));
-			// And set next start value
-			startValue = endValue;
+			// Limit the upper bound
+			endValue = upperBound;
 		}
-	}
+		// Store resulting range
+		mrv.emplace_back(MintermRange(startValue, endValue));
+		// And set next start value
+		startValue = endValue;
+	} while (startValue < upperBound);
 	// Return a vector with ranges
 	return mrv;
 }
 
 
-// Calculate all minterms for a boolean functions
-// Means set all possible input values for a boolean function
-// If the result of the calculation is true, then we found a minterm and store it
-// Calculations with a false result(Maxterm) are not stored.
-// Since claculation is slow and gets slower with more variable
-// We will use multitasking wit big boolean functions
-MintermVector MintermCalculator::calculate()
+// Compile the source code, optimize the object code and load it into all selected evaluators
+// The evaluators are loaded only once. Afterwards they are only read by all tasks
+bool MintermCalculator::prepareCalculation()
 {
-	// Here we will store the result, so all minterms for the boolean function
-	MintermVector mintermVector;
-	
 	// Compile the source code to object code
 	if (!compilerResultOK)
 	{
@@ -140,82 +127,187 @@ MintermVector MintermCalculator::calculate()
 	{
 		// CHeck how many variables are in and how many calculation loops we need to do
 		numberOfBooleanVariables = objectCode.symbolTable.numberOfSymbols();
-		const uint maxEvaluations{ 1U << numberOfBooleanVariables };
 
-		// If we have more than 10 boolean variables, then we will use mult threading to calculate the minterms
-		if (numberOfBooleanVariables > 10)
+		// Optimize the object code, if not switched off by the user
+		if (!programOption.option[ProgramOption::nocopt].optionSelected)
+		{
+			ObjectCodeOptimizer objectCodeOptimizer;
+			objectCodeOptimizer.optimize(objectCode);
+		}
+
+		// Load the code into a virtual machine. This will also show the resulting program
+		vmfbe.load(objectCode, source);
+		// Load the wide lane kernel. It will be used by all threads
+		wideLaneKernel.load(objectCode);
+		// If selected by the user, translate the object code to native machine code
+		// If this is not possible, then the kernel or the virtual machine will be used
+		if (programOption.option[ProgramOption::jit].optionSelected)
+		{
+			jitCompiler.compile(objectCode);
+		}
+		// If selected by the user, build the fan-out cones for the Gray code sweep
+		if (programOption.option[ProgramOption::gcs].optionSelected)
 		{
-			// Claculate the ranges to be calculated by each thread
-			MintermRangeVector mrv{ calculateMintermRanges(numberOfThreads, maxEvaluations) };
+			grayCodeSweep.load(objectCode);
+		}
+	}
+	return compilerResultOK;
+}
 
-			// Futures for asynchronous functions. Wait for the thread to finish ang get the result
-			std::future<MintermVector> futures[numberOfThreads];
 
-			// Start calculation threads
-			for (uint i = 0; i < numberOfThreads; ++i)
-			{
-				futures[i] = std::async(std::launch::async,& MintermCalculator::calculateAsThread, this, mrv[i], objectCode);
-			}
-			// Wait for the thread to end and read the result
-			for (uint i = 0; i < numberOfThreads; ++i)
-			{
-				MintermVector mvTemp{ futures[i].get() };
-				// Store all results from all threads in one common function result
-				mintermVector.insert(mintermVector.end(), std::make_move_iterator(mvTemp.begin()), std::make_move_iterator(mvTemp.end()));
-			}
+// Cost model for the multithreaded calculation
+// One truth table word costs roughly one execution of the program. The interpreter is slower than
+// native code or the vector kernel. A task should do at least MinimumCostPerTask instructions.
+// The resulting number of words is rounded up to a power of 2. So the chunks are aligned for the
+// wide lane kernel and for the Gray code sweep
+// The user can overrule the cost model with option -grain
+uint MintermCalculator::calculateNumberOfWordsPerTask()
+{
+	uint numberOfWordsPerTask{ 0U };
+	if (programOption.option[ProgramOption::grain].optionSelected)
+	{
+		// User defined number of words. The value has been checked already
+		numberOfWordsPerTask = narrow_cast<uint>(programOption.getNumericParameter(ProgramOption::grain));
+	}
+	if (null<uint>() == numberOfWordsPerTask)
+	{
+		// Number of executed instructions for one truth table word
+		uint costPerWord{ narrow_cast<uint>(objectCode.opCode.size()) + 1U };
+		if (!jitCompiler.isAvailable() && !grayCodeSweep.isAvailable() && !wideLaneKernel.isAvailable())
+		{
+			// Only the interpreter will be used
+			costPerWord *= InterpreterCostFactor;
+		}
+		// So many words are needed, to make a task worthwhile
+		const uint minimumNumberOfWords{ (MinimumCostPerTask + costPerWord - 1U) / costPerWord };
+		// Round up to the next power of 2. And the kernel shall calculate complete runs
+		numberOfWordsPerTask = wideLaneKernel.isAvailable() ? (wideLaneKernel.lanesPerRun() / NumberOfBitSlicedLanes) : 1U;
+		while (numberOfWordsPerTask < minimumNumberOfWords)
+		{
+			numberOfWordsPerTask *= 2U;
+		}
+	}
+	return numberOfWordsPerTask;
+}
+
+
+// Calculate all minterms for a boolean functions
+// Means set all possible input values for a boolean function
+// If the result of the calculation is true, then we found a minterm
+// The results are pushed as chunks of truth table words to the stream, as soon as they are available
+// The stream will always be closed in the end, also in case of an error
+// Since claculation is slow and gets slower with more variable
+// We will use multitasking, if the cost model says that it is worthwhile
+void MintermCalculator::calculate(TruthTableStream& truthTableStream)
+{
+	if (prepareCalculation())
+	{
+		const uint maxEvaluations{ 1U << numberOfBooleanVariables };
+
+		// One task of the thread pool calculates one chunk of the truth table
+		MintermRangeVector mrv{ calculateMintermRanges(calculateNumberOfWordsPerTask(), maxEvaluations) };
+		const uint numberOfChunks{ narrow_cast<uint>(mrv.size()) };
+
+		// Calculate one chunk. The words are written directly to the preallocated chunk
+		const auto calculateChunk = [this](MintermRange mt, TruthTableChunk& truthTableChunk)
+		{
+			truthTableChunk.firstWordIndex = mt.first / NumberOfBitSlicedLanes;
+			truthTableChunk.word.resize((mt.second - mt.first + NumberOfBitSlicedLanes - 1U) / NumberOfBitSlicedLanes);
+			BitSlicedRegisterFile registerFile{ vmfbe.createBitSlicedRegisterFile() };
+			calculateRange(mt, registerFile, truthTableChunk.word.data());
+		};
+
+		// If we have more than one chunk and more than one thread, then we will use multi threading to calculate the minterms
+		if ((numberOfChunks > 1U) && (threadPool.getNumberOfThreads() > 1U))
+		{
+			// Results of the tasks. Will be pushed to the stream in ascending order
+			std::vector<TruthTableChunk> truthTableChunk(numberOfChunks);
+			// Not all tasks are submitted at once. Only so many chunks may be calculated in advance. This limits the memory consumption
+			// The workers take the next chunk, when they are free. So the load is balanced dynamically
+			threadPool.parallelForOrdered(numberOfChunks,
+				[&calculateChunk, &mrv, &truthTableChunk](uint chunk) { calculateChunk(mrv[chunk], truthTableChunk[chunk]); },
+				// Give the next chunk in sequence to the consumer
+				[&truthTableChunk, &truthTableStream](uint chunk) { truthTableStream.push(std::move(truthTableChunk[chunk])); return true; });
 		}
 		else
 		{
 			// No multitasking
-			// Load the code into a virtual machine and
-			vmfbe.load(objectCode, source);
-			// execute the program for all posiible input values
-			for (uint ui = 0; ui < maxEvaluations; ++ui)
+			// Calculate the chunks one after the other. The consumer can already work on the first chunks
+			for (const MintermRange& mt : mrv)
 			{
-				// If the result evaluates to true
-				if (vmfbe.run(ui))
-				{
-					// then store this minterm
-					mintermVector.push_back(ui);
-				}
+				TruthTableChunk truthTableChunk;
+				calculateChunk(mt, truthTableChunk);
+				truthTableStream.push(std::move(truthTableChunk));
 			}
 		}
 	}
-	return mintermVector;
+	// No more data will follow
+	truthTableStream.close();
 }
 
 
-// Calculate minterms in a thread
-MintermVector MintermCalculator::calculateAsThread(MintermRange mt, ObjectCode objectCodeParameter)
+// Calculate all minterms for a range of input values
+// The range must start with a multiple of 64.
+// As long as there are enough input values left, the wide lane kernel will be used.
+// It calculates 256 or 512 values at once, if the CPU supports it. 
+// The rest will be done by the virtual machine in bit sliced mode. This is also the fallback, if the kernel is not available
+// If the user selected the just in time compiler and native code could be generated, then only the native code will be used
+// Else, if the user selected the Gray code sweep, then the sweep will calculate the complete range
+// The resulting words are written to truthTableWord. There must be space for all words of the range
+void MintermCalculator::calculateRange(MintermRange mt, BitSlicedRegisterFile& registerFile, TruthTableWord* truthTableWord) const
 {
-	// Resulting vector with minterms
-	MintermVector mv;
-
-	// Local virtual machine
-	VirtualMachineForBooleanExpressions vm;
-	// Load the object code into the virtual machine
-	vm.load(objectCodeParameter, source);
-	// And run the virtual machine for the range assigned to the thread
-	for (uint ui = mt.first; ui < mt.second; ++ui)
+	// Number of words of the truth table for this range
+	const uint numberOfWords{ (mt.second - mt.first + NumberOfBitSlicedLanes - 1U) / NumberOfBitSlicedLanes };
+	// Index of the next word to write
+	uint word{ 0U };
+
+	uint ui{ mt.first };
+	if (jitCompiler.isAvailable())
+	{
+		// Native code calculates 64 input values at once
+		for (; ui < mt.second; ui += NumberOfBitSlicedLanes)
+		{
+			truthTableWord[word++] = jitCompiler.run(ui);
+		}
+	}
+	else if (grayCodeSweep.isAvailable())
+	{
+		// Calculate all truth table words for the range at once
+		grayCodeSweep.sweep(mt.first, mt.second, truthTableWord);
+		word = numberOfWords;
+		ui = mt.second;
+	}
+	else if (wideLaneKernel.isAvailable())
 	{
-		// In case of true result
-		if (vm.run(ui))
+		// So many input values will be calculated by one run of the kernel
+		const uint lanesPerRun{ wideLaneKernel.lanesPerRun() };
+		for (; (ui + lanesPerRun) <= mt.second; ui += lanesPerRun)
 		{
-			// Store the minterm
-			mv.push_back(ui);
+			// The kernel writes its resulting part of the truth table directly to the destination
+			wideLaneKernel.run(ui, truthTableWord + word);
+			word += lanesPerRun / NumberOfBitSlicedLanes;
 		}
 	}
-	// Return the local minterm vector, so that it can be combined with other thread results
-	return mv;
+	// Calculate the rest with the bit sliced virtual machine
+	for (; ui < mt.second; ui += NumberOfBitSlicedLanes)
+	{
+		// Store the truth table word. So the results for 64 input values
+		truthTableWord[word++] = vmfbe.runBitSliced(ui, registerFile);
+	}
+	// If there are less than 6 variables, then not all bits of the word are valid. Consumers shall not see them
+	if (numberOfBooleanVariables < 6U)
+	{
+		truthTableWord[0] &= ((static_cast<TruthTableWord>(1U) << (1U << numberOfBooleanVariables)) - 1U);
+	}
 }
 
 
 // Print a comlete truth table. 
 // So not only the minterm, but the result for a boolean expression for all possible inputs
-// Source is a minterm vector. The variable source is the source string, the boolean expression.It is for output purposes only
+// Source is the truth table. The variable source is the source string, the boolean expression.It is for output purposes only
 // the symbol table is important, to give bits names
 
-void printTruthTable(const std::string& source, MintermVector& mintermVector, const SymbolTable& symbolTable)
+void printTruthTable(const std::string& source, const TruthTable& truthTable, const SymbolTable& symbolTable)
 {
 	// So many letter/symbols/variables/conditions/terminals were in the source string, the boolean expression
 	const uint symbolCount{ symbolTable.numberOfSymbols() };
@@ -244,9 +336,9 @@ void printTruthTable(const std::string& source, MintermVector& mintermVector, co
 	for (uint i = 0; i < maxEvaluations; ++i)
 	{
 		b = i; // Assign running value to bitset
-		// Check if the running value is in the minterm list
+		// Check if the running value is a minterm in the truth table
 		// If so, then result is 1 , else 0
-		uint result{ (std::find(mintermVector.begin(), mintermVector.end(), i) != mintermVector.end()) ? 1U : 0U };
+		uint result{ truthTable.isMinterm(i) ? 1U : 0U };
 		// Print decimal equivalent of running variable, the bitset and the result
 		os << std::setw(static_cast<std::streamsize>(maxLengthDecimalEquivalent) + 1) << i << " " << b.to_string().substr(26 - symbolCount) << "    " << result << '\n';
 	}
@@ -0,0 +1,334 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+
+
+
+//
+// Node Value Matrix. The values of all nodes of an AST for all possible input values
+//
+// See header file for further explanations
+//
+
+#include "nodevaluematrix.hpp"
+#include "threadpool.hpp"
+#include "runbudget.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+
+
+namespace
+{
+	// Word of the truth table of a condition with the given source mask for the input values in word wordIndex
+	// The condition is true, if one of the bits of the source mask is set in the input value
+	BitSlicedRegisterType conditionWord(const uint sourceMask, const uint wordIndex) noexcept
+	{
+		// Input value of bit 0 of the word
+		const BitSlicedRegisterType firstInputValue{ static_cast<BitSlicedRegisterType>(wordIndex) * NumberOfBitSlicedLanes };
+		BitSlicedRegisterType result{ 0U };
+		for (uint bit = 0U; bit < (sizeof(uint) * 8U); ++bit)
+		{
+			if (0U != (sourceMask & (1U << bit)))
+			{
+				if (bit < bitSlicedLanePattern.size())
+				{
+					result |= bitSlicedLanePattern[bit];
+				}
+				// Higher bits are the same for all 64 input values in the word
+				else if (0U != ((firstInputValue >> bit) & 1U))
+				{
+					result = ~static_cast<BitSlicedRegisterType>(0U);
+				}
+			}
+		}
+		return result;
+	}
+
+	// Same for a list of input values. Bit i of the word belongs to inputValue[wordIndex * NumberOfBitSlicedLanes + i]
+	BitSlicedRegisterType conditionWord(const uint sourceMask, const std::vector<uint>& inputValue, const uint wordIndex) noexcept
+	{
+		const uint firstInput{ wordIndex * NumberOfBitSlicedLanes };
+		const uint endInput{ std::min(narrow_cast<uint>(inputValue.size()), firstInput + NumberOfBitSlicedLanes) };
+		BitSlicedRegisterType result{ 0U };
+		for (uint input = firstInput; input < endInput; ++input)
+		{
+			if (0U != (inputValue[input] & sourceMask))
+			{
+				result |= static_cast<BitSlicedRegisterType>(1U) << (input - firstInput);
+			}
+		}
+		return result;
+	}
+}
+
+
+
+// Evaluate the AST for all input values. Blocks of words are given to the thread pool
+void NodeValueMatrix::calculate(const VirtualMachineForAST& virtualMachineForAst, uint numberOfConditions, bool booleanShortCutEvaluation)
+{
+	numberOfInputValues = 1U << numberOfConditions;
+	wordsPerNode = (numberOfInputValues + NumberOfBitSlicedLanes - 1U) / NumberOfBitSlicedLanes;
+	withShortCutEvaluation = booleanShortCutEvaluation;
+	sampledInputValue.clear();
+	calculateTables(virtualMachineForAst);
+}
+
+
+
+// Evaluate the AST only for the given input values
+void NodeValueMatrix::calculate(const VirtualMachineForAST& virtualMachineForAst, const std::vector<uint>& inputValue, bool booleanShortCutEvaluation)
+{
+	numberOfInputValues = narrow_cast<uint>(inputValue.size());
+	wordsPerNode = (numberOfInputValues + NumberOfBitSlicedLanes - 1U) / NumberOfBitSlicedLanes;
+	withShortCutEvaluation = booleanShortCutEvaluation;
+	sampledInputValue = inputValue;
+	calculateTables(virtualMachineForAst);
+}
+
+
+
+// Calculate all tables for the selected input values
+void NodeValueMatrix::calculateTables(const VirtualMachineForAST& virtualMachineForAst)
+{
+	const AST& ast{ virtualMachineForAst.ast };
+	numberOfNodes = narrow_cast<uint>(ast.size());
+
+	// The sequence for the evaluation has been determined, when the AST was built. Children before parents
+	// The root is the last element. The same sequence as for the evaluation of one input value
+	nodeIndexPostOrder = virtualMachineForAst.getEvaluationSequence();
+
+	// All bits are 0 for nodes that are not part of the tree. Same as in the AST
+	nodeValue.assign(static_cast<std::size_t>(numberOfNodes) * wordsPerNode, 0U);
+	nodeNotEvaluated.assign(withShortCutEvaluation ? (static_cast<std::size_t>(numberOfNodes) * wordsPerNode) : 0U, 0U);
+	nodeObservable.assign(static_cast<std::size_t>(numberOfNodes) * wordsPerNode, 0U);
+
+	// Each word of the tables is independent from the others
+	// For big expressions this takes long. So stop, if the time is over
+	std::atomic<bool> allWordsCalculated{ true };
+	threadPool.parallelFor(0U, wordsPerNode, 64U, [this, &ast, &allWordsCalculated](uint begin, uint end)
+		{
+			std::vector<BitSlicedRegisterType> maskedByParent(numberOfNodes, 0U);
+			for (uint wordIndex = begin; wordIndex < end; ++wordIndex)
+			{
+				if (runBudget.isExhausted())
+				{
+					allWordsCalculated.store(false, std::memory_order_relaxed);
+					break;
+				}
+				calculateWord(ast, wordIndex, maskedByParent);
+			}
+		});
+	complete = allWordsCalculated.load(std::memory_order_relaxed);
+
+	// Partition the words by the outcome of the decision. Bits above the number of input values are not used
+	// Not needed for an incomplete matrix. It will not be searched
+	wordsWithTrueOutcome.clear();
+	wordsWithFalseOutcome.clear();
+	if (complete && !nodeIndexPostOrder.empty())
+	{
+		for (uint wordIndex = 0U; wordIndex < wordsPerNode; ++wordIndex)
+		{
+			const uint lanesInWord{ std::min(numberOfInputValues - (wordIndex * NumberOfBitSlicedLanes), NumberOfBitSlicedLanes) };
+			const BitSlicedRegisterType usedLanes{ (lanesInWord >= NumberOfBitSlicedLanes) ? ~null<BitSlicedRegisterType>() : ((static_cast<BitSlicedRegisterType>(1U) << lanesInWord) - 1U) };
+			const BitSlicedRegisterType rootValue{ valueWord(nodeIndexPostOrder.back(), wordIndex) };
+			if (null<BitSlicedRegisterType>() != (rootValue & usedLanes))
+			{
+				wordsWithTrueOutcome.push_back(wordIndex);
+			}
+			if (null<BitSlicedRegisterType>() != (~rootValue & usedLanes))
+			{
+				wordsWithFalseOutcome.push_back(wordIndex);
+			}
+		}
+	}
+}
+
+
+
+// Evaluate all nodes for 64 input values at the same time. The same operations as in VirtualMachineForAST::evaluateTreeIterative
+// but done with bit operations on words
+void NodeValueMatrix::calculateWord(const AST& ast, uint wordIndex, std::vector<BitSlicedRegisterType>& maskedByParent)
+{
+	const auto word = [this, wordIndex](std::vector<BitSlicedRegisterType>& table, const uint nodeIndex) -> BitSlicedRegisterType&
+	{
+		return table[(static_cast<std::size_t>(wordIndex) * numberOfNodes) + nodeIndex];
+	};
+	constexpr BitSlicedRegisterType allBitsSet{ ~static_cast<BitSlicedRegisterType>(0U) };
+
+	// First the values. Children before parents
+	for (const uint index : nodeIndexPostOrder)
+	{
+		const AstNode& node{ ast[index] };
+		BitSlicedRegisterType value{ 0U };
+		bool isError{ false };
+		switch (node.numberOfChildren)
+		{
+		case NumberOfChildren::zero:
+			if (Token::ID == node.tokenWithAttribute.token)
+			{
+				value = sampledInputValue.empty() ? conditionWord(node.tokenWithAttribute.sourceMask, wordIndex) : conditionWord(node.tokenWithAttribute.sourceMask, sampledInputValue, wordIndex);
+			}
+			else if (Token::IDNOT == node.tokenWithAttribute.token)
+			{
+				value = ~(sampledInputValue.empty() ? conditionWord(node.tokenWithAttribute.sourceMask, wordIndex) : conditionWord(node.tokenWithAttribute.sourceMask, sampledInputValue, wordIndex));
+			}
+			else
+			{
+				isError = true;
+			}
+			break;
+		case NumberOfChildren::one:
+			if ((Token::BCLOSE == node.tokenWithAttribute.token) || (Token::END == node.tokenWithAttribute.token))
+			{
+				value = word(nodeValue, node.childLeftID);
+			}
+			else if (Token::NOT == node.tokenWithAttribute.token)
+			{
+				value = ~word(nodeValue, node.childLeftID);
+			}
+			else
+			{
+				isError = true;
+			}
+			break;
+		case NumberOfChildren::two:
+			if (Token::AND == node.tokenWithAttribute.token)
+			{
+				value = word(nodeValue, node.childLeftID) & word(nodeValue, node.childRightID);
+			}
+			else if (Token::OR == node.tokenWithAttribute.token)
+			{
+				value = word(nodeValue, node.childLeftID) | word(nodeValue, node.childRightID);
+			}
+			else if (Token::XOR == node.tokenWithAttribute.token)
+			{
+				value = word(nodeValue, node.childLeftID) ^ word(nodeValue, node.childRightID);
+			}
+			else
+			{
+				isError = true;
+			}
+			break;
+		default:
+			break;
+		}
+		word(nodeValue, index) = value;
+		// Should never happen. Value is false and the node shall not be used
+		if (isError && withShortCutEvaluation)
+		{
+			word(nodeNotEvaluated, index) = allBitsSet;
+		}
+	}
+
+	// Then the flags for boolean short cut evaluation. A node is not evaluated, if it is in the right subtree of
+	// an AND with a false left side or of an OR with a true left side. Parents before children
+	if (withShortCutEvaluation && !nodeIndexPostOrder.empty())
+	{
+		maskedByParent[nodeIndexPostOrder.back()] = 0U;
+		for (std::vector<uint>::const_reverse_iterator it = nodeIndexPostOrder.crbegin(); it != nodeIndexPostOrder.crend(); ++it)
+		{
+			const AstNode& node{ ast[*it] };
+			const BitSlicedRegisterType masked{ maskedByParent[*it] };
+			word(nodeNotEvaluated, *it) |= masked;
+
+			if (NumberOfChildren::one == node.numberOfChildren)
+			{
+				maskedByParent[node.childLeftID] = masked;
+			}
+			else if (NumberOfChildren::two == node.numberOfChildren)
+			{
+				BitSlicedRegisterType shortCut{ 0U };
+				if (Token::AND == node.tokenWithAttribute.token)
+				{
+					shortCut = ~word(nodeValue, node.childLeftID);
+				}
+				else if (Token::OR == node.tokenWithAttribute.token)
+				{
+					shortCut = word(nodeValue, node.childLeftID);
+				}
+				maskedByParent[node.childLeftID] = masked;
+				maskedByParent[node.childRightID] = masked | shortCut;
+			}
+		}
+	}
+
+	// And at last the observability. Parents before children. The root is always observable
+	// A child is observable, if the parent is observable and the sibling does not control the parent
+	if (!nodeIndexPostOrder.empty())
+	{
+		word(nodeObservable, nodeIndexPostOrder.back()) = allBitsSet;
+		for (std::vector<uint>::const_reverse_iterator it = nodeIndexPostOrder.crbegin(); it != nodeIndexPostOrder.crend(); ++it)
+		{
+			const AstNode& node{ ast[*it] };
+			const BitSlicedRegisterType observableParent{ word(nodeObservable, *it) };
+
+			if (NumberOfChildren::one == node.numberOfChildren)
+			{
+				word(nodeObservable, node.childLeftID) = observableParent;
+			}
+			else if (NumberOfChildren::two == node.numberOfChildren)
+			{
+				// A right side that has not been evaluated, does not control the parent. The left side is always evaluated
+				const BitSlicedRegisterType rightNotEvaluated{ withShortCutEvaluation ? word(nodeNotEvaluated, node.childRightID) : null<BitSlicedRegisterType>() };
+				BitSlicedRegisterType leftNotControlling{ allBitsSet };
+				BitSlicedRegisterType rightNotControlling{ allBitsSet };
+				if (Token::AND == node.tokenWithAttribute.token)
+				{
+					leftNotControlling = word(nodeValue, node.childLeftID);
+					rightNotControlling = word(nodeValue, node.childRightID) | rightNotEvaluated;
+				}
+				else if (Token::OR == node.tokenWithAttribute.token)
+				{
+					leftNotControlling = ~word(nodeValue, node.childLeftID);
+					rightNotControlling = ~word(nodeValue, node.childRightID) | rightNotEvaluated;
+				}
+				word(nodeObservable, node.childLeftID) = observableParent & rightNotControlling;
+				word(nodeObservable, node.childRightID) = observableParent & leftNotControlling;
+			}
+		}
+	}
+}
+
+
+
+// Set the results of the nodes of an AST to the values for one input value
+void NodeValueMatrix::copyTo(VirtualMachineForAST& virtualMachineForAst, uint inputValue) const noexcept
+{
+	const uint numberOfNodesInAst{ std::min(narrow_cast<uint>(virtualMachineForAst.ast.size()), numberOfNodes) };
+	for (uint i = 0U; i < numberOfNodesInAst; ++i)
+	{
+		virtualMachineForAst.setNodeResult(i, value(i, inputValue), notEvaluated(i, inputValue));
+	}
+}
@@ -0,0 +1,374 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+//
+// Optimizer for the object code of the code generator for the virtual machine
+//
+// Value numbering (CSE), algebraic simplification, constant folding, dead value elimination 
+// and register compaction. See header file for further explanations
+//
+
+
+#include "objectcodeoptimizer.hpp"
+
+#include <set>
+#include <algorithm>
+
+
+// Optimize the object code
+void ObjectCodeOptimizer::optimize(ObjectCode& objectCode)
+{
+	// Start with the 2 constants
+	value.clear();
+	valueNumber.clear();
+	value.push_back(Value{ Token::NONE, ValueFalse, 0U });
+	value.push_back(Value{ Token::NONE, ValueTrue, 0U });
+
+	// The value, that is currently stored in a register
+	std::vector<uint> valueInRegister;
+	auto setRegister = [&valueInRegister](uint machineRegister, uint valueNumberForRegister) { if (machineRegister >= valueInRegister.size()) { valueInRegister.resize(machineRegister + 1U, ValueFalse); } valueInRegister[machineRegister] = valueNumberForRegister; };
+	auto getRegister = [&valueInRegister](uint machineRegister) -> uint { return (machineRegister < valueInRegister.size()) ? valueInRegister[machineRegister] : ValueFalse; };
+
+	// Result of the program
+	uint resultValue{ ValueFalse };
+	bool endFound{ false };
+	// If the result is a constant, we need any variable to calculate it
+	uint anyLetterIndex{ 0U };
+
+	// Step 1 and 2. Value numbering, simplification and constant folding
+	for (const OpCodeLine& opCodeLine : objectCode.opCode)
+	{
+		switch (opCodeLine.token)
+		{
+		case Token::ID:
+			anyLetterIndex = opCodeLine.parameter1;
+			setRegister(opCodeLine.parameter2, getValueForVariable(opCodeLine.parameter1));
+			break;
+		case Token::IDNOT:
+			anyLetterIndex = opCodeLine.parameter1;
+			setRegister(opCodeLine.parameter2, getValueForNot(getValueForVariable(opCodeLine.parameter1)));
+			break;
+		case Token::OR:
+		case Token::XOR:
+		case Token::AND:
+			setRegister(opCodeLine.parameter3, getValueForBinaryOperation(opCodeLine.token, getRegister(opCodeLine.parameter1), getRegister(opCodeLine.parameter2)));
+			break;
+		case Token::NOT:
+			setRegister(opCodeLine.parameter2, getValueForNot(getRegister(opCodeLine.parameter1)));
+			break;
+		case Token::END:
+			resultValue = getRegister(opCodeLine.parameter1);
+			endFound = true;
+			break;
+		default:
+			break;
+		}
+	}
+	// Only complete programs will be optimized
+	if (endFound)
+	{
+		// Step 3 and 4
+		generateObjectCode(objectCode, resultValue, anyLetterIndex);
+	}
+}
+
+
+// Check, if one value is the negation of the other
+bool ObjectCodeOptimizer::isNegationOf(uint valueNumber1, uint valueNumber2) const noexcept
+{
+	return ((Token::NOT == value[valueNumber1].operation) && (value[valueNumber1].operand1 == valueNumber2)) ||
+		((Token::NOT == value[valueNumber2].operation) && (value[valueNumber2].operand1 == valueNumber1));
+}
+
+
+// Find an existing value with the same operation and operands or add a new one
+// The key uses the sorted operands. The value stores the operands in the original order
+uint ObjectCodeOptimizer::findOrAddValue(Token operation, uint operand1, uint operand2, uint originalOperand1, uint originalOperand2)
+{
+	const ValueKey valueKey{ operation, operand1, operand2 };
+	uint result{ 0U };
+	const auto found{ valueNumber.find(valueKey) };
+	if (valueNumber.end() != found)
+	{
+		// Common sub expression. Reuse the value
+		result = found->second;
+	}
+	else
+	{
+		result = narrow_cast<uint>(value.size());
+		value.push_back(Value{ operation, originalOperand1, originalOperand2 });
+		valueNumber[valueKey] = result;
+	}
+	return result;
+}
+
+
+// Load of a variable
+uint ObjectCodeOptimizer::getValueForVariable(uint letterIndex)
+{
+	return findOrAddValue(Token::ID, letterIndex, 0U, letterIndex, 0U);
+}
+
+
+// Negation. Double negation and negated constants will be folded
+uint ObjectCodeOptimizer::getValueForNot(uint operand)
+{
+	uint result{ 0U };
+	if (isConstant(operand))
+	{
+		// !0 --> 1 and !1 --> 0
+		result = (ValueFalse == operand) ? ValueTrue : ValueFalse;
+	}
+	else if (Token::NOT == value[operand].operation)
+	{
+		// !!x --> x
+		result = value[operand].operand1;
+	}
+	else
+	{
+		result = findOrAddValue(Token::NOT, operand, 0U, operand, 0U);
+	}
+	return result;
+}
+
+
+// Binary operations AND, OR, XOR with simplifications
+uint ObjectCodeOptimizer::getValueForBinaryOperation(Token operation, uint operand1, uint operand2)
+{
+	// The operands in the original order. Will be used for the generated code
+	const uint originalOperand1{ operand1 };
+	const uint originalOperand2{ operand2 };
+	// All operations are commutative. Sort the operands. Then constants are always the first operand
+	if (operand1 > operand2)
+	{
+		std::swap(operand1, operand2);
+	}
+	uint result{ 0U };
+	switch (operation)
+	{
+	case Token::AND:
+		if (ValueFalse == operand1)						// 0&x --> 0
+		{
+			result = ValueFalse;
+		}
+		else if ((ValueTrue == operand1) || (operand1 == operand2))	// 1&x --> x     x&x --> x
+		{
+			result = operand2;
+		}
+		else if (isNegationOf(operand1, operand2))		// x&!x --> 0
+		{
+			result = ValueFalse;
+		}
+		else
+		{
+			result = findOrAddValue(operation, operand1, operand2, originalOperand1, originalOperand2);
+		}
+		break;
+	case Token::OR:
+		if (ValueTrue == operand1)						// 1|x --> 1
+		{
+			result = ValueTrue;
+		}
+		else if ((ValueFalse == operand1) || (operand1 == operand2))	// 0|x --> x     x|x --> x
+		{
+			result = operand2;
+		}
+		else if (isNegationOf(operand1, operand2))		// x|!x --> 1
+		{
+			result = ValueTrue;
+		}
+		else
+		{
+			result = findOrAddValue(operation, operand1, operand2, originalOperand1, originalOperand2);
+		}
+		break;
+	case Token::XOR:
+		if (operand1 == operand2)						// x^x --> 0
+		{
+			result = ValueFalse;
+		}
+		else if (ValueFalse == operand1)				// 0^x --> x
+		{
+			result = operand2;
+		}
+		else if (ValueTrue == operand1)					// 1^x --> !x
+		{
+			result = getValueForNot(operand2);
+		}
+		else if (isNegationOf(operand1, operand2))		// x^!x --> 1
+		{
+			result = ValueTrue;
+		}
+		else
+		{
+			result = findOrAddValue(operation, operand1, operand2, originalOperand1, originalOperand2);
+		}
+		break;
+	default:
+		break;
+	}
+	return result;
+}
+
+
+// Generate the optimized object code
+// Only values needed for the result will be generated. Registers will be reused after the last usage
+void ObjectCodeOptimizer::generateObjectCode(ObjectCode& objectCode, uint resultValue, uint anyLetterIndex)
+{
+	std::vector<OpCodeLine> newOpCode;
+
+	if (isConstant(resultValue))
+	{
+		// Contradiction or tautology. Calculate  x^x  and maybe negate it
+		newOpCode.push_back(OpCodeLine{ Token::ID, anyLetterIndex, 0U, static_cast<uint>('a') + anyLetterIndex });
+		newOpCode.push_back(OpCodeLine{ Token::XOR, 0U, 0U, 0U });
+		if (ValueTrue == resultValue)
+		{
+			newOpCode.push_back(OpCodeLine{ Token::NOT, 0U, 0U, 0U });
+		}
+		newOpCode.push_back(OpCodeLine{ Token::END, 0U, 0U, 0U });
+	}
+	else
+	{
+		// Step 3. Mark all values, that are needed for the result. Values are in topological order.
+		// So going backwards from the result will find all operands.
+		// A negated variable will be generated as IDNOT. Then the variable itself is not needed
+		std::vector<bool> isNeeded(value.size(), false);
+		isNeeded[resultValue] = true;
+		for (uint valueIndex = resultValue + 1U; valueIndex > ValueTrue + 1U; --valueIndex)
+		{
+			const uint current{ valueIndex - 1U };
+			if (isNeeded[current])
+			{
+				const Value& v{ value[current] };
+				if (Token::NOT == v.operation)
+				{
+					if (Token::ID != value[v.operand1].operation)
+					{
+						isNeeded[v.operand1] = true;
+					}
+				}
+				else if (Token::ID != v.operation)
+				{
+					isNeeded[v.operand1] = true;
+					isNeeded[v.operand2] = true;
+				}
+			}
+		}
+
+		// Last usage of each value. Index of the value, that uses it last
+		std::vector<uint> lastUsage(value.size(), 0U);
+		for (uint current = ValueTrue + 1U; current <= resultValue; ++current)
+		{
+			if (isNeeded[current])
+			{
+				const Value& v{ value[current] };
+				if ((Token::NOT == v.operation) && (Token::ID != value[v.operand1].operation))
+				{
+					lastUsage[v.operand1] = current;
+				}
+				else if ((Token::AND == v.operation) || (Token::OR == v.operation) || (Token::XOR == v.operation))
+				{
+					lastUsage[v.operand1] = current;
+					lastUsage[v.operand2] = current;
+				}
+			}
+		}
+
+		// Step 4. Register allocation. Always the lowest free register
+		std::set<uint> freeRegister;
+		uint numberOfRegisters{ 0U };
+		std::vector<uint> registerForValue(value.size(), 0U);
+		auto getNextAvailableRegister = [&]() -> uint
+		{
+			uint result{ numberOfRegisters };
+			if (freeRegister.empty())
+			{
+				++numberOfRegisters;
+			}
+			else
+			{
+				result = *freeRegister.begin();
+				freeRegister.erase(freeRegister.begin());
+			}
+			return result;
+		};
+		// Registers of operands, that are no longer needed, will be available again
+		auto releaseOperand = [&](uint operand, uint current) { if (lastUsage[operand] == current) { freeRegister.insert(registerForValue[operand]); } };
+
+		for (uint current = ValueTrue + 1U; current <= resultValue; ++current)
+		{
+			if (isNeeded[current])
+			{
+				const Value& v{ value[current] };
+				OpCodeLine opCodeLine;
+				switch (v.operation)
+				{
+				case Token::ID:
+					opCodeLine = OpCodeLine{ Token::ID, v.operand1, 0U, static_cast<uint>('a') + v.operand1 };
+					opCodeLine.parameter2 = registerForValue[current] = getNextAvailableRegister();
+					break;
+				case Token::NOT:
+					if (Token::ID == value[v.operand1].operation)
+					{
+						// Negated variable
+						const uint letterIndex{ value[v.operand1].operand1 };
+						opCodeLine = OpCodeLine{ Token::IDNOT, letterIndex, 0U, static_cast<uint>('a') + letterIndex };
+						opCodeLine.parameter2 = registerForValue[current] = getNextAvailableRegister();
+					}
+					else
+					{
+						opCodeLine.token = Token::NOT;
+						opCodeLine.parameter1 = registerForValue[v.operand1];
+						opCodeLine.parameter2 = registerForValue[current] = getNextAvailableRegister();
+						releaseOperand(v.operand1, current);
+					}
+					break;
+				default:
+					// AND, OR, XOR
+					opCodeLine.token = v.operation;
+					opCodeLine.parameter1 = registerForValue[v.operand1];
+					opCodeLine.parameter2 = registerForValue[v.operand2];
+					opCodeLine.parameter3 = registerForValue[current] = getNextAvailableRegister();
+					releaseOperand(v.operand1, current);
+					releaseOperand(v.operand2, current);
+					break;
+				}
+				newOpCode.push_back(opCodeLine);
+			}
+		}
+		newOpCode.push_back(OpCodeLine{ Token::END, registerForValue[resultValue], 0U, 0U });
+	}
+	// Replace the object code. The symbol table will not be touched
+	objectCode.opCode = std::move(newOpCode);
+}
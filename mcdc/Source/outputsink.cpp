@@ -0,0 +1,141 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+
+
+//
+// Ordered output sink for phases, that produce text output in parallel
+//
+// See header file for further explanations
+//
+
+#include "outputsink.hpp"
+
+
+namespace OutputHandling
+{
+	// Start the writer thread
+	OrderedOutputSink::OrderedOutputSink(std::ostream& targetStream) : target(targetStream)
+	{
+		formatOfTarget.copyfmt(target);
+		writer = std::thread(&OrderedOutputSink::writerLoop, this);
+	}
+
+	// The target may be used again, after the sink has been destroyed
+	OrderedOutputSink::~OrderedOutputSink()
+	{
+		finish();
+	}
+
+
+	// Get the buffer of a part. Create it, if it does not yet exist
+	std::ostringstream& OrderedOutputSink::part(uint sequenceNumber)
+	{
+		std::unique_lock<std::mutex> lock(sinkMutex);
+		std::unique_ptr<Part>& p{ pendingPart[sequenceNumber] };
+		if (!p)
+		{
+			p = std::make_unique<Part>();
+			// The output shall look exactly like the output to the target
+			p->buffer.copyfmt(formatOfTarget);
+		}
+		return p->buffer;
+	}
+
+
+	// Mark the part as complete and wake up the writer
+	void OrderedOutputSink::complete(uint sequenceNumber)
+	{
+		{
+			std::unique_lock<std::mutex> lock(sinkMutex);
+			std::unique_ptr<Part>& p{ pendingPart[sequenceNumber] };
+			if (!p)
+			{
+				// Nothing has been written to this part
+				p = std::make_unique<Part>();
+			}
+			p->complete = true;
+		}
+		partCompleted.notify_one();
+	}
+
+
+	// Wait for the writer thread. It will write everything that can be written
+	void OrderedOutputSink::finish()
+	{
+		if (writer.joinable())
+		{
+			{
+				std::unique_lock<std::mutex> lock(sinkMutex);
+				finished = true;
+			}
+			partCompleted.notify_one();
+			writer.join();
+			// Discard everything that could not be written
+			pendingPart.clear();
+		}
+	}
+
+
+	// Write the parts in the sequence of their numbers
+	void OrderedOutputSink::writerLoop()
+	{
+		while (true)
+		{
+			std::unique_ptr<Part> nextPart{};
+			{
+				std::unique_lock<std::mutex> lock(sinkMutex);
+				// Wait until the next part in sequence is complete or until we are finished
+				const auto nextPartIsComplete = [this]()
+				{
+					const std::map<uint, std::unique_ptr<Part>>::iterator it{ pendingPart.find(nextSequenceNumber) };
+					return (pendingPart.end() != it) && it->second->complete;
+				};
+				partCompleted.wait(lock, [this, &nextPartIsComplete]() { return finished || nextPartIsComplete(); });
+				if (!nextPartIsComplete())
+				{
+					// Finished and nothing more to write
+					break;
+				}
+				// Take the part out of the map. Writing will be done without the lock
+				const std::map<uint, std::unique_ptr<Part>>::iterator it{ pendingPart.find(nextSequenceNumber) };
+				nextPart = std::move(it->second);
+				pendingPart.erase(it);
+				++nextSequenceNumber;
+			}
+			// Write the data and free the memory. The buffer is an output only stream, so its streambuf cannot be read
+			const std::string data{ nextPart->buffer.str() };
+			target.write(data.data(), narrow_cast<std::streamsize>(data.size()));
+		}
+	}
+}
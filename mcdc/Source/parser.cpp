@@ -116,7 +116,7 @@ bool Parser::parse()
 				if (matchFound)
 				{
 					// Debug output, if selected
-					if (programOption.option[ProgramOption::ppst].optionSelected) std::cout << "Match found. Start to reduce, Number of production: " << indexOfMatchedProduction << '\n';
+					if (programOption.option[ProgramOption::ppst].optionSelected) OutputHandling::console() << "Match found. Start to reduce, Number of production: " << indexOfMatchedProduction << '\n';
 					
 					// ......................................................	-- > Reduce
 					reduce(indexOfMatchedProduction);
@@ -287,15 +287,15 @@ void Parser::reduce(uint positionOfProduction)
 	}
 }
 
-// Debug print of the parse stack. Will slways go to std::cout
+// Debug print of the parse stack. Will slways go to the console (std::cout)
 void Parser::printParseStack(std::string title)
 {
 	const uint stackSize = narrow_cast<uint>(parseStack.size());
 	// Print always the complete parse stacl
-	std::cout << title << "  - Parse Stack Dump.  Size: " << stackSize << '\n';
+	OutputHandling::console() << title << "  - Parse Stack Dump.  Size: " << stackSize << '\n';
 	for (uint i = 0; i < stackSize; i++)
 	{
-		std::cout << "---- Stack Dump: " << i << "      Token: " << std::setw(7) << tokenToCharP(parseStack[i].token) << "      Token Source Index: " << parseStack[i].sourceIndex << "      inputTerminalSymbol: " << parseStack[i].inputTerminalSymbol << '\n';
+		OutputHandling::console() << "---- Stack Dump: " << i << "      Token: " << std::setw(7) << tokenToCharP(parseStack[i].token) << "      Token Source Index: " << parseStack[i].sourceIndex << "      inputTerminalSymbol: " << parseStack[i].inputTerminalSymbol << '\n';
 	}
 }
 
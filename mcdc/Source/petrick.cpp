@@ -104,6 +104,7 @@
 
 
 #include "petrick.hpp"
+#include "runbudget.hpp"
 
 #include <algorithm>
 
@@ -124,6 +125,11 @@ ProductTermVector PetricksMethod::operator ()(const CNF& cnf)
 		// For (1+2)(3+4)  this would be the (1+2) part
 		for (const ProductTerm& productTermLeftSide : resultingDNF)
 		{
+			// The number of product terms may explode. Stop, if the time is over. The caller must handle the empty result
+			if (runBudget.isExhausted())
+			{
+				return ProductTermVector{};
+			}
 			// Next we will iterate over all Minterms in the next DNF
 			// For (1+2)(3+4)  this would be the (3+4) part
 			for (const ProductTerm& productTermRightSide : cnf[dnfInCnfIndex])
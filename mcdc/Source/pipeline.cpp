@@ -0,0 +1,132 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+
+
+//
+// Pipeline with the final stages of the program
+//
+// See header file for further explanations
+//
+
+#include "pipeline.hpp"
+#include "cloption.hpp"
+
+#include <future>
+#include <memory>
+
+
+// Add a stage with its predecessors. Returns the index of the new stage
+Pipeline::StageIndex Pipeline::addStage(Stage stage, const std::vector<StageIndex>& predecessor)
+{
+	stageDefinition.push_back({ stage, predecessor });
+	return narrow_cast<StageIndex>(stageDefinition.size() - 1U);
+}
+
+
+// Run all stages and wait for the end
+void Pipeline::run(bool runConcurrently)
+{
+	// With only one stage there is nothing to run at the same time
+	if (runConcurrently && (stageDefinition.size() > 1U))
+	{
+		runConcurrent();
+	}
+	else
+	{
+		runSequential();
+	}
+}
+
+
+// Simple case. Since the stages have been added in a valid sequence, the predecessors are always finished
+void Pipeline::runSequential()
+{
+	for (const StageDefinition& sd : stageDefinition)
+	{
+		sd.stage();
+	}
+}
+
+
+// Start one thread per stage. A stage thread waits for its predecessors, then does its work
+// The calling thread shows the console output of the stages, one after the other
+void Pipeline::runConcurrent()
+{
+	// The console for every stage. Must be created, before the threads start
+	// Their output will be buffered, until the stage becomes active
+	std::vector<std::unique_ptr<OutputHandling::StageConsoleStream>> stageConsole;
+	for (uint i = 0; i < stageDefinition.size(); ++i)
+	{
+		stageConsole.push_back(std::make_unique<OutputHandling::StageConsoleStream>());
+	}
+
+	// Will be ready, when a stage is finished. Shared, because successors and the calling thread need it
+	// Please note: Destroyed before the consoles. The destructor waits for the still running stages
+	std::vector<std::shared_future<void>> stageFinished;
+	for (uint i = 0; i < stageDefinition.size(); ++i)
+	{
+		// Copy the futures of the predecessors. All of them have been created already
+		std::vector<std::shared_future<void>> predecessorFinished;
+		for (const StageIndex predecessorIndex : stageDefinition[i].predecessor)
+		{
+			predecessorFinished.push_back(stageFinished[predecessorIndex]);
+		}
+
+		OutputHandling::StageConsoleStream* const console{ stageConsole[i].get() };
+		const Stage& stage{ stageDefinition[i].stage };
+
+		stageFinished.push_back(std::async(std::launch::async, [console, &stage, predecessorFinished]()
+		{
+			for (const std::shared_future<void>& pf : predecessorFinished)
+			{
+				// Exceptions of predecessors will be reported by the calling thread
+				pf.wait();
+			}
+			// All output to the console of this thread goes to the stage console
+			OutputHandling::setConsole(console);
+			stage();
+			console->flush();
+			OutputHandling::setConsole(nullptr);
+		}).share());
+	}
+
+	// Show the output of the stages in the sequence of adding. The first stage will write directly to std::cout
+	// All other stages will buffer their output, until all previous stages are finished
+	for (uint i = 0; i < stageDefinition.size(); ++i)
+	{
+		stageConsole[i]->activate();
+		stageFinished[i].get();
+	}
+	std::cout.flush();
+}
@@ -97,6 +97,9 @@
 
 #include "quinemccluskey.hpp"
 #include "cloption.hpp"
+#include "threadpool.hpp"
+#include "runbudget.hpp"
+#include "outputsink.hpp"
 
 #include <cmath>
 #include <thread>
@@ -105,14 +108,15 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
 
 
 // In order to find a minimum set of Prime Implicants we need to solve the set cover or unate covarge problem
 // Bevor we can start doing the slection of prime implicant, we must initialze the coverage table
-void  QuineMcluskey::initializeCoverageForPrimeImplicants(Coverage& coverageForPrimeImplicants, MintermVector& mv, const SymbolTable& symbolTable)
+void  QuineMcluskey::initializeCoverageForPrimeImplicants(Coverage& coverageForPrimeImplicants, const TruthTable& truthTable, const SymbolTable& symbolTable)
 {
 	// Add all minterms as rows
-	for (const MinTermType minTerm : mv)
+	for (const MinTermType minTerm : truthTable)
 	{
 		coverageForPrimeImplicants.addRow(minTerm);
 	}
@@ -125,6 +129,57 @@ void  QuineMcluskey::initializeCoverageForPrimeImplicants(Coverage& coverageForP
 	}
 }
 
+// Select implicants with a greedy heuristic. Used, if the time is over
+// For every minterm, that is not yet covered, take the biggest implicant that covers it
+std::string QuineMcluskey::getDisjunctiveNormalFormWithGreedyCover(const TruthTable& truthTable, const SymbolTable& symbolTable)
+{
+	// Implicants with many eliminated bits cover many minterms. Check them first
+	std::vector<PrimeImplicantType> implicant(primeImplicantSetResult.begin(), primeImplicantSetResult.end());
+	std::stable_sort(implicant.begin(), implicant.end(), [](const PrimeImplicantType& left, const PrimeImplicantType& right) noexcept
+		{ return numberOfSetBits(left.mask) > numberOfSetBits(right.mask); });
+
+	// Minterms already covered by a selected implicant
+	std::set<MinTermType> coveredMinterm;
+	// The selected implicants as text. Sorted, like the result of the coverage analysis
+	std::set<std::string> selectedImplicant;
+
+	for (const MinTermType minTerm : truthTable)
+	{
+		if (0U == coveredMinterm.count(minTerm))
+		{
+			for (const PrimeImplicantType& pi : implicant)
+			{
+				// Same check as in checkCoverForCell
+				if ((minTerm & ~pi.mask) == (pi.term & ~pi.mask))
+				{
+					selectedImplicant.insert(pi.toString(symbolTable));
+					// All minterms of the implicant are covered now. Iterate over all sub masks of the mask
+					MinTermType subMask{ pi.mask };
+					do
+					{
+						coveredMinterm.insert((pi.term & ~pi.mask) | subMask);
+						subMask = (subMask - 1U) & pi.mask;
+					} while (subMask != pi.mask);
+					break;
+				}
+			}
+		}
+	}
+
+	// Build the DNF as a string
+	std::string disjunctiveNormalForm;
+	for (const std::string& s : selectedImplicant)
+	{
+		if (!disjunctiveNormalForm.empty())
+		{
+			disjunctiveNormalForm += "+";
+		}
+		disjunctiveNormalForm += s;
+	}
+	return disjunctiveNormalForm;
+}
+
+
 // This is the next part of the initialization for the coverage table for prime implicants
 // The covering cells are determined and set
 // minTermRowHeader + primeImplicantColumnHeader
@@ -158,12 +213,21 @@ bool checkCoverForCell(const CellVectorHeader& minTermRowHeader, CellVectorHeade
 // This is main result that we want to have from the Quine&  McCluskey method
 // Get a minimum possible disjunctive normal form DNF
 // Please not, the source parameter is for output purposes
-// The main input data is the minterm table
-std::string QuineMcluskey::getMinimumDisjunctiveNormalForm(MintermVector& mv, const SymbolTable& symbolTable, const std::string& source)
+// The main input data is the truth table with the minterms
+std::string QuineMcluskey::getMinimumDisjunctiveNormalForm(const TruthTable& truthTable, const SymbolTable& symbolTable, const std::string& source)
 {
 	// Initialize the first level Quine and McCluskey table.
 	// Will contain all minterms sorted by number of bits set in the minterm
-	initiate(mv);
+	// If the minterms have already been streamed, then the table is ready
+	if (initialTableStreamed)
+	{
+		reductionTable.push_back(std::move(streamedInitialTable));
+		initialTableStreamed = false;
+	}
+	else
+	{
+		initiate(truthTable);
+	}
 
 	// Apply Quine and McCluskey Method
 	reduce();
@@ -181,10 +245,18 @@ std::string QuineMcluskey::getMinimumDisjunctiveNormalForm(MintermVector& mv, co
 
 	os << "\n\n\n------------------ Try to find Minmum Disjunctive Normal form for boolean expression:\n\n'" << source << "'\n\n";
 
+	// If the reduction has been stopped, because the time is over, then there is also no time for the prime implicant table
+	if (partialResult)
+	{
+		minimumDisjunctiveNormalForm = getDisjunctiveNormalFormWithGreedyCover(truthTable, symbolTable);
+		os << "\n\n------------------ Partial result. Time limit reached. Implicants selected with greedy heuristic. DNF may not be minimal:\n\n" << minimumDisjunctiveNormalForm << "\n\n------------------\n\n";
+		return minimumDisjunctiveNormalForm;
+	}
+
 	// Set up the prime implicant table
 	Coverage coverageForPrimeImplicants;
 	// Fill in row and column headers for prime implicant table
-	initializeCoverageForPrimeImplicants(coverageForPrimeImplicants, mv, symbolTable);
+	initializeCoverageForPrimeImplicants(coverageForPrimeImplicants, truthTable, symbolTable);
 	// Set the callback function that will be called to set the initial coverage
 	coverageForPrimeImplicants.setCheckForCoverFunction(checkCoverForCell);
 	// And now find the initial coverage (Call the callback function)
@@ -193,6 +265,10 @@ std::string QuineMcluskey::getMinimumDisjunctiveNormalForm(MintermVector& mv, co
 
 	// Reduce the primeimplicant table. May have several resulting vectors
 	CoverageResult cr{ coverageForPrimeImplicants.reduce(os) };
+	if (coverageForPrimeImplicants.isPartialResult())
+	{
+		partialResult = true;
+	}
 
 	// From possible many results, try to find one result	
 	// Some heuristic methods . . .
@@ -270,7 +346,14 @@ std::string QuineMcluskey::getMinimumDisjunctiveNormalForm(MintermVector& mv, co
 		}
 
 	}
-	os << "\n\n------------------ Minimum DNF:\n\n" << minimumDisjunctiveNormalForm << "\n\n------------------\n\n";
+	if (partialResult)
+	{
+		os << "\n\n------------------ Partial result. Time limit reached. DNF may not be minimal:\n\n" << minimumDisjunctiveNormalForm << "\n\n------------------\n\n";
+	}
+	else
+	{
+		os << "\n\n------------------ Minimum DNF:\n\n" << minimumDisjunctiveNormalForm << "\n\n------------------\n\n";
+	}
 	return minimumDisjunctiveNormalForm;
 }
 
@@ -299,41 +382,73 @@ QuineMcluskey::QuineMcluskey()
 
 // Fill the first initial Quine&  McCluskey Reduction table
 // Fill it with minterm grouped by number of bits in minterm
-void QuineMcluskey::initiate(MintermVector& mv)
+void QuineMcluskey::initiate(const TruthTable& truthTable)
 {
 	// We will use a fxed sized vector to store the goups of minterms
 	// Depending on the number of max variables
 	BitsAndMinTerms bitsAndMinTerms(MAX_NUMBER_OF_BOOLEAN_VARIABLES+1);
 
+	// Iterate over all input minterms
+	for (const MinTermNumber& mtn : truthTable)
+	{
+		addMintermToInitialTable(mtn, bitsAndMinTerms);
+	}
+
+	// After that, add it to the vector conatining all reduction tables that will be filled in several loops
+	reductionTable.push_back(std::move(bitsAndMinTerms));
+}
+
+
+// Add one minterm as a new row to the initial table
+void QuineMcluskey::addMintermToInitialTable(MinTermNumber mtn, BitsAndMinTerms& bitsAndMinTerms)
+{
 	// This is one row of a reduction table
 	TableEntry tableEntry;
 
-	// Iterate over all input minterms
-	for (const MinTermNumber& mtn : mv)
+	// For the selected algorithm, we will use only the lower and upper
+	// source minterm number, out of which a new row will be generated
+	// For the first initial table, upper and lower are the same 
+	tableEntry.mintermLower = tableEntry.mintermUpper = mtn;
+
+	// If the user wants to see every originator minterm
+	// then we additionally store it an a dedicated container
+	// This has is only used for printout
+	if (!processLowerAndUpperMintermOnly)
 	{
-		// For the selected algorithm, we will use only the lower and upper
-		// source minterm number, out of which a new row will be generated
-		// For the first initial table, upper and lower are the same 
-		tableEntry.mintermLower = tableEntry.mintermUpper = mtn;
-
-		// If the user wants to see every originator minterm
-		// then we additionally store it an a dedicated container
-		// This has is only used for printout
-		if (!processLowerAndUpperMintermOnly)
+		tableEntry.matchedMinterm.insert(mtn);
+	}
+
+	// Get the number of bits for this minterm
+	const NumberOfBitsCountType nb{ numberOfSetBits(mtn) };
+	
+	// And add this table row to the grouped-by-number-of-bits-table
+	bitsAndMinTerms[nb].push_back(std::move(tableEntry));
+}
+
+
+// Build the initial table from a chunk of the truth table. This can be done while the calculation is still running
+// The chunks come in ascending order. So the rows in the initial table will be the same as with "initiate"
+void QuineMcluskey::addMinterms(const TruthTableChunk& truthTableChunk)
+{
+	// First chunk. Create the fixed sized vector for the groups of minterms
+	if (!initialTableStreamed)
+	{
+		streamedInitialTable.assign(MAX_NUMBER_OF_BOOLEAN_VARIABLES + 1, TableForBitCount{});
+		initialTableStreamed = true;
+	}
+	for (uint word = 0; word < truthTableChunk.word.size(); ++word)
+	{
+		const TruthTableWord truthTableWord{ truthTableChunk.word[word] };
+		const uint firstInputValue{ (truthTableChunk.firstWordIndex + word) * NumberOfBitsInTruthTableWord };
+		// Visit all set bits in ascending order. Empty words can be skipped
+		for (uint bit = 0; (bit < NumberOfBitsInTruthTableWord) && (null<TruthTableWord>() != (truthTableWord >> bit)); ++bit)
 		{
-			tableEntry.matchedMinterm.clear();
-			tableEntry.matchedMinterm.insert(mtn);
+			if (0U != (truthTableWord & (static_cast<TruthTableWord>(1U) << bit)))
+			{
+				addMintermToInitialTable(narrow_cast<MinTermNumber>(firstInputValue + bit), streamedInitialTable);
+			}
 		}
-
-		// Get the number of bits for this minterm
-		const NumberOfBitsCountType nb{ numberOfSetBits(mtn) };
-		
-		// And add this table row to the grouped-by-number-of-bits-table
-		bitsAndMinTerms[nb].push_back(tableEntry);
 	}
-
-	// After that, add it to the vector conatining all reduction tables that will be filled in several loops
-	reductionTable.push_back(std::move(bitsAndMinTerms));
 }
 
 
@@ -352,6 +467,11 @@ void QuineMcluskey::compareTwoEntries(TableForBitCount& upper, TableForBitCount&
 	// Compare all rows of table with bit count + 1
 	for (const TableEntry& teUpper : upper)
 	{
+		// Stop, if the time is over. The caller will detect this and throw the incomplete result away
+		if (runBudget.isExhausted())
+		{
+			break;
+		}
 		// To all other rows bit bit count
 		for (const TableEntry& telower : lower)
 		{
@@ -440,6 +560,14 @@ void QuineMcluskey::reduce()
 	bool doIterateUntilAllPrimeImplcantsAreFound{ false };
 	do
 	{
+		// If the time is over, then stop here. Together with the prime implicants found so far,
+		// the terms of the current reduction table cover all minterms
+		if (runBudget.isExhausted())
+		{
+			collectAllImplicants(currentReductionTableColumn);
+			partialResult = true;
+			break;
+		}
 		// Already now create a new, next stage, reduction table
 		reductionTable.emplace_back(BitsAndMinTerms(MAX_NUMBER_OF_BOOLEAN_VARIABLES + 1));
 
@@ -448,31 +576,21 @@ void QuineMcluskey::reduce()
 		// And here, the highest index and the lowest index
 		const uint upper{ getHighestIndexOfBitCountEntry(currentReductionTableColumn) };
 		const uint lower{ getLowestIndexOfBitCountEntry(currentReductionTableColumn) };
-		// We want to calculate ranges of "bit-set-numbers" that we can give to multiple threads
-		BitCountRangeVector bcrv{ calculateBoundsForMultiThreading(upper, lower) };
-		// If we will do multi threading
-		if (bcrv.size() > 0)
-		{
-			// Define futures for the threads. No return value necessary. We just wnt to wait until thread is finished
-			std::future<void> futures[numberOfThreads];
-			// Get the ranges
-			for (uint ui = 0; ui < bcrv.size(); ++ui)
-			{
-				uint u{ bcrv[ui].first };
-				uint l{ bcrv[ui].second };
-				// And call calculation function in a thread
-				futures[ui] = std::async(&QuineMcluskey::compareFromBitCountUpperToBitCountLower, this, currentReductionTableColumn, u, l);
-			}
-			// Wait until all threads are finished
-			for (uint ui = 0; ui < bcrv.size(); ++ui)
+		// Each comparison of 2 neighbouring sub tables is one task for the thread pool. Tasks write to different
+		// sub tables of the next reduction table. The sizes of the sub tables follow the binomial distribution.
+		// The work stealing in the pool will balance the load
+		threadPool.parallelFor(lower, upper, 1U, [this, currentReductionTableColumn](uint begin, uint end)
 			{
-				futures[ui].wait();
-			}
-		}
-		else
+				compareFromBitCountUpperToBitCountLower(currentReductionTableColumn, end, begin);
+			});
+
+		// The comparison may have been stopped. Then the next reduction table is incomplete. Throw it away
+		if (runBudget.isExhausted())
 		{
-			// No multi threading. Calculate result in one thread
-			compareFromBitCountUpperToBitCountLower(currentReductionTableColumn, upper, lower);
+			reductionTable.pop_back();
+			collectAllImplicants(currentReductionTableColumn);
+			partialResult = true;
+			break;
 		}
 
 		// Collect prime implicants after this round. Prime implicants have not been marked (as used for combination)
@@ -514,6 +632,19 @@ void QuineMcluskey::collectPrimeImplicants(uint indexReductionTableColumn)
 	}
 }
 
+// The reduction has been stopped. Take all terms of the given reduction table, regardless, if they have been combined or not
+// Every term is an implicant. Terms not combined in previous rounds have already been collected as prime implicants
+void QuineMcluskey::collectAllImplicants(uint indexReductionTableColumn)
+{
+	for (const TableForBitCount& tfbc : reductionTable[indexReductionTableColumn])
+	{
+		for (const TableEntry& te : tfbc)
+		{
+			primeImplicantSetResult.insert(PrimeImplicantType(te.mintermLower, te.maskForEliminatedBit));
+		}
+	}
+}
+
 // Check, if we found all prime implicants or if we need to continue searching
 bool QuineMcluskey::checkIfFurtherEvaluationNecessary(uint indexReductionTableColumn)
 {
@@ -574,104 +705,6 @@ uint QuineMcluskey::getLowestIndexOfBitCountEntry(uint indexReductionTableColumn
 }
 
 
-// This is a little bit hard to understand. Lets give it a try
-// Snce comparing rows bit certain number of set bits is a very time and memory consuming
-// operation, we will uses multithrading to reduce calculation time
-// We need to compare ranges with number of set bits. For example we need to
-// compare a subtable that has 4 bits with a subtable that has 3 bits. And so one
-// Mathimatically it is the case, that for a certain number of bits there
-// are more possible minterms (rows) then for the other. We want to
-// distribute the work to the threads in a somehow balanced way.
-// Looking at the mathematics, we see the the binimial distrbution applies
-// Number of possible minterms with a given number of set bits is (n over k)
-// This function simulates that distribution and generates ranges for set
-// bits that can then be worked on by separate threads
-
-// Upper and lower ar max and min indices for sub tables
-// The result is a vector of pairs with upper/lower values
-QuineMcluskey::BitCountRangeVector QuineMcluskey::calculateBoundsForMultiThreading(uint upper, uint lower)
-{
-	BitCountRangeVector result;		// Here will store the resulting ranges
-
-	// For the claculation we atrt in the middle of the given overall range
-	const uint middle{ static_cast<uint>(std::ceil((upper - lower) / 2 + 1)) };
-
-	// We start with a delta of one, so the next range will be only on more or less than the current value
-	sint delta{ 1 };
-	// We will start with the middle and then go up and down
-	sint currentForDirectionLower{ static_cast<sint>(middle) };
-	sint nextForDirectionLower{ static_cast<sint>(middle) - delta };
-
-	sint currentForDirectionUpper{ static_cast<sint>(middle) + delta };
-	sint nextForDirectionUpper{ static_cast<sint>(middle) };
-
-	//Depending on the number of available threads we will define ranges for up and for down
-	const uint maxLoopCount{ (numberOfThreads >> 1) };
-	const uint lastLoopCount{ maxLoopCount - 1 };
-
-
-	for (uint i = 0; i < maxLoopCount; ++i)
-	{
-		// Direction for lower indices
-		// If we did not hit the lower boundary
-		if (currentForDirectionLower > narrow_cast<sint>(lower))
-		{
-			// Limit to the lower boundary. Ther must be nothing smaller than "lower"
-			if (nextForDirectionLower < narrow_cast<sint>(lower))
-			{
-				nextForDirectionLower = narrow_cast<sint>(lower);
-			}
-			// If this is the last possibility to set the range
-			if (i == lastLoopCount)
-			{
-				// Then the range is from the crrent value to the lower boundary
-				result.push_back(BitCountRange(currentForDirectionLower, lower));
-			}
-			else
-			{
-				// ELse the range is from the current value to the next calculated value
-				result.push_back(BitCountRange(currentForDirectionLower, nextForDirectionLower));
-			}
-		}
-
-		// Direction for higher indices
-		// If we did not hit the upper boundary
-		if (nextForDirectionUpper < narrow_cast<sint>(upper))
-		{
-			// Limit claculated value to upper boundary
-			if (currentForDirectionUpper > narrow_cast<sint>(upper))
-			{
-				currentForDirectionUpper = narrow_cast<sint>(upper);
-			}
-			// If this is the last loop run,
-			if (i == lastLoopCount)
-			{
-				// Then the range is from the current element to the upper boundary
-				result.push_back(BitCountRange(upper, nextForDirectionUpper));
-			}
-			else
-			{
-				// ELse the range is from the current value to the next calculated value
-				result.push_back(BitCountRange(currentForDirectionUpper, nextForDirectionUpper));
-			}
-		}
-
-		// Clculate the next values
-		currentForDirectionLower = nextForDirectionLower;
-		nextForDirectionLower -= delta;
-
-		nextForDirectionUpper = currentForDirectionUpper;
-		currentForDirectionUpper += delta;
-		// And in the next round the delta will be bigger.
-		// Times 2
-		// This reproduces the effect of the binmial distribution
-		delta = delta << 1;
-	}
-	return result;
-}
-
-
-
 // -----------------------------------------
 // print data
 
@@ -720,6 +753,8 @@ void QuineMcluskey::printReductionTable(const SymbolTable& symbolTable, const st
 	const bool predicateForOutputToFile{ (maxNumberOfBits > 6) };
 	OutStreamSelection outStreamSelection(ProgramOption::pqmtc, predicateForOutputToFile);
 	std::ostream& os{ outStreamSelection() };
+	// The table is printed left aligned. The stream may be the console. Other output shall not be affected
+	const std::ios_base::fmtflags formatFlags{ os.flags() };
 
 	// Header
 	os << "------------------ Print Quine McCluskey Reduction tables for boolean expression\n\n'" << source << "'\n\n";
@@ -727,102 +762,116 @@ void QuineMcluskey::printReductionTable(const SymbolTable& symbolTable, const st
 	// We will ptint table below each other. The classical approach by printing different
 	// reduction steps side by side consumes too much space
 	// So go through all but the last reduction tables (The last is alwyas empty)
-	for (uint currentTableIndex = 0; currentTableIndex < reductionTable.size()-1; ++currentTableIndex)
+	// Each reduction table is formatted independently in a task of the thread pool. Every table gets its own part of the sink
+	// The writer thread of the sink writes the parts in the order of the tables. So the output is the same as before
+	// Nothing needs to be formatted, if the output is suppressed
+	if (!outStreamSelection.isNull())
 	{
-		os << "\nReduction Loop " << currentTableIndex + 1 << "-----------------------------\n\n";
-		
-		// Print Column headers
-		os << "#     B#    ";
-		for (const cchar c : symbolTable.symbol)
+		OutputHandling::OrderedOutputSink outputSink(os);
+		threadPool.parallelFor(0U, narrow_cast<uint>(reductionTable.size()) - 1U, 1U, [&](const uint begin, const uint end)
 		{
-			os << c << ' ';
-		}
-		os << "   M D      MT Set\n";
-
-		// Counter for the lines in a sub table
-		uint counter{ 1 };
-
-		// We do not want to print empty tables
-		const uint upper{ getHighestIndexOfBitCountEntry(currentTableIndex) };
-		const uint lower{ getLowestIndexOfBitCountEntry(currentTableIndex) };
-
-		// So, for all the sub tables grouped by the number of set bits
-		for (uint bitCount = lower; bitCount <= upper; ++bitCount)
-		{
-			// For each row in this sub table
-			for (TableEntry& te : reductionTable[currentTableIndex][bitCount])
+			for (uint currentTableIndex = begin; currentTableIndex < end; ++currentTableIndex)
 			{
-				// Print running number and bit count
-				os << std::left << std::setw(6)<< counter++<< std::setw(4) << narrow_cast<uint>(bitCount) << "  ";
+				std::ostringstream& tableOutput{ outputSink.part(currentTableIndex) };
+				tableOutput << "\nReduction Loop " << currentTableIndex + 1 << "-----------------------------\n\n";
+				
+				// Print Column headers
+				tableOutput << "#     B#    ";
+				for (const cchar c : symbolTable.symbol)
+				{
+					tableOutput << c << ' ';
+				}
+				tableOutput << "   M D      MT Set\n";
 
-				// Get the minterm and the mask. So, see, what avriables are in there
-				const MinTermNumber mtn{ te.mintermLower };
-				const MinTermNumber deletedPos{ te.maskForEliminatedBit };
+				// Counter for the lines in a sub table
+				uint counter{ 1 };
 
-				// This will be used to iterate over the single literals in the minterms
-				// Start with this vale und will be shifted right
-				MinTermNumber bitMaskLocal{ bitMask[maxNumberOfBitsMinusOne] };
-				
-				// Now check all bits in the term
-				for (uint bitIndex = 0; bitIndex < maxNumberOfBits; ++bitIndex)
+				// We do not want to print empty tables
+				const uint upper{ getHighestIndexOfBitCountEntry(currentTableIndex) };
+				const uint lower{ getLowestIndexOfBitCountEntry(currentTableIndex) };
+
+				// So, for all the sub tables grouped by the number of set bits
+				for (uint bitCount = lower; bitCount <= upper; ++bitCount)
 				{
-					// Defualt is 0
-					cchar output{ '0' };
-					// If the varaible has been deleted
-					if (deletedPos&  bitMaskLocal)
-					{
-						output = '-';	// indicate deleted variable via dash
-					}
-					else
+					// For each row in this sub table
+					for (TableEntry& te : reductionTable[currentTableIndex][bitCount])
 					{
-						// If ist is posutively set
-						if (mtn&  bitMaskLocal)
+						// Print running number and bit count
+						tableOutput << std::left << std::setw(6)<< counter++<< std::setw(4) << narrow_cast<uint>(bitCount) << "  ";
+
+						// Get the minterm and the mask. So, see, what avriables are in there
+						const MinTermNumber mtn{ te.mintermLower };
+						const MinTermNumber deletedPos{ te.maskForEliminatedBit };
+
+						// This will be used to iterate over the single literals in the minterms
+						// Start with this vale und will be shifted right
+						MinTermNumber bitMaskLocal{ bitMask[maxNumberOfBitsMinusOne] };
+						
+						// Now check all bits in the term
+						for (uint bitIndex = 0; bitIndex < maxNumberOfBits; ++bitIndex)
 						{
-							output = '1';	// Shwo a 1
+							// Defualt is 0
+							cchar output{ '0' };
+							// If the varaible has been deleted
+							if (deletedPos&  bitMaskLocal)
+							{
+								output = '-';	// indicate deleted variable via dash
+							}
+							else
+							{
+								// If ist is posutively set
+								if (mtn&  bitMaskLocal)
+								{
+									output = '1';	// Shwo a 1
+								}
+								// else, use 0 from the varaibale initiaization
+							}
+							bitMaskLocal = bitMaskLocal >> 1; // Next bitmask
+							tableOutput << output << ' ';	// print separator
 						}
-						// else, use 0 from the varaibale initiaization
-					}
-					bitMaskLocal = bitMaskLocal >> 1; // Next bitmask
-					os << output << ' ';	// print separator
-				}
 
 
-				// Are we not in the first table?
-				if (currentTableIndex)
-				{
-					// Then show, if a combination could be done and what bit has been deleted
-					os << "   " << (te.matchFound ? 'X' : '_') << ' ' << std::setw(4) << deletedPos << "   ";
-				}
-				else
-				{
-					// In the first initial table there is no deleted pos. There is just the minterm 
-					os << "   " << (te.matchFound ? 'X' : '_') <<  "        ";
-				}
+						// Are we not in the first table?
+						if (currentTableIndex)
+						{
+							// Then show, if a combination could be done and what bit has been deleted
+							tableOutput << "   " << (te.matchFound ? 'X' : '_') << ' ' << std::setw(4) << deletedPos << "   ";
+						}
+						else
+						{
+							// In the first initial table there is no deleted pos. There is just the minterm 
+							tableOutput << "   " << (te.matchFound ? 'X' : '_') <<  "        ";
+						}
 
 
-				// For the selected algorithm, we will use only the lower and upper
-				// source minterm number, out of which a new row will be generated
-				// For the first initial table, upper and lower are the same 
-				// If the user wants to see every originator minterm
-				// then we additionally store it an a dedicated container
-				// And thsi we will show also to the user and print it
-				if (processLowerAndUpperMintermOnly)
-				{
-					// Show only lower and upper value as the originator of the new combined value
-					os << te.mintermLower << ' ' << te.mintermUpper << '\n';
-				}
-				else
-				{
-					// Show all minterms, from whicht his row has been created
-					for (const MinTermType m : te.matchedMinterm)
-					{
-						os << m << ' ';
+						// For the selected algorithm, we will use only the lower and upper
+						// source minterm number, out of which a new row will be generated
+						// For the first initial table, upper and lower are the same 
+						// If the user wants to see every originator minterm
+						// then we additionally store it an a dedicated container
+						// And thsi we will show also to the user and print it
+						if (processLowerAndUpperMintermOnly)
+						{
+							// Show only lower and upper value as the originator of the new combined value
+							tableOutput << te.mintermLower << ' ' << te.mintermUpper << '\n';
+						}
+						else
+						{
+							// Show all minterms, from whicht his row has been created
+							for (const MinTermType m : te.matchedMinterm)
+							{
+								tableOutput << m << ' ';
+							}
+							tableOutput << '\n';
+						}
 					}
-					os << '\n';
 				}
+				tableOutput << "\n\n";
+				outputSink.complete(currentTableIndex);
 			}
-		}
-		os << "\n\n";
+		});
+		// Wait until all tables have been written. Then the prime implicants follow
+		outputSink.finish();
 	}
 
 	// Then show all prime implicants
@@ -833,6 +882,8 @@ void QuineMcluskey::printReductionTable(const SymbolTable& symbolTable, const st
 		os << resultingPrimeImplicant.toString(symbolTable) << "  ";
 	}
 	os << "\n\n";
+	// Restore the previous alignment
+	os.flags(formatFlags);
 }
 
 
@@ -0,0 +1,74 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+
+
+//
+// Budget for the runtime of the program and cooperative cancellation
+//
+// See header file for further explanations
+//
+
+#include "runbudget.hpp"
+#include "cloption.hpp"
+
+
+
+// The one and only budget
+RunBudget runBudget;
+
+
+// Read the time limit from the command line. A missing value means: no time limit
+void RunBudget::start()
+{
+	if (programOption.option[ProgramOption::tl].optionSelected)
+	{
+		// The value has been checked already. Only positive numbers are accepted
+		deadline = startTime + std::chrono::seconds(programOption.getNumericParameter(ProgramOption::tl));
+		timeLimitSet = true;
+	}
+}
+
+
+// Check the time limit. Once exhausted, the budget will stay exhausted
+bool RunBudget::isExhausted() noexcept
+{
+	if (timeLimitSet && !exhausted.load(std::memory_order_relaxed))
+	{
+		if (std::chrono::steady_clock::now() >= deadline)
+		{
+			exhausted.store(true, std::memory_order_relaxed);
+		}
+	}
+	return exhausted.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,279 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+//
+// Process wide thread pool with work stealing
+//
+// See header file for further explanations
+//
+
+
+#include "threadpool.hpp"
+#include "cloption.hpp"
+
+#include <string>
+#include <exception>
+
+
+// Index of the worker in the pool, for the calling thread. Threads outside the pool have no index
+constexpr uint NoWorkerIndex{ ~null<uint>() };
+thread_local uint currentWorkerIndex{ NoWorkerIndex };
+
+
+// The one and only thread pool
+ThreadPool threadPool;
+
+
+// Stop the worker threads. Remaining tasks will still be executed
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+		stop = true;
+	}
+	taskAvailable.notify_all();
+	for (std::thread& t : worker)
+	{
+		if (t.joinable())
+		{
+			t.join();
+		}
+	}
+}
+
+
+// Number of worker threads. Either given by the user with option -threads or the number of hardware threads
+uint ThreadPool::getNumberOfThreads()
+{
+	std::call_once(startFlag, [this]() { start(); });
+	return numberOfThreads;
+}
+
+
+// Create the queues and start the worker threads
+void ThreadPool::start()
+{
+	numberOfThreads = std::thread::hardware_concurrency();
+	if (programOption.option[ProgramOption::threads].optionSelected)
+	{
+		// User defined number of threads. The value has been checked already
+		numberOfThreads = narrow_cast<uint>(programOption.getNumericParameter(ProgramOption::threads));
+	}
+	// The hardware may not tell us anything
+	if (null<uint>() == numberOfThreads)
+	{
+		numberOfThreads = 1U;
+	}
+	for (uint i = 0; i < numberOfThreads; ++i)
+	{
+		workQueue.push_back(std::make_unique<WorkQueue>());
+	}
+	for (uint i = 0; i < numberOfThreads; ++i)
+	{
+		worker.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+
+// Add a task to one of the queues and wake up a worker
+std::future<void> ThreadPool::submit(Task task)
+{
+	std::call_once(startFlag, [this]() { start(); });
+
+	// The packaged task must be copyable for std::function. So use a shared pointer
+	std::shared_ptr<std::packaged_task<void()>> packagedTask{ std::make_shared<std::packaged_task<void()>>(std::move(task)) };
+	std::future<void> result{ packagedTask->get_future() };
+
+	// Tasks, created by a worker, go to its own queue. All others are distributed
+	const uint queueIndex{ (NoWorkerIndex != currentWorkerIndex) ? currentWorkerIndex : (nextWorkQueue++ % numberOfThreads) };
+	{
+		// Lock the pool, so that a worker, that is just going to sleep, will not miss the notification
+		// The counter is incremented, before the task can be taken from the queue. So it will never be decremented first
+		std::lock_guard<std::mutex> poolLock(poolMutex);
+		std::lock_guard<std::mutex> queueLock(workQueue[queueIndex]->queueMutex);
+		workQueue[queueIndex]->task.emplace_back([packagedTask]() { (*packagedTask)(); });
+		++numberOfQueuedTasks;
+	}
+	taskAvailable.notify_one();
+	return result;
+}
+
+
+// Get the newest task from the own queue. If there is none, then steal the oldest task from another worker
+bool ThreadPool::getTask(uint workerIndex, Task& task)
+{
+	bool result{ false };
+	// Look at the own queue first and then at all others
+	for (uint i = 0; (i < numberOfThreads) && !result; ++i)
+	{
+		WorkQueue& wq{ *workQueue[(workerIndex + i) % numberOfThreads] };
+		std::lock_guard<std::mutex> lock(wq.queueMutex);
+		if (!wq.task.empty())
+		{
+			if (0U == i)
+			{
+				task = std::move(wq.task.back());
+				wq.task.pop_back();
+			}
+			else
+			{
+				task = std::move(wq.task.front());
+				wq.task.pop_front();
+			}
+			--numberOfQueuedTasks;
+			result = true;
+		}
+	}
+	return result;
+}
+
+
+// Worker thread. Execute tasks, or sleep, if there is nothing to do
+void ThreadPool::workerLoop(uint workerIndex)
+{
+	currentWorkerIndex = workerIndex;
+	Task task;
+	for (;;)
+	{
+		if (getTask(workerIndex, task))
+		{
+			task();
+			task = nullptr;
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lock(poolMutex);
+			taskAvailable.wait(lock, [this]() { return stop || (numberOfQueuedTasks > 0U); });
+			if (stop && (0U == numberOfQueuedTasks))
+			{
+				break;
+			}
+		}
+	}
+}
+
+
+// Split the range in sub ranges, execute all of them in the pool and wait for the end
+void ThreadPool::parallelFor(uint begin, uint end, uint grainSize, const std::function<void(uint, uint)>& function)
+{
+	if (null<uint>() == grainSize)
+	{
+		grainSize = 1U;
+	}
+	// Small ranges or only one thread: No need for the overhead
+	if (((end - begin) <= grainSize) || (1U == getNumberOfThreads()))
+	{
+		if (begin < end)
+		{
+			function(begin, end);
+		}
+	}
+	else
+	{
+		std::vector<std::future<void>> futures;
+		// An exception of a sub range is passed to the caller. But not before all sub ranges have finished
+		std::exception_ptr exception{};
+		try
+		{
+			for (uint subRangeBegin = begin; subRangeBegin < end; subRangeBegin += grainSize)
+			{
+				const uint subRangeEnd{ ((end - subRangeBegin) > grainSize) ? (subRangeBegin + grainSize) : end };
+				futures.push_back(submit([&function, subRangeBegin, subRangeEnd]() { function(subRangeBegin, subRangeEnd); }));
+			}
+			// Wait for all sub ranges
+			for (std::future<void>& f : futures)
+			{
+				f.get();
+			}
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+		}
+		// Sub ranges that are still running use data of the caller. Wait for them
+		for (std::future<void>& f : futures)
+		{
+			if (f.valid())
+			{
+				f.wait();
+			}
+		}
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+	}
+}
+
+
+// Sliding window of submitted tasks. The results are consumed in the order of the tasks
+void ThreadPool::parallelForOrdered(uint numberOfTasks, const std::function<void(uint)>& task, const std::function<bool(uint)>& consume)
+{
+	std::vector<std::future<void>> futures(numberOfTasks);
+	const uint maxNumberOfTasksInAdvance{ 2U * getNumberOfThreads() };
+	uint numberOfSubmittedTasks{ 0U };
+	// An exception of a task or of the consumer is passed to the caller. But not before all tasks have finished
+	std::exception_ptr exception{};
+	try
+	{
+		bool continueWork{ true };
+		for (uint nextTask = 0U; (nextTask < numberOfTasks) && continueWork; ++nextTask)
+		{
+			// Keep the pool busy
+			for (; (numberOfSubmittedTasks < numberOfTasks) && (numberOfSubmittedTasks < (nextTask + maxNumberOfTasksInAdvance)); ++numberOfSubmittedTasks)
+			{
+				const uint taskIndex{ numberOfSubmittedTasks };
+				futures[taskIndex] = submit([&task, taskIndex]() { task(taskIndex); });
+			}
+			// Wait for the next task in sequence and give its result to the consumer
+			futures[nextTask].get();
+			continueWork = consume(nextTask);
+		}
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+	}
+	// Tasks that are still running after a stop use data of the caller. Wait for them
+	for (std::future<void>& f : futures)
+	{
+		if (f.valid())
+		{
+			f.wait();
+		}
+	}
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
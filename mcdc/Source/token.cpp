@@ -82,6 +82,12 @@ const cchar* tokenToCharP(Token t) noexcept
 	case Token::EXPR:
 		return "EXPR";
 		break;
+	case Token::JUMPFALSE:
+		return "JUMPFALSE";
+		break;
+	case Token::JUMPTRUE:
+		return "JUMPTRUE";
+		break;
 	default:
 		return "Error";
 		break;
@@ -0,0 +1,264 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+//
+// Packed truth table for a boolean function
+//
+// 1 bit per input value, or, for very sparse or dense boolean functions, a sorted list of minterms or maxterms
+// See header file for further explanations
+//
+
+
+#include "truthtable.hpp"
+
+#include <algorithm>
+#include <bitset>
+
+
+// Clear everything and prepare a dense truth table with all bits 0
+void TruthTable::reset(uint numberOfBooleanVariablesForTable)
+{
+	numberOfBooleanVariables = numberOfBooleanVariablesForTable;
+	representation = TruthTableRepresentation::Dense;
+	mintermCount = 0U;
+	word.assign(numberOfWords(), null<TruthTableWord>());
+	mintermsBeforeWord.clear();
+	sparseTerm.clear();
+}
+
+
+// Set one word of the dense truth table. Lanes above 2^n will be masked out
+void TruthTable::setWord(uint wordIndex, TruthTableWord wordValue) noexcept
+{
+	if ((TruthTableRepresentation::Dense == representation) && (wordIndex < word.size()))
+	{
+		// If there are less than 6 variables, then not all bits of the word are valid
+		if (numberOfInputValues() < NumberOfBitsInTruthTableWord)
+		{
+			wordValue&= ((static_cast<TruthTableWord>(1U) << numberOfInputValues()) - 1U);
+		}
+		word[wordIndex] = wordValue;
+	}
+}
+
+
+// Set one minterm in the dense truth table
+void TruthTable::setMinterm(uint inputValue) noexcept
+{
+	if ((TruthTableRepresentation::Dense == representation) && (inputValue < numberOfInputValues()))
+	{
+		word[inputValue / NumberOfBitsInTruthTableWord] |= (static_cast<TruthTableWord>(1U) << (inputValue % NumberOfBitsInTruthTableWord));
+	}
+}
+
+
+// Count the minterms and decide about the representation
+// A sorted list is better than the bit field, if it needs less memory
+void TruthTable::compact()
+{
+	if (TruthTableRepresentation::Dense == representation)
+	{
+		// Count the minterms and build the helper for the rank function
+		mintermsBeforeWord.resize(word.size());
+		mintermCount = 0U;
+		for (uint wordIndex = 0U; wordIndex < word.size(); ++wordIndex)
+		{
+			mintermsBeforeWord[wordIndex] = mintermCount;
+			mintermCount += countSetBits(word[wordIndex]);
+		}
+
+		// Number of entries in a sorted list, that would need the same memory as the bit field
+		const uint maxSparseTerms{ narrow_cast<uint>((word.size() * sizeof(TruthTableWord)) / sizeof(MinTermNumber)) };
+		const uint maxtermCount{ numberOfInputValues() - mintermCount };
+
+		if ((mintermCount < maxSparseTerms) || (maxtermCount < maxSparseTerms))
+		{
+			// Very sparse or very dense. Store the minterms or the maxterms in a sorted list
+			const bool storeMinterms{ mintermCount <= maxtermCount };
+			sparseTerm.clear();
+			sparseTerm.reserve(storeMinterms ? mintermCount : maxtermCount);
+			for (uint inputValue = 0U; inputValue < numberOfInputValues(); ++inputValue)
+			{
+				const bool isSet{ null<TruthTableWord>() != (word[inputValue / NumberOfBitsInTruthTableWord]&  (static_cast<TruthTableWord>(1U) << (inputValue % NumberOfBitsInTruthTableWord))) };
+				if (isSet == storeMinterms)
+				{
+					sparseTerm.push_back(narrow_cast<MinTermNumber>(inputValue));
+				}
+			}
+			representation = storeMinterms ? TruthTableRepresentation::SparseMinterms : TruthTableRepresentation::SparseMaxterms;
+			// The bit field is no longer needed
+			word.clear();
+			word.shrink_to_fit();
+			mintermsBeforeWord.clear();
+			mintermsBeforeWord.shrink_to_fit();
+		}
+	}
+}
+
+
+// Check, if an input value is a minterm
+bool TruthTable::isMinterm(uint inputValue) const noexcept
+{
+	bool result{ false };
+	if (inputValue < numberOfInputValues())
+	{
+		switch (representation)
+		{
+		case TruthTableRepresentation::Dense:
+			result = null<TruthTableWord>() != (word[inputValue / NumberOfBitsInTruthTableWord]&  (static_cast<TruthTableWord>(1U) << (inputValue % NumberOfBitsInTruthTableWord)));
+			break;
+		case TruthTableRepresentation::SparseMinterms:
+			result = std::binary_search(sparseTerm.begin(), sparseTerm.end(), narrow_cast<MinTermNumber>(inputValue));
+			break;
+		case TruthTableRepresentation::SparseMaxterms:
+			result = !std::binary_search(sparseTerm.begin(), sparseTerm.end(), narrow_cast<MinTermNumber>(inputValue));
+			break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		}
+	}
+	return result;
+}
+
+
+// Number of minterms below the input value
+uint TruthTable::rank(uint inputValue) const noexcept
+{
+	uint result{ 0U };
+	if (inputValue >= numberOfInputValues())
+	{
+		result = mintermCount;
+	}
+	else
+	{
+		switch (representation)
+		{
+		case TruthTableRepresentation::Dense:
+			{
+				// All minterms in the words before plus the minterms in the lower bits of the word
+				const uint wordIndex{ inputValue / NumberOfBitsInTruthTableWord };
+				const TruthTableWord lowerBits{ (static_cast<TruthTableWord>(1U) << (inputValue % NumberOfBitsInTruthTableWord)) - 1U };
+				result = ((wordIndex < mintermsBeforeWord.size()) ? mintermsBeforeWord[wordIndex] : 0U) + countSetBits(word[wordIndex]&  lowerBits);
+			}
+			break;
+		case TruthTableRepresentation::SparseMinterms:
+			result = narrow_cast<uint>(std::lower_bound(sparseTerm.begin(), sparseTerm.end(), narrow_cast<MinTermNumber>(inputValue)) - sparseTerm.begin());
+			break;
+		case TruthTableRepresentation::SparseMaxterms:
+			result = inputValue - narrow_cast<uint>(std::lower_bound(sparseTerm.begin(), sparseTerm.end(), narrow_cast<MinTermNumber>(inputValue)) - sparseTerm.begin());
+			break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		}
+	}
+	return result;
+}
+
+
+// Find the next minterm equal or above the input value. 2^n means: no more minterms
+uint TruthTable::findNextMinterm(uint inputValue) const noexcept
+{
+	uint result{ numberOfInputValues() };
+	if (inputValue < numberOfInputValues())
+	{
+		switch (representation)
+		{
+		case TruthTableRepresentation::Dense:
+			{
+				// Ignore all bits below the input value in the first word. Then search for the next set bit
+				uint wordIndex{ inputValue / NumberOfBitsInTruthTableWord };
+				TruthTableWord currentWord{ word[wordIndex]&  ~((static_cast<TruthTableWord>(1U) << (inputValue % NumberOfBitsInTruthTableWord)) - 1U) };
+				while ((null<TruthTableWord>() == currentWord) && ((wordIndex + 1U) < word.size()))
+				{
+					++wordIndex;
+					currentWord = word[wordIndex];
+				}
+				if (null<TruthTableWord>() != currentWord)
+				{
+					// Lowest set bit
+					uint bit{ 0U };
+					while (null<TruthTableWord>() == (currentWord&  (static_cast<TruthTableWord>(1U) << bit)))
+					{
+						++bit;
+					}
+					result = (wordIndex * NumberOfBitsInTruthTableWord) + bit;
+				}
+			}
+			break;
+		case TruthTableRepresentation::SparseMinterms:
+			{
+				const auto next{ std::lower_bound(sparseTerm.begin(), sparseTerm.end(), narrow_cast<MinTermNumber>(inputValue)) };
+				if (sparseTerm.end() != next)
+				{
+					result = *next;
+				}
+			}
+			break;
+		case TruthTableRepresentation::SparseMaxterms:
+			{
+				// Skip all consecutive maxterms
+				result = inputValue;
+				auto next{ std::lower_bound(sparseTerm.begin(), sparseTerm.end(), narrow_cast<MinTermNumber>(inputValue)) };
+				while ((sparseTerm.end() != next) && (*next == result))
+				{
+					++result;
+					++next;
+				}
+			}
+			break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		}
+	}
+	return result;
+}
+
+
+// Build a vector with all minterms
+MintermVector TruthTable::mintermVector() const
+{
+	MintermVector mv;
+	mv.reserve(mintermCount);
+	for (const MinTermNumber minterm : *this)
+	{
+		mv.push_back(minterm);
+	}
+	return mv;
+}
+
+
+// Popcount for one truth table word
+uint TruthTable::countSetBits(TruthTableWord wordToCount) noexcept
+{
+	return narrow_cast<uint>(std::bitset<NumberOfBitsInTruthTableWord>(wordToCount).count());
+}
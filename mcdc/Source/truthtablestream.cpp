@@ -0,0 +1,92 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+//
+// Streaming of truth table words
+//
+// Chunks of truth table words are passed from the minterm calculator to the consumers
+// in ascending order. See header file for further explanations
+//
+
+
+#include "truthtablestream.hpp"
+
+
+// Add a chunk to the stream. Chunks may come in any order
+void TruthTableStream::push(TruthTableChunk&& chunk)
+{
+	std::unique_lock<std::mutex> lock(streamMutex);
+	// Wait, if the buffer is full. But the chunk that the consumer is waiting for, will always be accepted
+	spaceAvailable.wait(lock, [this, &chunk]() { return (bufferedChunk.size() < maxNumberOfBufferedChunks) || (chunk.firstWordIndex == nextWordIndex); });
+
+	const uint firstWordIndex{ chunk.firstWordIndex };
+	bufferedChunk[firstWordIndex] = std::move(chunk);
+	lock.unlock();
+	// Maybe this is the chunk the consumer is waiting for
+	chunkAvailable.notify_one();
+}
+
+
+// The producer is ready. No more chunks will follow
+void TruthTableStream::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(streamMutex);
+		closed = true;
+	}
+	chunkAvailable.notify_one();
+}
+
+
+// Get the next chunk in ascending order
+bool TruthTableStream::next(TruthTableChunk& chunk)
+{
+	bool result{ false };
+	std::unique_lock<std::mutex> lock(streamMutex);
+	// Wait until the next chunk in sequence is available or the producer is ready
+	chunkAvailable.wait(lock, [this]() { return (bufferedChunk.count(nextWordIndex) > 0U) || closed; });
+
+	std::map<uint, TruthTableChunk>::iterator iter{ bufferedChunk.find(nextWordIndex) };
+	if (iter != bufferedChunk.end())
+	{
+		// Give the chunk to the consumer and wait for the following chunk
+		chunk = std::move(iter->second);
+		bufferedChunk.erase(iter);
+		nextWordIndex += narrow_cast<uint>(chunk.word.size());
+		result = true;
+		lock.unlock();
+		// There is space in the buffer again. And the producer of the next chunk must be woken up in any case
+		spaceAvailable.notify_all();
+	}
+	return result;
+}
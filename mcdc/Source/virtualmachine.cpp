@@ -40,9 +40,9 @@
 // This is comparable with a linker.
 //
 // The generated executable program can be printed.
-// The program consist of Opcodes. Each Opcode has a  execution function
-// and up to 3 parameters. The program can be run and will then interpret opcodes
-// end execute them. The input variable value (given as a parameter) will be
+// The program consist of a compact byte code. Each instruction has an operation byte
+// and up to 3 operands. The program can be run and an interpreter loop will then 
+// execute the instructions one after the other. The input variable value (given as a parameter) will be
 // assigned to the boolean variables. Intermediate results will be stored in machine registers.
 // Machine Registers are temporary memory locations that can also be reused.
 // The boolean expression will be evaluated according to the program and the result will be returned.
@@ -64,22 +64,109 @@
 // The source is needed only for documentation output
 // The resulting code is printed
 // After loading the object code, the program can be ececuted
-
 void VirtualMachineForBooleanExpressions::load(ObjectCode& objectCode, const std::string& source)
 {
-	// On executable code line of the resulting programm
-	// An executable code line consists of a function (for the operation) and 3 parameters
-	ExecutableCodeLine executableCodeLine;
+	// Create the byte code program
+	load(objectCode);
+	// And show it to the user
+	printProgram(objectCode, source);
+}
+
+
+// Load the object code into the virtual machine for execution
+// The object code will be translated into a compact byte code. Nothing will be printed
+// So this function can be used in threads, without producing unnecessary output
+void VirtualMachineForBooleanExpressions::load(ObjectCode& objectCode)
+{
 	// Counting the needed virtual machine registers, so that those can be allocated in the end.
 	uint maxRegister{ 0 };
+	// Function for getting the max register number
+	const auto gMR = [&maxRegister](uint targetResister) noexcept { if (targetResister > maxRegister) maxRegister = targetResister; return narrow_cast<uint16_t>(targetResister); };
 
-	// Clear the program before loading new object code. So delete all executable lines
+	// Clear the program before loading new object code. So delete all instructions
 	program.clear();
+	program.reserve(objectCode.opCode.size());
 
 	// And, before starting, compact the symbol table
 	objectCode.symbolTable.compact();
 	numberOfLiterals = objectCode.symbolTable.numberOfSymbols();
-	
+	// Leaves will be counted from left to right
+	numberOfLeaves = 0U;
+
+	// Iterate over the object code and create byte code instructions
+	for (const OpCodeLine& opCodeLine : objectCode.opCode)
+	{
+		// On byte code instruction of the resulting programm
+		ByteCodeInstruction byteCodeInstruction;
+
+		// Depending on opcode in Object Code
+		switch (opCodeLine.token)
+		{
+		case Token::ID:
+			// Load a variable. The variable index will be normalized
+			byteCodeInstruction.operation = ByteCode::LoadID;
+			byteCodeInstruction.operand1 = narrow_cast<uint16_t>(objectCode.symbolTable.normalizedInput[opCodeLine.parameter1]);
+			byteCodeInstruction.operand2 = gMR(opCodeLine.parameter2);
+			byteCodeInstruction.operand3 = narrow_cast<uint16_t>(numberOfLeaves++);
+			break;
+		case Token::IDNOT:
+			// Load a negated variable. The variable index will be normalized
+			byteCodeInstruction.operation = ByteCode::LoadNotID;
+			byteCodeInstruction.operand1 = narrow_cast<uint16_t>(objectCode.symbolTable.normalizedInput[opCodeLine.parameter1]);
+			byteCodeInstruction.operand2 = gMR(opCodeLine.parameter2);
+			byteCodeInstruction.operand3 = narrow_cast<uint16_t>(numberOfLeaves++);
+			break;
+		case Token::OR:
+			byteCodeInstruction.operation = ByteCode::Or;
+			byteCodeInstruction.operand1 = gMR(opCodeLine.parameter1);
+			byteCodeInstruction.operand2 = gMR(opCodeLine.parameter2);
+			byteCodeInstruction.operand3 = gMR(opCodeLine.parameter3);
+			break;
+		case Token::XOR:
+			byteCodeInstruction.operation = ByteCode::Xor;
+			byteCodeInstruction.operand1 = gMR(opCodeLine.parameter1);
+			byteCodeInstruction.operand2 = gMR(opCodeLine.parameter2);
+			byteCodeInstruction.operand3 = gMR(opCodeLine.parameter3);
+			break;
+		case Token::AND:
+			byteCodeInstruction.operation = ByteCode::And;
+			byteCodeInstruction.operand1 = gMR(opCodeLine.parameter1);
+			byteCodeInstruction.operand2 = gMR(opCodeLine.parameter2);
+			byteCodeInstruction.operand3 = gMR(opCodeLine.parameter3);
+			break;
+		case Token::NOT:
+			byteCodeInstruction.operation = ByteCode::Not;
+			byteCodeInstruction.operand1 = gMR(opCodeLine.parameter1);
+			byteCodeInstruction.operand2 = gMR(opCodeLine.parameter2);
+			break;
+		case Token::END:
+			byteCodeInstruction.operation = ByteCode::End;
+			byteCodeInstruction.operand1 = gMR(opCodeLine.parameter1);
+			break;
+		case Token::JUMPFALSE:
+		case Token::JUMPTRUE:
+			// Conditional jumps for short cut evaluation. The jump target is an index in the program and not a register
+			byteCodeInstruction.operation = (Token::JUMPFALSE == opCodeLine.token) ? ByteCode::JumpIfFalse : ByteCode::JumpIfTrue;
+			byteCodeInstruction.operand1 = gMR(opCodeLine.parameter1);
+			byteCodeInstruction.operand2 = narrow_cast<uint16_t>(opCodeLine.parameter2);
+			byteCodeInstruction.operand3 = gMR(opCodeLine.parameter3);
+			break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		}
+		// Add a new instruction to the program
+		program.push_back(byteCodeInstruction);
+	}
+	// After program has bee created, provide space for machine registers
+	machineRegister.assign(static_cast<uint>(maxRegister) + 1, 0);
+	bitSlicedMachineRegister.assign(static_cast<uint>(maxRegister) + 1, 0);
+}
+
+
+// Print the program to the selected output destination
+// The listing is created from the object code, because it contains the original variable names
+void VirtualMachineForBooleanExpressions::printProgram(const ObjectCode& objectCode, const std::string& source)
+{
 	// In order to select the correct output destination, we want to find some complexity metric
 	const uint opCodeSize{ narrow_cast<uint>(objectCode.opCode.size()) };
 	const bool predicateForOutputToFile{ (opCodeSize > 150) };
@@ -91,106 +178,129 @@ void VirtualMachineForBooleanExpressions::load(ObjectCode& objectCode, const std
 	uint counter{ 0 };
 	os << std::left;
 
-	// Iterate over the object code and create executables
+	// Iterate over the object code and print all lines
 	for (const OpCodeLine& opCodeLine : objectCode.opCode)
 	{
-		// Function for getting the max register number
-		const auto gMR = [&maxRegister](uint targetResister) { if (targetResister > maxRegister) maxRegister = targetResister; return targetResister; };
-
 		// Depending on opcode in Object Code
 		switch (opCodeLine.token)
 		{
 		case Token::ID:
-			// Print to the output destination and calculate max register number
-			os << std::setw(8) << counter << " L    " << narrow_cast<cchar>(opCodeLine.parameter3) << "         --> R" << gMR(opCodeLine.parameter2) << '\n';
-			// Set the "execution function" which is implemented as lambda
-			executableCodeLine.execute = [&](MachineRegisterType a, MachineRegisterType b, MachineRegisterType c) {	this->operationLoadID(a, b, c); };
-			// And then copy the arameters, which are virtual machine registers
-			executableCodeLine.parameter1 = objectCode.symbolTable.normalizedInput[opCodeLine.parameter1];
-			executableCodeLine.parameter2 = opCodeLine.parameter2;
+			os << std::setw(8) << counter << " L    " << narrow_cast<cchar>(opCodeLine.parameter3) << "         --> R" << opCodeLine.parameter2 << '\n';
 			break;
-
 		case Token::IDNOT:
-			// Print to the output destination and calculate max register number
-			os << std::setw(8) << counter << " LN   " << narrow_cast<cchar>(opCodeLine.parameter3) << "         --> R" << gMR(opCodeLine.parameter2) << '\n';
-			executableCodeLine.execute = [&](MachineRegisterType a, MachineRegisterType b, MachineRegisterType c) {	this->operationLoadNotID(a, b, c); };
-			// And then copy the arameters, which are virtual machine registers
-			executableCodeLine.parameter1 = objectCode.symbolTable.normalizedInput[opCodeLine.parameter1];
-			executableCodeLine.parameter2 = opCodeLine.parameter2;
-
+			os << std::setw(8) << counter << " LN   " << narrow_cast<cchar>(opCodeLine.parameter3) << "         --> R" << opCodeLine.parameter2 << '\n';
 			break;
 		case Token::OR:
-			// Print to the output destination and calculate max register number
-			os << std::setw(8) << counter << " OR   R" <<  std::setw(2) << opCodeLine.parameter1 << "  R" << std::setw(2) << opCodeLine.parameter2 << "  --> R" << gMR(opCodeLine.parameter3) << '\n';
-			// Set the "execution function" which is implemented as lambda
-			executableCodeLine.execute = [&](MachineRegisterType a, MachineRegisterType b, MachineRegisterType c) {	this->operationOr(a, b, c); };
-			// And then copy the arameters, which are virtual machine registers
-			executableCodeLine.parameter1 = opCodeLine.parameter1;
-			executableCodeLine.parameter2 = opCodeLine.parameter2;
-			executableCodeLine.parameter3 = opCodeLine.parameter3;
+			os << std::setw(8) << counter << " OR   R" <<  std::setw(2) << opCodeLine.parameter1 << "  R" << std::setw(2) << opCodeLine.parameter2 << "  --> R" << opCodeLine.parameter3 << '\n';
 			break;
 		case Token::XOR:
-			// Print to the output destination and calculate max register number
-			os << std::setw(8) << counter << " XOR  R" << std::setw(2) << opCodeLine.parameter1 << "  R" << std::setw(2) << opCodeLine.parameter2 << "  --> R" << gMR(opCodeLine.parameter3) << '\n';
-			// Set the "execution function" which is implemented as lambda
-			executableCodeLine.execute = [&](MachineRegisterType a, MachineRegisterType b, MachineRegisterType c) {	this->operationXor(a, b, c); };
-			// And then copy the arameters, which are virtual machine registers
-			executableCodeLine.parameter1 = opCodeLine.parameter1;
-			executableCodeLine.parameter2 = opCodeLine.parameter2;
-			executableCodeLine.parameter3 = opCodeLine.parameter3;
+			os << std::setw(8) << counter << " XOR  R" << std::setw(2) << opCodeLine.parameter1 << "  R" << std::setw(2) << opCodeLine.parameter2 << "  --> R" << opCodeLine.parameter3 << '\n';
 			break;
 		case Token::AND:
-			// Print to the output destination and calculate max register number
-			os << std::setw(8) << counter << " AND  R" <<  std::setw(2) << opCodeLine.parameter1 << "  R" << std::setw(2) << opCodeLine.parameter2 << "  --> R" << gMR(opCodeLine.parameter3) << '\n';
-			// Set the "execution function" which is implemented as lambda
-			executableCodeLine.execute = [&](MachineRegisterType a, MachineRegisterType b, MachineRegisterType c) {	this->operationAnd(a, b, c); };
-			// And then copy the arameters, which are virtual machine registers
-			executableCodeLine.parameter1 = opCodeLine.parameter1;
-			executableCodeLine.parameter2 = opCodeLine.parameter2;
-			executableCodeLine.parameter3 = opCodeLine.parameter3;
+			os << std::setw(8) << counter << " AND  R" <<  std::setw(2) << opCodeLine.parameter1 << "  R" << std::setw(2) << opCodeLine.parameter2 << "  --> R" << opCodeLine.parameter3 << '\n';
 			break;
 		case Token::NOT:
-			// Print to the output destination and calculate max register number
-			os << std::setw(8) << counter << " NOT  R" <<  std::setw(2) << opCodeLine.parameter1 << "       --> R" << gMR(opCodeLine.parameter2) << '\n';
-			// Set the "execution function" which is implemented as lambda
-			executableCodeLine.execute = [&](MachineRegisterType a, MachineRegisterType b, MachineRegisterType c) {	this->operationNot(a, b, c); };
-			// And then copy the arameters, which are virtual machine registers
-			executableCodeLine.parameter1 = opCodeLine.parameter1;
-			executableCodeLine.parameter2 = opCodeLine.parameter2;
+			os << std::setw(8) << counter << " NOT  R" <<  std::setw(2) << opCodeLine.parameter1 << "       --> R" << opCodeLine.parameter2 << '\n';
 			break;
 		case Token::END:
-			// Print to the output destination and calculate max register number
-			os << std::setw(8) << counter << " END            --> R" << gMR(opCodeLine.parameter1) << '\n';
-			// Set the "execution function" which is implemented as lambda
-			executableCodeLine.execute = [&](MachineRegisterType a, MachineRegisterType b, MachineRegisterType c) {	this->operationEnd(a, b, c); };
-			// And then copy the arameters, which are virtual machine registers
-			executableCodeLine.parameter1 = opCodeLine.parameter1;
+			os << std::setw(8) << counter << " END            --> R" << opCodeLine.parameter1 << '\n';
+			break;
+		case Token::JUMPFALSE:
+			os << std::setw(8) << counter << " JF   R" << std::setw(2) << opCodeLine.parameter1 << "  @" << std::setw(3) << opCodeLine.parameter2 << " --> R" << opCodeLine.parameter3 << '\n';
+			break;
+		case Token::JUMPTRUE:
+			os << std::setw(8) << counter << " JT   R" << std::setw(2) << opCodeLine.parameter1 << "  @" << std::setw(3) << opCodeLine.parameter2 << " --> R" << opCodeLine.parameter3 << '\n';
 			break;
 #pragma warning(suppress: 4061)
 #pragma warning(suppress: 4062)
 		}
-		// Add a new executable line to the program
-		program.push_back(executableCodeLine);
 		++counter;
 	}
-	// After program has bee created, provide space for machine registers
-	machineRegister.resize(static_cast<uint>(maxRegister) + 1, 0);
-
 	os << "\n\n";
-
 }
 
 
 
 // Run the program, generated from the boolean expression, for a given input value
 bool VirtualMachineForBooleanExpressions::run(uint sv)
+{
+	return interpret<false>(sv, nullptr);
+}
+
+
+
+// Run the program and record the evaluated leaves
+// With short cut evaluation code, the leaves in skipped right hand operands will not be set
+bool VirtualMachineForBooleanExpressions::run(uint sv, EvaluatedLeaves& evaluatedLeaves)
+{
+	// One bit per leaf. Nothing evaluated yet
+	evaluatedLeaves.assign((static_cast<std::size_t>(numberOfLeaves) + 63U) / 64U, 0U);
+	return interpret<true>(sv, &evaluatedLeaves);
+}
+
+
+
+// This is a simple interpreter loop. The operation is selected with a switch
+// If the evaluated leaves shall be recorded, then each load operation sets the bit for its leaf number
+// The template parameter removes the recording at compile time. So the normal run is not slowed down
+template <bool RecordEvaluatedLeaves>
+bool VirtualMachineForBooleanExpressions::interpret(uint sv, EvaluatedLeaves* evaluatedLeaves)
 {
 	sourceValue = sv;
-	// Run the program line by line 
-	for (const ExecutableCodeLine& executableCodeLine : program)
+	// Run the program instruction by instruction. Jumps will modify the program counter
+	uint programCounter{ 0U };
+	while (programCounter < program.size())
 	{
-		// Call the function pointer for the operation and hand over 3 parameters
-		executableCodeLine.execute(executableCodeLine.parameter1, executableCodeLine.parameter2, executableCodeLine.parameter3);
+		const ByteCodeInstruction& byteCodeInstruction{ program[programCounter] };
+		++programCounter;
+		switch (byteCodeInstruction.operation)
+		{
+		case ByteCode::LoadID:
+			machineRegister[byteCodeInstruction.operand2] = getSourceValue(byteCodeInstruction.operand1);
+			if constexpr (RecordEvaluatedLeaves)
+			{
+				(*evaluatedLeaves)[byteCodeInstruction.operand3 / 64U] |= (1ULL << (byteCodeInstruction.operand3 % 64U));
+			}
+			break;
+		case ByteCode::LoadNotID:
+			machineRegister[byteCodeInstruction.operand2] = getSourceValueNegated(byteCodeInstruction.operand1);
+			if constexpr (RecordEvaluatedLeaves)
+			{
+				(*evaluatedLeaves)[byteCodeInstruction.operand3 / 64U] |= (1ULL << (byteCodeInstruction.operand3 % 64U));
+			}
+			break;
+		case ByteCode::Or:
+			machineRegister[byteCodeInstruction.operand3] = narrow_cast<MachineRegisterType>(machineRegister[byteCodeInstruction.operand1] | machineRegister[byteCodeInstruction.operand2]);
+			break;
+		case ByteCode::Xor:
+			machineRegister[byteCodeInstruction.operand3] = narrow_cast<MachineRegisterType>(machineRegister[byteCodeInstruction.operand1] ^ machineRegister[byteCodeInstruction.operand2]);
+			break;
+		case ByteCode::And:
+			machineRegister[byteCodeInstruction.operand3] = narrow_cast<MachineRegisterType>(machineRegister[byteCodeInstruction.operand1]&  machineRegister[byteCodeInstruction.operand2]);
+			break;
+		case ByteCode::Not:
+			machineRegister[byteCodeInstruction.operand2] = narrow_cast<MachineRegisterType>((~machineRegister[byteCodeInstruction.operand1]&  bitMask[0]));
+			break;
+		case ByteCode::End:
+			programResult = machineRegister[byteCodeInstruction.operand1];
+			break;
+		case ByteCode::JumpIfFalse:
+			// AND: Left hand operand is false. Result is false. Skip right hand operand
+			if (0U == machineRegister[byteCodeInstruction.operand1])
+			{
+				machineRegister[byteCodeInstruction.operand3] = machineRegister[byteCodeInstruction.operand1];
+				programCounter = byteCodeInstruction.operand2;
+			}
+			break;
+		case ByteCode::JumpIfTrue:
+			// OR: Left hand operand is true. Result is true. Skip right hand operand
+			if (0U != machineRegister[byteCodeInstruction.operand1])
+			{
+				machineRegister[byteCodeInstruction.operand3] = machineRegister[byteCodeInstruction.operand1];
+				programCounter = byteCodeInstruction.operand2;
+			}
+			break;
+		}
 	}
 	// ProgramResult will be set by end operation
 	return programResult ? true: false;
@@ -198,3 +308,89 @@ bool VirtualMachineForBooleanExpressions::run(uint sv)
 
 
 
+#ifdef _DEBUG
+// Check the loaded program against the evaluation of the AST for the same boolean expression
+// The leaves of the AST in the evaluation sequence are the variable occurences from left to right. So the same
+// as the leaf numbers in the program. For all input values, the results and the evaluated leaves must be identical
+bool VirtualMachineForBooleanExpressions::isEquivalentTo(VirtualMachineForAST& virtualMachineForAst)
+{
+	std::vector<uint> leafNodeIndex{};
+	for (const uint index : virtualMachineForAst.getEvaluationSequence())
+	{
+		if (NumberOfChildren::zero == virtualMachineForAst.ast[index].numberOfChildren)
+		{
+			leafNodeIndex.push_back(index);
+		}
+	}
+	bool isEquivalent{ leafNodeIndex.size() == numberOfLeaves };
+
+	EvaluatedLeaves evaluatedLeaves{};
+	const uint numberOfInputValues{ 1U << numberOfLiterals };
+	for (uint inputValue = 0U; isEquivalent && (inputValue < numberOfInputValues); ++inputValue)
+	{
+		isEquivalent = (run(inputValue, evaluatedLeaves) == virtualMachineForAst.evaluateTree(inputValue));
+		for (uint leaf = 0U; isEquivalent && (leaf < numberOfLeaves); ++leaf)
+		{
+			const bool leafEvaluated{ 0U != ((evaluatedLeaves[leaf / 64U] >> (leaf % 64U)) & 1U) };
+			isEquivalent = (leafEvaluated != virtualMachineForAst.notEvaluated(leafNodeIndex[leaf]));
+		}
+	}
+	return isEquivalent;
+}
+#endif
+
+
+
+// Run the program in bit sliced mode
+// All machine registers are 64 bit wide and each bit (lane) belongs to a different input value
+// So one run of the program calculates the result for 64 input values at once
+// The loaded variable values are precalculated patterns (see getSourceValueBitSliced)
+BitSlicedRegisterType VirtualMachineForBooleanExpressions::runBitSliced(uint sourceValueBase)
+{
+	// Use the own register file
+	bitSlicedProgramResult = runBitSliced(sourceValueBase, bitSlicedMachineRegister);
+	return bitSlicedProgramResult;
+}
+
+
+// Run the loaded program in bit sliced mode with an external register file
+// Nothing in the virtual machine will be modified. So different threads can share one loaded virtual machine
+BitSlicedRegisterType VirtualMachineForBooleanExpressions::runBitSliced(uint sourceValueBase, BitSlicedRegisterFile& registerFile) const
+{
+	// The result of the program
+	BitSlicedRegisterType result{ null<BitSlicedRegisterType>() };
+	// Run the program instruction by instruction
+	for (const ByteCodeInstruction& byteCodeInstruction : program)
+	{
+		switch (byteCodeInstruction.operation)
+		{
+		case ByteCode::LoadID:
+			registerFile[byteCodeInstruction.operand2] = getSourceValueBitSliced(byteCodeInstruction.operand1, sourceValueBase);
+			break;
+		case ByteCode::LoadNotID:
+			registerFile[byteCodeInstruction.operand2] = ~getSourceValueBitSliced(byteCodeInstruction.operand1, sourceValueBase);
+			break;
+		case ByteCode::Or:
+			registerFile[byteCodeInstruction.operand3] = registerFile[byteCodeInstruction.operand1] | registerFile[byteCodeInstruction.operand2];
+			break;
+		case ByteCode::Xor:
+			registerFile[byteCodeInstruction.operand3] = registerFile[byteCodeInstruction.operand1] ^ registerFile[byteCodeInstruction.operand2];
+			break;
+		case ByteCode::And:
+			registerFile[byteCodeInstruction.operand3] = registerFile[byteCodeInstruction.operand1]&  registerFile[byteCodeInstruction.operand2];
+			break;
+		case ByteCode::Not:
+			registerFile[byteCodeInstruction.operand2] = ~registerFile[byteCodeInstruction.operand1];
+			break;
+		case ByteCode::End:
+			result = registerFile[byteCodeInstruction.operand1];
+			break;
+		case ByteCode::JumpIfFalse:
+		case ByteCode::JumpIfTrue:
+			// Lanes may need different paths. Evaluate everything. The operation after the skipped operand calculates the same result
+			break;
+		}
+	}
+	// Result will be set by end operation. One bit per input value
+	return result;
+}
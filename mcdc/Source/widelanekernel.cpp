@@ -0,0 +1,344 @@
+// --------------------------------------------------------------------------------------------------------------------------------
+// License:	BSD-3-Clause
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Copyright 2019      Armin Montigny
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+// following conditions are met :
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the 
+//    following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the 
+//    following disclaimer in the documentation and /or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or 
+//    promote products derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------------------------------------------------------------
+
+
+
+
+//
+// A wide lane kernel to calculate the truth table of a boolean expression
+//
+// The kernel program is created from the object code of the code generator for the virtual machine.
+// It is then executed with vector registers. Each bit of a vector register belongs to a different
+// input value. With AVX2 we will calculate 256 input values at once, with AVX-512 512 input values.
+//
+// The back end is selected at runtime. If no vector extension is available, the kernel cannot
+// be used and the caller shall use the bit sliced mode of the virtual machine.
+//
+
+
+#include "widelanekernel.hpp"
+
+#ifdef WIDE_LANE_KERNEL_X86_64
+#include <immintrin.h>
+
+// MSVC allows the usage of all intrinsics in all functions. GCC and Clang need to know
+// that a function uses a vector extension that has not been selected for the whole program
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define WIDE_LANE_KERNEL_TARGET_AVX2
+#define WIDE_LANE_KERNEL_TARGET_AVX512
+#else
+#define WIDE_LANE_KERNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#define WIDE_LANE_KERNEL_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+#endif
+
+
+
+// Check, which vector extension is supported by the CPU and by the operating system
+// The widest extension will be selected
+WideLaneBackend WideLaneKernelForBooleanExpressions::detectBackend() noexcept
+{
+	WideLaneBackend result{ WideLaneBackend::None };
+
+#ifdef WIDE_LANE_KERNEL_X86_64
+#if defined(_MSC_VER)
+	// Read the CPU information. Leaf 1 has the flags for OSXSAVE and leaf 7 for AVX2 and AVX-512
+	sint cpuInfo[4]{};
+	__cpuid(&cpuInfo[0], 0);
+	const sint maxLeaf{ cpuInfo[0] };
+	if (maxLeaf >= 7)
+	{
+		__cpuid(&cpuInfo[0], 1);
+		const bool osUsesXSave{ 0 != (cpuInfo[2] & (1 << 27)) };
+		if (osUsesXSave)
+		{
+			// Check, if the operating system saves the vector registers on a context switch
+			const ull xcr0{ _xgetbv(0) };
+			const bool osSupportsAvx{ 0x06ULL == (xcr0 & 0x06ULL) };
+			const bool osSupportsAvx512{ 0xE6ULL == (xcr0 & 0xE6ULL) };
+
+			__cpuidex(&cpuInfo[0], 7, 0);
+			const bool cpuSupportsAvx2{ 0 != (cpuInfo[1] & (1 << 5)) };
+			const bool cpuSupportsAvx512{ 0 != (cpuInfo[1] & (1 << 16)) };
+
+			if (osSupportsAvx && cpuSupportsAvx2)
+			{
+				result = WideLaneBackend::Avx2;
+			}
+			if (osSupportsAvx512 && cpuSupportsAvx512)
+			{
+				result = WideLaneBackend::Avx512;
+			}
+		}
+	}
+#else
+	// GCC and Clang check the CPU and the operating system support for us
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		result = WideLaneBackend::Avx2;
+	}
+	if (__builtin_cpu_supports("avx512f"))
+	{
+		result = WideLaneBackend::Avx512;
+	}
+#endif
+#endif
+	return result;
+}
+
+
+// Number of input values that will be calculated with one run of the kernel program
+uint WideLaneKernelForBooleanExpressions::lanesPerRun() const noexcept
+{
+	uint result{ NumberOfBitSlicedLanes };
+	switch (backend)
+	{
+	case WideLaneBackend::Avx2:
+		result = 256U;
+		break;
+	case WideLaneBackend::Avx512:
+		result = 512U;
+		break;
+	case WideLaneBackend::None:
+		break;
+	}
+	return result;
+}
+
+
+// Load the object code and create the kernel program
+// The object code lines will be copied. For load operations the variable will be replaced by its normalized index
+void WideLaneKernelForBooleanExpressions::load(ObjectCode& objectCode)
+{
+	program.clear();
+	// Before starting, compact the symbol table to get the normalized input
+	objectCode.symbolTable.compact();
+
+	// We will check, if the number of local registers is sufficient
+	bool registersSufficient{ true };
+	// Function for checking the register numbers
+	const auto checkRegister = [&registersSufficient](uint registerNumber) noexcept { if (registerNumber >= MaxNumberOfKernelRegisters) registersSufficient = false; };
+
+	for (const OpCodeLine& opCodeLine : objectCode.opCode)
+	{
+		KernelCodeLine kernelCodeLine;
+		kernelCodeLine.token = opCodeLine.token;
+		switch (opCodeLine.token)
+		{
+		case Token::ID:
+		case Token::IDNOT:
+			// Variable index will be normalized. Register is in parameter 2
+			kernelCodeLine.parameter1 = objectCode.symbolTable.normalizedInput[opCodeLine.parameter1];
+			kernelCodeLine.parameter2 = opCodeLine.parameter2;
+			checkRegister(kernelCodeLine.parameter2);
+			break;
+		case Token::OR:
+		case Token::XOR:
+		case Token::AND:
+			// 2 source registers and one destination register
+			kernelCodeLine.parameter1 = opCodeLine.parameter1;
+			kernelCodeLine.parameter2 = opCodeLine.parameter2;
+			kernelCodeLine.parameter3 = opCodeLine.parameter3;
+			checkRegister(kernelCodeLine.parameter1);
+			checkRegister(kernelCodeLine.parameter2);
+			checkRegister(kernelCodeLine.parameter3);
+			break;
+		case Token::NOT:
+			// One source register and one destination register
+			kernelCodeLine.parameter1 = opCodeLine.parameter1;
+			kernelCodeLine.parameter2 = opCodeLine.parameter2;
+			checkRegister(kernelCodeLine.parameter1);
+			checkRegister(kernelCodeLine.parameter2);
+			break;
+		case Token::END:
+			// The result is in this register
+			kernelCodeLine.parameter1 = opCodeLine.parameter1;
+			checkRegister(kernelCodeLine.parameter1);
+			break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		}
+		program.push_back(kernelCodeLine);
+	}
+	// If the boolean expression is too complex for the local registers, then the bit sliced virtual machine shall be used
+	if (!registersSufficient)
+	{
+		backend = WideLaneBackend::None;
+	}
+}
+
+
+// All variables get their value for all 64 bit words of one run.
+// Bit i of word j belongs to input value sourceValueBase + 64*j + i
+// For the lowest 6 bits we use the lane pattern of the bit sliced virtual machine
+// All other bits are the same for all lanes of one word
+void WideLaneKernelForBooleanExpressions::calculateVariableWords(uint sourceValueBase, uint wordsPerRun, BitSlicedRegisterType* variableWord) noexcept
+{
+	for (uint variable = 0; variable < static_cast<uint>(MaxNumberOfBitsForEvaluation); ++variable)
+	{
+		for (uint word = 0; word < wordsPerRun; ++word)
+		{
+			BitSlicedRegisterType value{ null<BitSlicedRegisterType>() };
+			if (variable < bitSlicedLanePattern.size())
+			{
+				value = bitSlicedLanePattern[variable];
+			}
+			else
+			{
+				const uint sourceValueForWord{ sourceValueBase + word * NumberOfBitSlicedLanes };
+				value = (null<uint32>() == (sourceValueForWord&  bitMask[variable])) ? null<BitSlicedRegisterType>() : ~null<BitSlicedRegisterType>();
+			}
+			variableWord[variable * wordsPerRun + word] = value;
+		}
+	}
+}
+
+
+// Run the kernel program with the selected back end
+void WideLaneKernelForBooleanExpressions::run(uint sourceValueBase, BitSlicedRegisterType* result) const
+{
+	switch (backend)
+	{
+#ifdef WIDE_LANE_KERNEL_X86_64
+	case WideLaneBackend::Avx2:
+		runAvx2(sourceValueBase, result);
+		break;
+	case WideLaneBackend::Avx512:
+		runAvx512(sourceValueBase, result);
+		break;
+#endif
+	default:
+		// Kernel not available. Caller must use the virtual machine
+		break;
+	}
+}
+
+
+#ifdef WIDE_LANE_KERNEL_X86_64
+
+// Back end for AVX2. Machine registers are 256 bit wide. So 4 truth table words will be calculated
+WIDE_LANE_KERNEL_TARGET_AVX2 void WideLaneKernelForBooleanExpressions::runAvx2(uint sourceValueBase, BitSlicedRegisterType* result) const
+{
+	constexpr uint wordsPerRun{ 4U };
+	// The values of all variables for this run
+	alignas(32) BitSlicedRegisterType variableWord[static_cast<uint>(MaxNumberOfBitsForEvaluation) * wordsPerRun];
+	calculateVariableWords(sourceValueBase, wordsPerRun, &variableWord[0]);
+
+	// Machine registers and helpers
+	__m256i kernelRegister[MaxNumberOfKernelRegisters];
+	const __m256i allOnes{ _mm256_set1_epi64x(-1) };
+	__m256i programResult{ _mm256_setzero_si256() };
+
+	// Run the program line by line 
+	for (const KernelCodeLine& kernelCodeLine : program)
+	{
+		switch (kernelCodeLine.token)
+		{
+		case Token::ID:
+			kernelRegister[kernelCodeLine.parameter2] = _mm256_load_si256(reinterpret_cast<const __m256i*>(&variableWord[kernelCodeLine.parameter1 * wordsPerRun]));
+			break;
+		case Token::IDNOT:
+			kernelRegister[kernelCodeLine.parameter2] = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(&variableWord[kernelCodeLine.parameter1 * wordsPerRun])), allOnes);
+			break;
+		case Token::OR:
+			kernelRegister[kernelCodeLine.parameter3] = _mm256_or_si256(kernelRegister[kernelCodeLine.parameter1], kernelRegister[kernelCodeLine.parameter2]);
+			break;
+		case Token::XOR:
+			kernelRegister[kernelCodeLine.parameter3] = _mm256_xor_si256(kernelRegister[kernelCodeLine.parameter1], kernelRegister[kernelCodeLine.parameter2]);
+			break;
+		case Token::AND:
+			kernelRegister[kernelCodeLine.parameter3] = _mm256_and_si256(kernelRegister[kernelCodeLine.parameter1], kernelRegister[kernelCodeLine.parameter2]);
+			break;
+		case Token::NOT:
+			kernelRegister[kernelCodeLine.parameter2] = _mm256_xor_si256(kernelRegister[kernelCodeLine.parameter1], allOnes);
+			break;
+		case Token::END:
+			programResult = kernelRegister[kernelCodeLine.parameter1];
+			break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		}
+	}
+	// Store the resulting truth table words
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(result), programResult);
+}
+
+
+// Back end for AVX-512. Machine registers are 512 bit wide. So 8 truth table words will be calculated
+WIDE_LANE_KERNEL_TARGET_AVX512 void WideLaneKernelForBooleanExpressions::runAvx512(uint sourceValueBase, BitSlicedRegisterType* result) const
+{
+	constexpr uint wordsPerRun{ 8U };
+	// The values of all variables for this run
+	alignas(64) BitSlicedRegisterType variableWord[static_cast<uint>(MaxNumberOfBitsForEvaluation) * wordsPerRun];
+	calculateVariableWords(sourceValueBase, wordsPerRun, &variableWord[0]);
+
+	// Machine registers and helpers
+	__m512i kernelRegister[MaxNumberOfKernelRegisters];
+	const __m512i allOnes{ _mm512_set1_epi64(-1) };
+	__m512i programResult{ _mm512_setzero_si512() };
+
+	// Run the program line by line 
+	for (const KernelCodeLine& kernelCodeLine : program)
+	{
+		switch (kernelCodeLine.token)
+		{
+		case Token::ID:
+			kernelRegister[kernelCodeLine.parameter2] = _mm512_load_si512(&variableWord[kernelCodeLine.parameter1 * wordsPerRun]);
+			break;
+		case Token::IDNOT:
+			kernelRegister[kernelCodeLine.parameter2] = _mm512_xor_si512(_mm512_load_si512(&variableWord[kernelCodeLine.parameter1 * wordsPerRun]), allOnes);
+			break;
+		case Token::OR:
+			kernelRegister[kernelCodeLine.parameter3] = _mm512_or_si512(kernelRegister[kernelCodeLine.parameter1], kernelRegister[kernelCodeLine.parameter2]);
+			break;
+		case Token::XOR:
+			kernelRegister[kernelCodeLine.parameter3] = _mm512_xor_si512(kernelRegister[kernelCodeLine.parameter1], kernelRegister[kernelCodeLine.parameter2]);
+			break;
+		case Token::AND:
+			kernelRegister[kernelCodeLine.parameter3] = _mm512_and_si512(kernelRegister[kernelCodeLine.parameter1], kernelRegister[kernelCodeLine.parameter2]);
+			break;
+		case Token::NOT:
+			kernelRegister[kernelCodeLine.parameter2] = _mm512_xor_si512(kernelRegister[kernelCodeLine.parameter1], allOnes);
+			break;
+		case Token::END:
+			programResult = kernelRegister[kernelCodeLine.parameter1];
+			break;
+#pragma warning(suppress: 4061)
+#pragma warning(suppress: 4062)
+		}
+	}
+	// Store the resulting truth table words
+	_mm512_storeu_si512(result, programResult);
+}
+
+#endif